@@ -1,23 +1,209 @@
 #include <SDL.h>
+#include <cstdlib>
+#include <cstring>
 #include "src/Core/Engine.h"
+#include "src/Core/Clock.h"
+#include "src/Core/FramePacer.h"
+#include "src/Core/Log.h"
+#include "src/Debug/AllocTracker.h"
+#include "src/Debug/FrameCapture.h"
+#include "src/Debug/LatencyProbe.h"
+#include "src/Debug/RenderBench.h"
+#include "src/Debug/SessionReport.h"
+#include "src/Debug/Tracer.h"
+#include "src/Debug/VideoExporter.h"
+#include "src/Graphics/RenderStats.h"
+#include "src/Input/InputRecorder.h"
+#include "src/Net/NetSession.h"
+#include "src/Objects/GhostManager.h"
+#include "src/Audio/AudioManager.h"
 
 int main(int argc, char** argv) {
   SDL_Log("Starting Game...");
+  AllocTracker::GetInstance()->Init();
+
+  const char* exportPath = nullptr;
+  const char* tracePath = nullptr;
+  float traceSpikeMs = 0.0f;
+  bool traceStart = false;
+  VideoExportFormat exportFormat = VIDEO_EXPORT_Y4M;
+  int exportFps = 60;
+
+  for (int i = 1; i < argc; ++i) {
+    if (std::strcmp(argv[i], "--mixer-bench") == 0) {
+      SoftwareMixer::RunBenchmark();
+      return 0;
+    } else if (std::strcmp(argv[i], "--audio-profile") == 0 && i + 1 < argc) {
+      AudioManager::GetInstance()->SetProfile(argv[++i]);
+    } else if (std::strcmp(argv[i], "--headless") == 0) {
+      Engine::GetInstance()->SetHeadless(true);
+    } else if (std::strcmp(argv[i], "--seed") == 0 && i + 1 < argc) {
+      Engine::GetInstance()->SetSeed(static_cast<Uint32>(std::strtoul(argv[++i], nullptr, 10)));
+    } else if (std::strcmp(argv[i], "--fixed-step") == 0 && i + 1 < argc) {
+      int hz = std::atoi(argv[++i]);
+      Clock::GetInstance()->SetFixedFrameDelta(hz > 0 ? 1000000 / hz : 0);
+    } else if (std::strcmp(argv[i], "--capture-raw") == 0 && i + 1 < argc) {
+      FrameCapture::GetInstance()->AddOutput(CAPTURE_OUTPUT_RAW, argv[++i]);
+    } else if (std::strcmp(argv[i], "--capture-png") == 0 && i + 1 < argc) {
+      FrameCapture::GetInstance()->AddOutput(CAPTURE_OUTPUT_PNG, argv[++i]);
+    } else if (std::strcmp(argv[i], "--capture-checksum") == 0 && i + 1 < argc) {
+      FrameCapture::GetInstance()->AddOutput(CAPTURE_OUTPUT_CHECKSUM, argv[++i]);
+    } else if (std::strcmp(argv[i], "--capture-every") == 0 && i + 1 < argc) {
+      FrameCapture::GetInstance()->SetInterval(std::atoi(argv[++i]));
+    } else if (std::strcmp(argv[i], "--golden") == 0 && i + 1 < argc) {
+      FrameCapture::GetInstance()->SetGolden(argv[++i]);
+    } else if (std::strcmp(argv[i], "--snapshot-every") == 0 && i + 1 < argc) {
+      Engine::GetInstance()->SetSnapshotInterval(static_cast<Uint32>(std::atoi(argv[++i])));
+    } else if (std::strcmp(argv[i], "--ghost") == 0 && i + 1 < argc) {
+      GhostManager::GetInstance()->AddGhost(argv[++i]);
+    } else if (std::strcmp(argv[i], "--record") == 0 && i + 1 < argc) {
+      InputRecorder::GetInstance()->SetRecordPath(argv[++i]);
+    } else if (std::strcmp(argv[i], "--replay") == 0 && i + 1 < argc) {
+      if (!InputRecorder::GetInstance()->LoadReplay(argv[++i])) return -1;
+    } else if (std::strcmp(argv[i], "--export-video") == 0 && i + 1 < argc) {
+      exportPath = argv[++i];
+    } else if (std::strcmp(argv[i], "--export-format") == 0 && i + 1 < argc) {
+      exportFormat = std::strcmp(argv[++i], "raw") == 0 ? VIDEO_EXPORT_RAW : VIDEO_EXPORT_Y4M;
+    } else if (std::strcmp(argv[i], "--export-fps") == 0 && i + 1 < argc) {
+      exportFps = std::atoi(argv[++i]);
+    } else if (std::strcmp(argv[i], "--net-host") == 0 && i + 1 < argc) {
+      if (!NetSession::GetInstance()->Host(static_cast<Uint16>(std::atoi(argv[++i])))) return -1;
+    } else if (std::strcmp(argv[i], "--net-join") == 0 && i + 1 < argc) {
+      char host[256];
+      std::strncpy(host, argv[++i], sizeof(host) - 1);
+      host[sizeof(host) - 1] = '\0';
+      char* colon = std::strrchr(host, ':');
+      if (colon == nullptr) {
+        SDL_Log("--net-join expects <host>:<port>.");
+        return -1;
+      }
+      *colon = '\0';
+      if (!NetSession::GetInstance()->Join(host, static_cast<Uint16>(std::atoi(colon + 1)))) return -1;
+    } else if (std::strcmp(argv[i], "--net-latency") == 0 && i + 1 < argc) {
+      NetSession::GetInstance()->SetSimulatedLatency(static_cast<Uint32>(std::atoi(argv[++i])));
+    } else if (std::strcmp(argv[i], "--net-check-resim") == 0) {
+      Engine::GetInstance()->SetNetResimCheck(true);
+    } else if (std::strcmp(argv[i], "--net-loss") == 0 && i + 1 < argc) {
+      NetSession::GetInstance()->SetSimulatedLoss(static_cast<float>(std::atof(argv[++i])));
+    } else if (std::strcmp(argv[i], "--alloc-budget") == 0 && i + 1 < argc) {
+      if (!AllocTracker::GetInstance()->ParseBudget(argv[++i])) return -1;
+    } else if (std::strcmp(argv[i], "--alloc-stacks") == 0) {
+      AllocTracker::GetInstance()->SetCaptureStacks(true);
+    } else if (std::strcmp(argv[i], "--split-screen") == 0) {
+      Engine::GetInstance()->SetSplitScreen(true);
+    } else if (std::strcmp(argv[i], "--log-level") == 0 && i + 1 < argc) {
+      if (!Logger::GetInstance()->SetLevel(argv[++i])) return -1;
+    } else if (std::strcmp(argv[i], "--log-file") == 0 && i + 1 < argc) {
+      if (!Logger::GetInstance()->SetFile(argv[++i])) return -1;
+    } else if (std::strcmp(argv[i], "--trace") == 0 && i + 1 < argc) {
+      tracePath = argv[++i];
+    } else if (std::strcmp(argv[i], "--trace-start") == 0) {
+      traceStart = true;
+    } else if (std::strcmp(argv[i], "--trace-spike") == 0 && i + 1 < argc) {
+      traceSpikeMs = static_cast<float>(std::atof(argv[++i]));
+    } else if (std::strcmp(argv[i], "--session-report") == 0 && i + 1 < argc) {
+      SessionReport::GetInstance()->SetPath(argv[++i]);
+    } else if (std::strcmp(argv[i], "--render-stats") == 0) {
+      RenderStats::GetInstance()->SetOverlayVisible(true);
+    } else if (std::strcmp(argv[i], "--render-stats-file") == 0 && i + 1 < argc) {
+      if (!RenderStats::GetInstance()->SetExportPath(argv[++i])) return -1;
+    } else if (std::strcmp(argv[i], "--bench-results") == 0 && i + 1 < argc) {
+      RenderBench::GetInstance()->SetResultsPath(argv[++i]);
+    } else if (std::strcmp(argv[i], "--render-bench") == 0) {
+      // Deterministic defaults; later --seed/--fixed-step still override.
+      Engine::GetInstance()->SetHeadless(true);
+      Engine::GetInstance()->SetSeed(1);
+      Clock::GetInstance()->SetFixedFrameDelta(1000000 / 60);
+    }
+  }
+
+  Logger::GetInstance()->Start();
+
+  Tracer::GetInstance()->SetThreadName("Game");
+  if (tracePath != nullptr) {
+    if (!Tracer::GetInstance()->Open(tracePath)) return -1;
+    Tracer::GetInstance()->SetSpikeThreshold(traceSpikeMs);
+    if (traceStart) Tracer::GetInstance()->SetActive(true);
+  }
+
+  if (exportPath != nullptr) {
+    if (!InputRecorder::GetInstance()->IsReplaying()) {
+      SDL_Log("--export-video needs a run to replay (--replay <file>).");
+      return -1;
+    }
+    if (exportFps <= 0) exportFps = 60;
+    // Export renders each video frame as one fixed clock step, as fast as
+    // the renderer allows.
+    Engine::GetInstance()->SetHeadless(true);
+    Clock::GetInstance()->SetFixedFrameDelta(1000000 / exportFps);
+    if (!VideoExporter::GetInstance()->Open(exportPath, exportFormat, exportFps, SCREEN_WIDTH, SCREEN_HEIGHT)) return -1;
+    FrameCapture::GetInstance()->SetSink(&VideoExporter::OnFrame, VideoExporter::GetInstance());
+  }
 
   if (!Engine::GetInstance()->Init()) {
     SDL_Log("Engine initialization failed!");
     return -1;
   }
 
+  for (int i = 1; i < argc; ++i) {
+    if (std::strcmp(argv[i], "--time-scale") == 0 && i + 1 < argc) {
+      Clock::GetInstance()->SetTimeScale(CLOCK_GAME, static_cast<float>(std::atof(argv[++i])));
+    } else if (std::strcmp(argv[i], "--fast-forward") == 0) {
+      Clock::GetInstance()->SetTimeScale(CLOCK_GAME, CLOCK_FAST_FORWARD_SCALE);
+    } else if (std::strcmp(argv[i], "--latency-probe") == 0) {
+      LatencyProbe::GetInstance()->Enable();
+    } else if (std::strcmp(argv[i], "--latency-bench") == 0 && i + 1 < argc) {
+      LatencyProbe::GetInstance()->EnableBench(std::atoi(argv[++i]));
+    } else if (std::strcmp(argv[i], "--soft-mixer") == 0) {
+      AudioManager::GetInstance()->EnableSoftwareMixer();
+    } else if (std::strcmp(argv[i], "--target-fps") == 0 && i + 1 < argc) {
+      FramePacer::GetInstance()->SetTargetRate(std::atoi(argv[++i]));
+    } else if (std::strcmp(argv[i], "--render-scale") == 0 && i + 1 < argc) {
+      Engine::GetInstance()->GetResolutionScaler()->SetFixedScale(static_cast<float>(std::atof(argv[++i])));
+    } else if (std::strcmp(argv[i], "--min-render-scale") == 0 && i + 1 < argc) {
+      Engine::GetInstance()->GetResolutionScaler()->SetMinScale(static_cast<float>(std::atof(argv[++i])));
+    } else if (std::strcmp(argv[i], "--frames") == 0 && i + 1 < argc) {
+      RenderBench::GetInstance()->Enable(std::atoi(argv[++i]));
+    } else if (std::strcmp(argv[i], "--render-bench") == 0 && i + 1 < argc) {
+      RenderBench::GetInstance()->Enable(std::atoi(argv[++i]));
+      RenderBench::GetInstance()->StartGameplay();
+    } else if (std::strcmp(argv[i], "--autostart") == 0) {
+      RenderBench::GetInstance()->StartGameplay();
+    }
+  }
+
+  if (exportPath != nullptr) {
+    RenderBench::GetInstance()->StartGameplay();
+  }
+
   SDL_Log("Entering Main Loop...");
   while (Engine::GetInstance()->IsRunning()) {
+    FramePacer::GetInstance()->WaitForFrame();
+    Tracer::GetInstance()->BeginFrame();
     Engine::GetInstance()->Events();
+    RenderBench::GetInstance()->BeginFrame();
     Engine::GetInstance()->Update();
+    RenderBench::GetInstance()->BeginRender();
     Engine::GetInstance()->Render();
+    RenderBench::GetInstance()->EndFrame();
+    Tracer::GetInstance()->EndFrame();
+    FramePacer::GetInstance()->EndFrame();
+    Engine* engine = Engine::GetInstance();
+    SessionReport::GetInstance()->OnFrame(engine->GetGameState() == STATE_PLAYING && !engine->IsPaused());
+    AllocTracker::GetInstance()->EndFrame(engine->IsPaused() ? STATE_PAUSED : engine->GetGameState());
   }
   SDL_Log("Exited Main Loop.");
 
+  bool benchPassed = RenderBench::GetInstance()->Report();
+  RenderStats::GetInstance()->Report();
+  AllocTracker::GetInstance()->Report();
   Engine::GetInstance()->Clean();
+  VideoExporter::GetInstance()->Close();
+  Tracer::GetInstance()->Close();
+  SessionReport::GetInstance()->EndSession();
+  Logger::GetInstance()->Stop();
   SDL_Log("Game Shut Down Gracefully.");
-  return 0;
+  bool failed = FrameCapture::GetInstance()->HasGoldenFailed() || AllocTracker::GetInstance()->HasExceededBudget() ||
+                Engine::GetInstance()->GetNetResimMismatches() > 0 || !benchPassed;
+  return failed ? 1 : 0;
 }
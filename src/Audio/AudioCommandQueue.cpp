@@ -0,0 +1,33 @@
+#include "AudioCommandQueue.h"
+
+AudioCommandQueue::AudioCommandQueue() {
+    SDL_AtomicSet(&m_head, 0);
+    SDL_AtomicSet(&m_tail, 0);
+}
+
+bool AudioCommandQueue::Push(const AudioCommand& command) {
+    int tail = SDL_AtomicGet(&m_tail);
+    int next = (tail + 1) % AUDIO_COMMAND_QUEUE_CAPACITY;
+    if (next == SDL_AtomicGet(&m_head)) {
+        return false;
+    }
+    m_commands[tail] = command;
+    // SDL_AtomicSet is a full barrier, so the slot is visible before the new tail.
+    SDL_AtomicSet(&m_tail, next);
+    return true;
+}
+
+bool AudioCommandQueue::Pop(AudioCommand* out) {
+    int head = SDL_AtomicGet(&m_head);
+    if (head == SDL_AtomicGet(&m_tail)) {
+        return false;
+    }
+    *out = m_commands[head];
+    SDL_AtomicSet(&m_head, (head + 1) % AUDIO_COMMAND_QUEUE_CAPACITY);
+    return true;
+}
+
+int AudioCommandQueue::GetDepth() {
+    int depth = SDL_AtomicGet(&m_tail) - SDL_AtomicGet(&m_head);
+    return (depth < 0) ? depth + AUDIO_COMMAND_QUEUE_CAPACITY : depth;
+}
@@ -0,0 +1,53 @@
+#ifndef AUDIOCOMMANDQUEUE_H
+#define AUDIOCOMMANDQUEUE_H
+
+#include <SDL.h>
+#include <SDL_mixer.h>
+
+#define AUDIO_COMMAND_QUEUE_CAPACITY 256
+
+enum AudioCommandType {
+    AUDIO_CMD_PLAY_SOUND,
+    AUDIO_CMD_HALT_CHANNEL,
+    AUDIO_CMD_CHANNEL_VOLUME,
+    AUDIO_CMD_CHUNK_VOLUME,
+    AUDIO_CMD_PLAY_MUSIC,
+    AUDIO_CMD_HALT_MUSIC,
+    AUDIO_CMD_PAUSE_MUSIC,
+    AUDIO_CMD_RESUME_MUSIC,
+    AUDIO_CMD_MUSIC_VOLUME,
+    AUDIO_CMD_PREFETCH_MUSIC,
+    AUDIO_CMD_REOPEN_DEVICE
+};
+
+struct AudioCommand {
+    AudioCommandType type;
+    int channel;
+    int loops;
+    int volume;
+    float pan;
+    int fadeMs;
+    Uint32 tag;
+    Mix_Chunk* chunk;
+    Mix_Music* music;
+    Uint64 enqueueCounter;
+};
+
+// Single-producer/single-consumer ring. Only the game thread may call Push()
+// and only the audio worker may call Pop(); the indices are the only state
+// shared between them.
+class AudioCommandQueue {
+public:
+    AudioCommandQueue();
+
+    bool Push(const AudioCommand& command);
+    bool Pop(AudioCommand* out);
+    int GetDepth();
+
+private:
+    AudioCommand m_commands[AUDIO_COMMAND_QUEUE_CAPACITY];
+    SDL_atomic_t m_head;
+    SDL_atomic_t m_tail;
+};
+
+#endif // AUDIOCOMMANDQUEUE_H
@@ -0,0 +1,81 @@
+#include "AudioLatencyMonitor.h"
+
+AudioLatencyMonitor::AudioLatencyMonitor() : m_startCounter(0), m_frequency(0), m_chunkSize(0), m_periodMicros(0),
+    m_deficitMicros(0) {
+    SDL_AtomicSet(&m_pendingRequest, 0);
+    SDL_AtomicSet(&m_lastCallback, 0);
+    SDL_AtomicSet(&m_lastLatency, 0);
+    SDL_AtomicSet(&m_averageLatency, 0);
+    SDL_AtomicSet(&m_maxLatency, 0);
+    SDL_AtomicSet(&m_samples, 0);
+    SDL_AtomicSet(&m_underruns, 0);
+}
+
+int AudioLatencyMonitor::ToMicros(Uint64 counter) const {
+    // Wraps after ~35 minutes; only differences between nearby stamps are used.
+    Uint64 micros = (counter - m_startCounter) * 1000000 / SDL_GetPerformanceFrequency();
+    int value = static_cast<int>(micros & 0x7FFFFFFF);
+    return (value == 0) ? 1 : value;
+}
+
+void AudioLatencyMonitor::Attach(int frequency, int chunkSize) {
+    if (m_startCounter == 0) m_startCounter = SDL_GetPerformanceCounter();
+    m_frequency = frequency;
+    m_chunkSize = chunkSize;
+    m_periodMicros = (frequency > 0) ? static_cast<int>(static_cast<Sint64>(chunkSize) * 1000000 / frequency) : 0;
+    m_deficitMicros = 0;
+    SDL_AtomicSet(&m_pendingRequest, 0);
+    SDL_AtomicSet(&m_lastCallback, 0);
+    if (Mix_RegisterEffect(MIX_CHANNEL_POST, &AudioLatencyMonitor::OnMix, nullptr, this) == 0) {
+        SDL_Log("AudioLatencyMonitor::Attach - Failed to register post effect: %s", Mix_GetError());
+    }
+}
+
+void AudioLatencyMonitor::MarkPlayback(Uint64 requestCounter) {
+    // Only one measurement in flight; later requests are ignored until it lands.
+    SDL_AtomicCAS(&m_pendingRequest, 0, ToMicros(requestCounter));
+}
+
+void AudioLatencyMonitor::OnMix(int /*channel*/, void* /*stream*/, int /*len*/, void* userData) {
+    AudioLatencyMonitor* monitor = static_cast<AudioLatencyMonitor*>(userData);
+    int now = monitor->ToMicros(SDL_GetPerformanceCounter());
+
+    // Deficit = wall time elapsed minus audio delivered, callback thread only.
+    // Early callbacks bank credit, up to the buffers the device can queue.
+    int last = SDL_AtomicGet(&monitor->m_lastCallback);
+    int period = monitor->m_periodMicros;
+    if (last != 0 && period > 0) {
+        int interval = static_cast<int>(static_cast<Uint32>(now - last) & 0x7FFFFFFF);
+        int deficit = monitor->m_deficitMicros + interval - period;
+        if (deficit < -period * AUDIO_UNDERRUN_AHEAD_PERIODS) deficit = -period * AUDIO_UNDERRUN_AHEAD_PERIODS;
+        if (deficit > period) {
+            SDL_AtomicAdd(&monitor->m_underruns, 1);
+            deficit = 0;  // The device restarts from an empty buffer.
+        }
+        monitor->m_deficitMicros = deficit;
+    }
+    SDL_AtomicSet(&monitor->m_lastCallback, now);
+
+    int request = SDL_AtomicGet(&monitor->m_pendingRequest);
+    if (request != 0) {
+        int latency = static_cast<int>(static_cast<Uint32>(now - request) & 0x7FFFFFFF) + monitor->m_periodMicros;
+        int samples = SDL_AtomicGet(&monitor->m_samples);
+        int average = SDL_AtomicGet(&monitor->m_averageLatency);
+        SDL_AtomicSet(&monitor->m_lastLatency, latency);
+        SDL_AtomicSet(&monitor->m_averageLatency, (samples == 0) ? latency : average + (latency - average) / 8);
+        if (latency > SDL_AtomicGet(&monitor->m_maxLatency)) SDL_AtomicSet(&monitor->m_maxLatency, latency);
+        SDL_AtomicSet(&monitor->m_samples, samples + 1);
+        SDL_AtomicSet(&monitor->m_pendingRequest, 0);
+    }
+}
+
+void AudioLatencyMonitor::GetStats(AudioOutputStats* out) {
+    out->frequency = m_frequency;
+    out->chunkSize = m_chunkSize;
+    out->bufferMs = m_periodMicros / 1000.0f;
+    out->lastLatencyMs = SDL_AtomicGet(&m_lastLatency) / 1000.0f;
+    out->averageLatencyMs = SDL_AtomicGet(&m_averageLatency) / 1000.0f;
+    out->maxLatencyMs = SDL_AtomicGet(&m_maxLatency) / 1000.0f;
+    out->samples = SDL_AtomicGet(&m_samples);
+    out->underruns = SDL_AtomicGet(&m_underruns);
+}
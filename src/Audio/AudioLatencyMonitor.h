@@ -0,0 +1,55 @@
+#ifndef AUDIOLATENCYMONITOR_H
+#define AUDIOLATENCYMONITOR_H
+
+#include <SDL.h>
+#include <SDL_mixer.h>
+
+#define AUDIO_UNDERRUN_AHEAD_PERIODS 2
+
+struct AudioOutputStats {
+    int frequency;
+    int chunkSize;
+    float bufferMs;
+    float lastLatencyMs;
+    float averageLatencyMs;
+    float maxLatencyMs;
+    int samples;
+    int underruns;
+};
+
+// Hooks the mixer as a post effect to time its callbacks. A playback request
+// is stamped with the time it was posted; the first callback after it starts
+// playing closes the measurement, and one buffer of playout is added to get
+// the time until the sound actually leaves the device. Each callback
+// delivers one buffer period of audio; once the wall time since the
+// callbacks started runs more than a period ahead of the audio delivered,
+// the device ran dry. Callbacks that come in bursts even out on their own.
+class AudioLatencyMonitor {
+public:
+    AudioLatencyMonitor();
+
+    void Attach(int frequency, int chunkSize);
+    void MarkPlayback(Uint64 requestCounter);
+    void GetStats(AudioOutputStats* out);
+    inline int GetUnderrunCount() { return SDL_AtomicGet(&m_underruns); }
+
+private:
+    static void OnMix(int channel, void* stream, int len, void* userData);
+    int ToMicros(Uint64 counter) const;
+
+    Uint64 m_startCounter;
+    int m_frequency;
+    int m_chunkSize;
+    int m_periodMicros;
+    int m_deficitMicros;
+
+    SDL_atomic_t m_pendingRequest;
+    SDL_atomic_t m_lastCallback;
+    SDL_atomic_t m_lastLatency;
+    SDL_atomic_t m_averageLatency;
+    SDL_atomic_t m_maxLatency;
+    SDL_atomic_t m_samples;
+    SDL_atomic_t m_underruns;
+};
+
+#endif // AUDIOLATENCYMONITOR_H
@@ -1,7 +1,24 @@
 #include "AudioManager.h"
+#include "../Debug/Tracer.h"
 #include <SDL.h>
 
 AudioManager* AudioManager::s_Instance = nullptr;
+SDL_atomic_t AudioManager::s_voiceFinished[AUDIO_VOICE_COUNT];
+SDL_atomic_t AudioManager::s_channelTag[AUDIO_VOICE_COUNT];
+
+static const char* s_commandNames[] = {
+    "PlaySound", "HaltChannel", "ChannelVolume", "ChunkVolume", "PlayMusic", "HaltMusic",
+    "PauseMusic", "ResumeMusic", "MusicVolume", "PrefetchMusic", "ReopenDevice"
+};
+
+// Every profile keeps S16 stereo so loaded chunks stay valid when only the
+// buffer size changes; the software mixer and music streamer rely on it too.
+const AudioDeviceConfig AudioManager::s_profiles[AUDIO_PROFILE_COUNT] = {
+    { "low",      48000, AUDIO_S16SYS, 2, 256 },
+    { "balanced", 44100, AUDIO_S16SYS, 2, 512 },
+    { "safe",     44100, AUDIO_S16SYS, 2, 1024 },
+    { "legacy",   44100, AUDIO_S16SYS, 2, 2048 }
+};
 
 bool AudioManager::Init() {
     if (Mix_Init(MIX_INIT_OGG | MIX_INIT_MP3) == 0) {
@@ -9,23 +26,361 @@ bool AudioManager::Init() {
          return false;
     }
 
-    if (Mix_OpenAudio(44100, MIX_DEFAULT_FORMAT, 2, 2048) < 0) {
-        SDL_Log("Failed to open audio device: %s", Mix_GetError());
+    if (!OpenDevice()) {
         Mix_Quit();
         return false;
     }
-    SDL_Log("SDL_mixer initialized successfully!");
+    m_deviceOpenedAt = SDL_GetTicks();
+    m_underrunWindowStart = m_deviceOpenedAt;
+    for (int i = 0; i < AUDIO_VOICE_COUNT; ++i) {
+        m_voices[i].sound = INVALID_SOUND_HANDLE;
+        m_voices[i].priority = 0;
+        m_voices[i].startSequence = 0;
+        m_voices[i].active = false;
+        SDL_AtomicSet(&s_voiceFinished[i], 0);
+        SDL_AtomicSet(&s_channelTag[i], 0);
+    }
+    m_currentMusicId.clear();
+    m_musicPaused = false;
+    if (!StartWorker()) {
+        SDL_Log("Audio worker unavailable, audio commands will run on the game thread.");
+    }
+    if (!m_musicStreamer.Init()) {
+        SDL_Log("Music streaming unavailable, falling back to Mix_PlayMusic.");
+    }
+    SDL_Log("SDL_mixer initialized successfully with %d voices!", AUDIO_VOICE_COUNT);
     return true;
 }
 
+void AudioManager::OnSoftVoiceFinished(int channel, Uint32 tag) {
+    if (channel >= 0 && channel < AUDIO_VOICE_COUNT) {
+        SDL_AtomicSet(&s_voiceFinished[channel], static_cast<int>(tag));
+    }
+}
+
+void AudioManager::OnChannelFinished(int channel) {
+    // Runs on whichever thread stopped the channel. Report which play ended
+    // so a late callback can't free a voice that has since been reused.
+    if (channel >= 0 && channel < AUDIO_VOICE_COUNT) {
+        SDL_AtomicSet(&s_voiceFinished[channel], SDL_AtomicGet(&s_channelTag[channel]));
+    }
+}
+
+bool AudioManager::OpenDevice() {
+    const AudioDeviceConfig& config = m_deviceConfig;
+    // No allowed changes: SDL converts to the device, so the mixer format is fixed.
+    if (Mix_OpenAudioDevice(config.frequency, config.format, config.channels, config.chunkSize, nullptr, 0) < 0) {
+        SDL_Log("Failed to open audio device (%s profile, %d Hz, %d frames): %s",
+                config.name, config.frequency, config.chunkSize, Mix_GetError());
+        return false;
+    }
+    Mix_AllocateChannels(AUDIO_VOICE_COUNT);
+    Mix_ChannelFinished(&AudioManager::OnChannelFinished);
+    m_latencyMonitor.Attach(config.frequency, config.chunkSize);
+    SDL_Log("Audio device opened: %s profile, %d Hz, %d frames per buffer (%.1f ms).",
+            config.name, config.frequency, config.chunkSize, config.chunkSize * 1000.0f / config.frequency);
+    return true;
+}
+
+void AudioManager::ReopenDevice() {
+    // Runs on the audio worker; the mixer callbacks stop while the device is closed.
+    Mix_HaltChannel(-1);
+    Mix_CloseAudio();
+    if (!OpenDevice()) {
+        return;
+    }
+    Mix_Volume(-1, m_soundVolume);
+    Mix_VolumeMusic(m_musicVolume);
+    m_softMixer.Reattach();
+    m_musicStreamer.Reattach();
+}
+
+void AudioManager::SetProfile(AudioLatencyProfile profile) {
+    if (profile >= 0 && profile < AUDIO_PROFILE_COUNT) {
+        m_deviceConfig = s_profiles[profile];
+    }
+}
+
+bool AudioManager::SetProfile(const std::string& name) {
+    for (int i = 0; i < AUDIO_PROFILE_COUNT; ++i) {
+        if (name == s_profiles[i].name) {
+            SetProfile(static_cast<AudioLatencyProfile>(i));
+            return true;
+        }
+    }
+    SDL_Log("Unknown audio profile '%s', keeping '%s'.", name.c_str(), m_deviceConfig.name);
+    return false;
+}
+
+void AudioManager::RequestReopen(int chunkSize) {
+    m_deviceConfig.chunkSize = (chunkSize > AUDIO_MAX_CHUNK_SIZE) ? AUDIO_MAX_CHUNK_SIZE : chunkSize;
+    m_deviceOpenedAt = SDL_GetTicks();
+    m_underrunWindowStart = m_deviceOpenedAt;
+    m_underrunsAtWindowStart = m_latencyMonitor.GetUnderrunCount();
+
+    AudioCommand command = {};
+    command.type = AUDIO_CMD_REOPEN_DEVICE;
+    Post(command);
+
+    // Closing the device drops SDL_mixer's own music; the streamer survives.
+    if (!m_musicStreamer.IsEnabled() && !m_currentMusicId.empty()) {
+        std::string id = m_currentMusicId;
+        PlayMusic(id, -1);
+    }
+}
+
+void AudioManager::HandleDeviceEvent(const SDL_Event& event) {
+    if (event.type != SDL_AUDIODEVICEADDED && event.type != SDL_AUDIODEVICEREMOVED) return;
+    if (event.adevice.iscapture) return;
+    // SDL announces every existing device at startup; only react to changes after that.
+    if (event.type == SDL_AUDIODEVICEADDED && SDL_GetTicks() - m_deviceOpenedAt < AUDIO_DEVICE_SETTLE_MS) return;
+    SDL_Log("Audio device %s, renegotiating output.", event.type == SDL_AUDIODEVICEADDED ? "added" : "removed");
+    RequestReopen(m_deviceConfig.chunkSize);
+}
+
+void AudioManager::CheckUnderruns() {
+    Uint32 now = SDL_GetTicks();
+    if (now - m_deviceOpenedAt < AUDIO_DEVICE_SETTLE_MS) {
+        m_underrunWindowStart = now;
+        m_underrunsAtWindowStart = m_latencyMonitor.GetUnderrunCount();
+        return;
+    }
+    int underruns = m_latencyMonitor.GetUnderrunCount() - m_underrunsAtWindowStart;
+    if (underruns >= AUDIO_UNDERRUN_FALLBACK_COUNT && m_deviceConfig.chunkSize < AUDIO_MAX_CHUNK_SIZE) {
+        m_fallbackCount++;
+        SDL_Log("Audio: %d underruns in %u ms at %d frames, falling back to %d frames.",
+                underruns, now - m_underrunWindowStart, m_deviceConfig.chunkSize, m_deviceConfig.chunkSize * 2);
+        RequestReopen(m_deviceConfig.chunkSize * 2);
+    } else if (now - m_underrunWindowStart >= AUDIO_UNDERRUN_WINDOW_MS) {
+        m_underrunWindowStart = now;
+        m_underrunsAtWindowStart = m_latencyMonitor.GetUnderrunCount();
+    }
+}
+
+AudioOutputStats AudioManager::GetOutputStats() {
+    AudioOutputStats stats;
+    m_latencyMonitor.GetStats(&stats);
+    return stats;
+}
+
+bool AudioManager::StartWorker() {
+    SDL_AtomicSet(&m_workerQuit, 0);
+    SDL_AtomicSet(&m_executedCount, 0);
+    SDL_AtomicSet(&m_lastLatencyMicros, 0);
+    SDL_AtomicSet(&m_maxLatencyMicros, 0);
+    SDL_AtomicSet(&m_averageLatencyMicros, 0);
+    m_commandSignal = SDL_CreateSemaphore(0);
+    if (m_commandSignal == nullptr) {
+        SDL_Log("Failed to create audio command semaphore: %s", SDL_GetError());
+        return false;
+    }
+    m_worker = SDL_CreateThread(&AudioManager::WorkerMain, "AudioCommands", this);
+    if (m_worker == nullptr) {
+        SDL_Log("Failed to create audio worker thread: %s", SDL_GetError());
+        SDL_DestroySemaphore(m_commandSignal);
+        m_commandSignal = nullptr;
+        return false;
+    }
+    return true;
+}
+
+void AudioManager::StopWorker() {
+    if (m_worker == nullptr) return;
+    SDL_AtomicSet(&m_workerQuit, 1);
+    SDL_SemPost(m_commandSignal);
+    SDL_WaitThread(m_worker, nullptr);
+    SDL_DestroySemaphore(m_commandSignal);
+    m_worker = nullptr;
+    m_commandSignal = nullptr;
+}
+
+int AudioManager::WorkerMain(void* userData) {
+    AudioManager* audio = static_cast<AudioManager*>(userData);
+    AudioCommand command = {};
+    Tracer::GetInstance()->SetThreadName("AudioCommands");
+    while (true) {
+        SDL_SemWait(audio->m_commandSignal);
+        while (audio->m_commandQueue.Pop(&command)) {
+            audio->ExecuteCommand(command);
+        }
+        if (SDL_AtomicGet(&audio->m_workerQuit)) break;
+    }
+    return 0;
+}
+
+bool AudioManager::Post(AudioCommand& command) {
+    command.enqueueCounter = SDL_GetPerformanceCounter();
+    if (m_worker == nullptr) {
+        ExecuteCommand(command);
+        return true;
+    }
+    if (!m_commandQueue.Push(command)) {
+        m_droppedCommands++;
+        return false;
+    }
+    m_postedCount++;
+    int depth = m_commandQueue.GetDepth();
+    if (depth > m_maxQueueDepth) m_maxQueueDepth = depth;
+    SDL_SemPost(m_commandSignal);
+    return true;
+}
+
+void AudioManager::ExecuteCommand(const AudioCommand& command) {
+    TRACE_SCOPE("AudioCommand", s_commandNames[command.type]);
+    switch (command.type) {
+        case AUDIO_CMD_PLAY_SOUND:
+            // Halt first so a stolen voice reports its old tag, then tag the new play.
+            Mix_HaltChannel(command.channel);
+            SDL_AtomicSet(&s_channelTag[command.channel], static_cast<int>(command.tag));
+            if (Mix_PlayChannel(command.channel, command.chunk, command.loops) == -1) {
+                SDL_Log("Failed to play sound on voice %d: %s", command.channel, Mix_GetError());
+                SDL_AtomicSet(&s_voiceFinished[command.channel], static_cast<int>(command.tag));
+            } else {
+                m_latencyMonitor.MarkPlayback(command.enqueueCounter);
+            }
+            break;
+        case AUDIO_CMD_HALT_CHANNEL:
+            Mix_HaltChannel(command.channel);
+            break;
+        case AUDIO_CMD_CHANNEL_VOLUME:
+            Mix_Volume(command.channel, command.volume);
+            break;
+        case AUDIO_CMD_CHUNK_VOLUME:
+            Mix_VolumeChunk(command.chunk, command.volume);
+            break;
+        case AUDIO_CMD_PLAY_MUSIC:
+            Mix_HaltMusic();
+            if (Mix_PlayMusic(command.music, command.loops) == -1) {
+                SDL_Log("Failed to play music: %s", Mix_GetError());
+            }
+            break;
+        case AUDIO_CMD_HALT_MUSIC:
+            Mix_HaltMusic();
+            break;
+        case AUDIO_CMD_PAUSE_MUSIC:
+            Mix_PauseMusic();
+            break;
+        case AUDIO_CMD_RESUME_MUSIC:
+            Mix_ResumeMusic();
+            break;
+        case AUDIO_CMD_MUSIC_VOLUME:
+            Mix_VolumeMusic(command.volume);
+            break;
+        case AUDIO_CMD_REOPEN_DEVICE:
+            ReopenDevice();
+            break;
+        case AUDIO_CMD_PREFETCH_MUSIC:
+            // Only the music streamer's own queue carries prefetches.
+            SDL_Log("AudioManager::ExecuteCommand - Error: prefetch posted to the audio worker, ignoring.");
+            break;
+    }
+
+    Uint64 elapsed = SDL_GetPerformanceCounter() - command.enqueueCounter;
+    int micros = static_cast<int>(elapsed * 1000000 / SDL_GetPerformanceFrequency());
+    int average = SDL_AtomicGet(&m_averageLatencyMicros);
+    SDL_AtomicSet(&m_lastLatencyMicros, micros);
+    SDL_AtomicSet(&m_averageLatencyMicros, (SDL_AtomicGet(&m_executedCount) == 0) ? micros : average + (micros - average) / 8);
+    if (micros > SDL_AtomicGet(&m_maxLatencyMicros)) SDL_AtomicSet(&m_maxLatencyMicros, micros);
+    SDL_AtomicAdd(&m_executedCount, 1);
+}
+
+AudioQueueStats AudioManager::GetQueueStats() {
+    AudioQueueStats stats;
+    stats.depth = m_commandQueue.GetDepth();
+    stats.maxDepth = m_maxQueueDepth;
+    stats.posted = m_postedCount;
+    stats.dropped = m_droppedCommands;
+    stats.executed = static_cast<Uint32>(SDL_AtomicGet(&m_executedCount));
+    stats.lastLatencyMs = SDL_AtomicGet(&m_lastLatencyMicros) / 1000.0f;
+    stats.averageLatencyMs = SDL_AtomicGet(&m_averageLatencyMicros) / 1000.0f;
+    stats.maxLatencyMs = SDL_AtomicGet(&m_maxLatencyMicros) / 1000.0f;
+    return stats;
+}
+
+void AudioManager::BeginFrame() {
+    ReclaimFinishedVoices();
+    CheckUnderruns();
+    m_frameStats.played = 0;
+    m_frameStats.stolen = 0;
+    m_frameStats.dropped = 0;
+}
+
+void AudioManager::ReclaimFinishedVoices() {
+    int active = 0;
+    for (int i = 0; i < AUDIO_VOICE_COUNT; ++i) {
+        if (m_voices[i].active && SDL_AtomicGet(&s_voiceFinished[i]) == static_cast<int>(m_voices[i].startSequence + 1)) {
+            ReleaseVoice(i);
+        }
+        if (m_voices[i].active) active++;
+    }
+    m_frameStats.activeVoices = active;
+}
+
+void AudioManager::ReleaseVoice(int voice) {
+    Voice& v = m_voices[voice];
+    if (v.active && v.sound != INVALID_SOUND_HANDLE) {
+        m_Sounds[v.sound].activeVoices--;
+    }
+    v.active = false;
+    v.sound = INVALID_SOUND_HANDLE;
+}
+
+// Only picks the voice; PlaySound takes it over once the play is queued.
+// `stolen` is set when a voice of another sound is taken from a full pool.
+int AudioManager::AcquireVoice(SoundHandle handle, bool* stolen) {
+    const Sound& sound = m_Sounds[handle];
+    int victim = -1;
+    *stolen = false;
+
+    if (sound.maxVoices != SOUND_UNLIMITED_VOICES && sound.activeVoices >= sound.maxVoices) {
+        // Over the per-sound limit: restart the oldest instance of the same sound.
+        for (int i = 0; i < AUDIO_VOICE_COUNT; ++i) {
+            if (m_voices[i].active && m_voices[i].sound == handle &&
+                (victim < 0 || m_voices[i].startSequence < m_voices[victim].startSequence)) {
+                victim = i;
+            }
+        }
+    } else {
+        for (int i = 0; i < AUDIO_VOICE_COUNT; ++i) {
+            if (!m_voices[i].active) return i;
+        }
+        // Pool is full: steal the lowest-priority voice, oldest first.
+        for (int i = 0; i < AUDIO_VOICE_COUNT; ++i) {
+            const Voice& v = m_voices[i];
+            if (v.priority > sound.priority) continue;
+            if (victim < 0 || v.priority < m_voices[victim].priority ||
+                (v.priority == m_voices[victim].priority && v.startSequence < m_voices[victim].startSequence)) {
+                victim = i;
+            }
+        }
+        *stolen = victim >= 0;
+    }
+    return victim;
+}
+
 void AudioManager::Clean() {
     SDL_Log("Cleaning AudioManager...");
-    for (auto const& [id, chunk] : m_SoundMap) {
-        if (chunk != nullptr) {
-            Mix_FreeChunk(chunk);
+    m_softMixer.Shutdown();
+    m_musicStreamer.Shutdown();
+    m_MusicTracks.clear();
+    StopWorker();
+    AudioQueueStats stats = GetQueueStats();
+    SDL_Log("Audio commands: %u posted, %u executed, %u dropped, max depth %d, latency avg %.2f ms max %.2f ms",
+            stats.posted, stats.executed, stats.dropped, stats.maxDepth, stats.averageLatencyMs, stats.maxLatencyMs);
+    AudioOutputStats output = GetOutputStats();
+    SDL_Log("Audio output: %d Hz, %d frames (%.1f ms buffer), latency avg %.1f ms max %.1f ms over %d sounds, %d underruns, %d fallbacks",
+            output.frequency, output.chunkSize, output.bufferMs, output.averageLatencyMs, output.maxLatencyMs,
+            output.samples, output.underruns, m_fallbackCount);
+    Mix_HaltChannel(-1);
+    Mix_HaltMusic();
+    m_currentMusicId.clear();
+    for (Sound& sound : m_Sounds) {
+        if (sound.chunk != nullptr) {
+            Mix_FreeChunk(sound.chunk);
         }
     }
-    m_SoundMap.clear();
+    m_Sounds.clear();
+    m_SoundIndex.clear();
     SDL_Log("Sounds freed.");
 
     for (auto const& [id, music] : m_MusicMap) {
@@ -42,10 +397,17 @@ void AudioManager::Clean() {
 }
 
 bool AudioManager::LoadMusic(const std::string& id, const std::string& source) {
+    TRACE_SCOPE("LoadMusic", id.c_str());
     if (IsMusicLoaded(id)) {
         SDL_Log("Music '%s' already loaded.", id.c_str());
         return true;
     }
+    if (m_musicStreamer.IsEnabled()) {
+        // Decoding is deferred to the streaming worker; see PrefetchMusic().
+        m_MusicTracks[id] = m_musicStreamer.AddTrack(source);
+        SDL_Log("Registered streamed music: %s as ID: %s", source.c_str(), id.c_str());
+        return true;
+    }
     Mix_Music* music = Mix_LoadMUS(source.c_str());
     if (music == nullptr) {
         SDL_Log("Failed to load music '%s': %s", source.c_str(), Mix_GetError());
@@ -56,90 +418,202 @@ bool AudioManager::LoadMusic(const std::string& id, const std::string& source) {
     return true;
 }
 
-bool AudioManager::LoadSound(const std::string& id, const std::string& source) {
-    if (IsSoundLoaded(id)) {
+bool AudioManager::LoadSound(const std::string& id, const std::string& source, int priority, int maxVoices) {
+    TRACE_SCOPE("LoadSound", id.c_str());
+    if (GetSoundHandle(id) != INVALID_SOUND_HANDLE) {
         SDL_Log("Sound '%s' already loaded.", id.c_str());
         return true;
     }
-    Mix_Chunk* sound = Mix_LoadWAV(source.c_str());
-    if (sound == nullptr) {
+    Mix_Chunk* chunk = Mix_LoadWAV(source.c_str());
+    if (chunk == nullptr) {
         SDL_Log("Failed to load sound '%s': %s", source.c_str(), Mix_GetError());
         return false;
     }
-    m_SoundMap[id] = sound;
-    SDL_Log("Loaded Sound: %s as ID: %s", source.c_str(), id.c_str());
+    Sound sound;
+    sound.id = id;
+    sound.chunk = chunk;
+    sound.priority = priority;
+    sound.maxVoices = maxVoices;
+    sound.activeVoices = 0;
+    m_SoundIndex[id] = static_cast<SoundHandle>(m_Sounds.size());
+    m_Sounds.push_back(sound);
+    SDL_Log("Loaded Sound: %s as ID: %s (priority %d, max voices %d)", source.c_str(), id.c_str(), priority, maxVoices);
     return true;
 }
 
+SoundHandle AudioManager::GetSoundHandle(const std::string& id) const {
+    auto it = m_SoundIndex.find(id);
+    return (it != m_SoundIndex.end()) ? it->second : INVALID_SOUND_HANDLE;
+}
+
 void AudioManager::PlayMusic(const std::string& id, int loops) {
     if (!IsMusicLoaded(id)) {
         SDL_Log("Cannot play music '%s': Not loaded.", id.c_str());
         return;
     }
-    if (Mix_PlayingMusic()) {
-        Mix_HaltMusic();
+    if (m_musicStreamer.IsEnabled()) {
+        m_musicStreamer.Play(m_MusicTracks[id], loops, m_crossfadeMs);
+        m_musicStreamer.SetPaused(false);
+    } else {
+        AudioCommand command = {};
+        command.type = AUDIO_CMD_PLAY_MUSIC;
+        command.music = m_MusicMap[id];
+        command.loops = loops;
+        if (!Post(command)) return;
+    }
+    m_currentMusicId = id;
+    m_musicPaused = false;
+}
+
+void AudioManager::PrefetchMusic(const std::string& id) {
+    auto it = m_MusicTracks.find(id);
+    if (it != m_MusicTracks.end()) {
+        m_musicStreamer.Prefetch(it->second);
+    }
+}
+
+bool AudioManager::PlaySound(SoundHandle handle, int loops, float pan) {
+    if (handle < 0 || handle >= static_cast<int>(m_Sounds.size())) {
+        return false;
+    }
+    ReclaimFinishedVoices();
+    bool stolen = false;
+    int voice = AcquireVoice(handle, &stolen);
+    if (voice < 0) {
+        m_frameStats.dropped++;
+        return false;
+    }
+    Voice& v = m_voices[voice];
+    AudioCommand command = {};
+    command.type = AUDIO_CMD_PLAY_SOUND;
+    command.channel = voice;
+    command.chunk = m_Sounds[handle].chunk;
+    command.loops = loops;
+    command.tag = m_playSequence + 1;
+    bool queued = m_softMixer.IsEnabled() ? m_softMixer.Play(voice, command.tag, command.chunk, loops, pan) : Post(command);
+    if (!queued) {
+        // The queue is full; whatever the voice was playing keeps playing.
+        m_frameStats.dropped++;
+        return false;
     }
-    if (Mix_PlayMusic(m_MusicMap[id], loops) == -1) {
-        SDL_Log("Failed to play music '%s': %s", id.c_str(), Mix_GetError());
+
+    // The old sound on a reused voice is halted when the new one starts.
+    if (v.active) {
+        ReleaseVoice(voice);
+        m_frameStats.activeVoices--;
     }
+    if (stolen) m_frameStats.stolen++;
+    v.sound = handle;
+    v.priority = m_Sounds[handle].priority;
+    v.startSequence = m_playSequence++;
+    v.active = true;
+    m_Sounds[handle].activeVoices++;
+    m_frameStats.played++;
+    m_frameStats.activeVoices++;
+    return true;
 }
 
-void AudioManager::PlaySound(const std::string& id, int loops) {
-    if (!IsSoundLoaded(id)) {
+bool AudioManager::PlaySound(const std::string& id, int loops) {
+    SoundHandle handle = GetSoundHandle(id);
+    if (handle == INVALID_SOUND_HANDLE) {
         SDL_Log("Cannot play sound '%s': Not loaded.", id.c_str());
-        return;
+        return false;
     }
-    if (Mix_PlayChannel(-1, m_SoundMap[id], loops) == -1) {
-        SDL_Log("Failed to play sound '%s' on a channel: %s", id.c_str(), Mix_GetError());
+    return PlaySound(handle, loops);
+}
+
+bool AudioManager::EnableSoftwareMixer() {
+    if (m_softMixer.IsEnabled()) return true;
+    m_softMixer.SetFinishedCallback(&AudioManager::OnSoftVoiceFinished);
+    if (!m_softMixer.Init(AUDIO_VOICE_COUNT)) {
+        SDL_Log("Software mixer unavailable, keeping SDL_mixer channels.");
+        return false;
     }
+    m_softMixer.SetMasterVolume(m_soundVolume);
+    return true;
 }
 
 void AudioManager::StopMusic() {
-    if (Mix_PlayingMusic()) {
-        Mix_HaltMusic();
+    if (m_currentMusicId.empty()) return;
+    if (m_musicStreamer.IsEnabled()) {
+        m_musicStreamer.Stop(m_crossfadeMs);
+        m_musicStreamer.SetPaused(false);
+    } else {
+        AudioCommand command = {};
+        command.type = AUDIO_CMD_HALT_MUSIC;
+        if (!Post(command)) return;
     }
+    m_currentMusicId.clear();
+    m_musicPaused = false;
 }
 
 void AudioManager::PauseMusic() {
-    if (Mix_PlayingMusic()) {
-        Mix_PauseMusic();
+    if (m_currentMusicId.empty() || m_musicPaused) return;
+    if (m_musicStreamer.IsEnabled()) {
+        m_musicStreamer.SetPaused(true);
+    } else {
+        AudioCommand command = {};
+        command.type = AUDIO_CMD_PAUSE_MUSIC;
+        if (!Post(command)) return;
     }
+    m_musicPaused = true;
 }
 
 void AudioManager::ResumeMusic() {
-    if (Mix_PausedMusic()) {
-        Mix_ResumeMusic();
+    if (!m_musicPaused) return;
+    if (m_musicStreamer.IsEnabled()) {
+        m_musicStreamer.SetPaused(false);
+    } else {
+        AudioCommand command = {};
+        command.type = AUDIO_CMD_RESUME_MUSIC;
+        if (!Post(command)) return;
     }
-}/////////
+    m_musicPaused = false;
+}
+
 bool AudioManager::IsMusicPaused() {
-    return Mix_PausedMusic();
+    return m_musicPaused;
+}
+
+bool AudioManager::IsMusicPlaying(const std::string& id) {
+    return !m_currentMusicId.empty() && m_currentMusicId == id;
 }
-///
 
 void AudioManager::SetMusicVolume(int volume) {
-    volume = (volume < 0) ? 0 : (volume > MIX_MAX_VOLUME) ? MIX_MAX_VOLUME : volume;
-    Mix_VolumeMusic(volume);
+    AudioCommand command = {};
+    command.type = AUDIO_CMD_MUSIC_VOLUME;
+    command.volume = (volume < 0) ? 0 : (volume > MIX_MAX_VOLUME) ? MIX_MAX_VOLUME : volume;
+    m_musicStreamer.SetVolume(command.volume);
+    m_musicVolume = command.volume;
+    Post(command);
 }
 
 void AudioManager::SetSoundVolume(const std::string& soundId, int volume) {
-     if (!IsSoundLoaded(soundId)) {
+    SoundHandle handle = GetSoundHandle(soundId);
+    if (handle == INVALID_SOUND_HANDLE) {
         SDL_Log("Cannot set volume for sound '%s': Not loaded.", soundId.c_str());
         return;
     }
-    volume = (volume < 0) ? 0 : (volume > MIX_MAX_VOLUME) ? MIX_MAX_VOLUME : volume;
-    Mix_VolumeChunk(m_SoundMap[soundId], volume);
+    AudioCommand command = {};
+    command.type = AUDIO_CMD_CHUNK_VOLUME;
+    command.chunk = m_Sounds[handle].chunk;
+    command.volume = (volume < 0) ? 0 : (volume > MIX_MAX_VOLUME) ? MIX_MAX_VOLUME : volume;
+    Post(command);
 }
 
 void AudioManager::SetAllSoundsVolume(int volume) {
-     volume = (volume < 0) ? 0 : (volume > MIX_MAX_VOLUME) ? MIX_MAX_VOLUME : volume;
-     Mix_Volume(-1, volume);
+    AudioCommand command = {};
+    command.type = AUDIO_CMD_CHANNEL_VOLUME;
+    command.channel = -1;
+    command.volume = (volume < 0) ? 0 : (volume > MIX_MAX_VOLUME) ? MIX_MAX_VOLUME : volume;
+    Post(command);
+    m_soundVolume = command.volume;
+    m_softMixer.SetMasterVolume(m_soundVolume);
 }
 
 
 bool AudioManager::IsMusicLoaded(const std::string& id) {
-    return m_MusicMap.find(id) != m_MusicMap.end() && m_MusicMap[id] != nullptr;
-}
-
-bool AudioManager::IsSoundLoaded(const std::string& id) {
-     return m_SoundMap.find(id) != m_SoundMap.end() && m_SoundMap[id] != nullptr;
+    if (m_MusicTracks.find(id) != m_MusicTracks.end()) return true;
+    auto it = m_MusicMap.find(id);
+    return it != m_MusicMap.end() && it->second != nullptr;
 }
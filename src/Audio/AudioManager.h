@@ -3,7 +3,58 @@
 
 #include <string>
 #include <map>
+#include <vector>
 #include <SDL_mixer.h>
+#include "AudioCommandQueue.h"
+#include "SoftwareMixer.h"
+#include "MusicStreamer.h"
+#include "AudioLatencyMonitor.h"
+
+#define AUDIO_VOICE_COUNT 16
+#define SOUND_PRIORITY_DEFAULT 0
+#define SOUND_UNLIMITED_VOICES 0
+
+#define AUDIO_MAX_CHUNK_SIZE 4096
+#define AUDIO_UNDERRUN_WINDOW_MS 5000
+#define AUDIO_UNDERRUN_FALLBACK_COUNT 3
+#define AUDIO_DEVICE_SETTLE_MS 1000
+
+enum AudioLatencyProfile {
+    AUDIO_PROFILE_LOW_LATENCY,
+    AUDIO_PROFILE_BALANCED,
+    AUDIO_PROFILE_SAFE,
+    AUDIO_PROFILE_LEGACY,
+    AUDIO_PROFILE_COUNT
+};
+
+struct AudioDeviceConfig {
+    const char* name;
+    int frequency;
+    Uint16 format;
+    int channels;
+    int chunkSize;
+};
+
+typedef int SoundHandle;
+#define INVALID_SOUND_HANDLE -1
+
+struct AudioFrameStats {
+    int activeVoices;
+    int played;
+    int stolen;
+    int dropped;
+};
+
+struct AudioQueueStats {
+    int depth;
+    int maxDepth;
+    Uint32 posted;
+    Uint32 dropped;
+    Uint32 executed;
+    float lastLatencyMs;
+    float averageLatencyMs;
+    float maxLatencyMs;
+};
 
 class AudioManager {
 public:
@@ -13,12 +64,25 @@ public:
 
     bool Init();
     void Clean();
+    void BeginFrame();
+
+    void SetProfile(AudioLatencyProfile profile);
+    bool SetProfile(const std::string& name);
+    void HandleDeviceEvent(const SDL_Event& event);
+    void RequestReopen(int chunkSize);
+    AudioOutputStats GetOutputStats();
 
     bool LoadMusic(const std::string& id, const std::string& source);
-    bool LoadSound(const std::string& id, const std::string& source);
+    bool LoadSound(const std::string& id, const std::string& source,
+                   int priority = SOUND_PRIORITY_DEFAULT, int maxVoices = SOUND_UNLIMITED_VOICES);
+    SoundHandle GetSoundHandle(const std::string& id) const;
 
     void PlayMusic(const std::string& id, int loops = -1);
-    void PlaySound(const std::string& id, int loops = 0);
+    void PrefetchMusic(const std::string& id);
+    inline void SetMusicCrossfade(int milliseconds) { m_crossfadeMs = milliseconds; }
+    bool PlaySound(SoundHandle handle, int loops = 0, float pan = 0.0f);
+    bool PlaySound(const std::string& id, int loops = 0);
+    bool EnableSoftwareMixer();
 
     void StopMusic();
     void PauseMusic();
@@ -28,16 +92,86 @@ public:
     void SetSoundVolume(const std::string& soundId, int volume);
     void SetAllSoundsVolume(int volume);
     bool IsMusicPaused();
+    bool IsMusicPlaying(const std::string& id);
+
+    inline const AudioFrameStats& GetFrameStats() const { return m_frameStats; }
+    AudioQueueStats GetQueueStats();
 
 private:
     AudioManager() {}
     static AudioManager* s_Instance;
 
+    struct Sound {
+        std::string id;
+        Mix_Chunk* chunk;
+        int priority;
+        int maxVoices;
+        int activeVoices;
+    };
+
+    struct Voice {
+        SoundHandle sound;
+        int priority;
+        Uint32 startSequence;
+        bool active;
+    };
+
+    static void OnChannelFinished(int channel);
+    static void OnSoftVoiceFinished(int channel, Uint32 tag);
+    static int WorkerMain(void* userData);
+    bool Post(AudioCommand& command);
+    void ExecuteCommand(const AudioCommand& command);
+    bool StartWorker();
+    void StopWorker();
+    bool OpenDevice();
+    void ReopenDevice();
+    void CheckUnderruns();
+
+    void ReclaimFinishedVoices();
+    int AcquireVoice(SoundHandle handle, bool* stolen);
+    void ReleaseVoice(int voice);
+
     std::map<std::string, Mix_Music*> m_MusicMap;
-    std::map<std::string, Mix_Chunk*> m_SoundMap;
+    std::map<std::string, SoundHandle> m_SoundIndex;
+    std::vector<Sound> m_Sounds;
+
+    Voice m_voices[AUDIO_VOICE_COUNT];
+    static SDL_atomic_t s_voiceFinished[AUDIO_VOICE_COUNT];
+    static SDL_atomic_t s_channelTag[AUDIO_VOICE_COUNT];
+    Uint32 m_playSequence = 0;
+    AudioFrameStats m_frameStats = {0, 0, 0, 0};
+
+    static const AudioDeviceConfig s_profiles[AUDIO_PROFILE_COUNT];
+    AudioDeviceConfig m_deviceConfig = s_profiles[AUDIO_PROFILE_BALANCED];
+    AudioLatencyMonitor m_latencyMonitor;
+    Uint32 m_deviceOpenedAt = 0;
+    Uint32 m_underrunWindowStart = 0;
+    int m_underrunsAtWindowStart = 0;
+    int m_fallbackCount = 0;
+
+    SoftwareMixer m_softMixer;
+    int m_soundVolume = MIX_MAX_VOLUME;
+    int m_musicVolume = MIX_MAX_VOLUME;
+
+    MusicStreamer m_musicStreamer;
+    std::map<std::string, int> m_MusicTracks;
+    int m_crossfadeMs = MUSIC_CROSSFADE_DEFAULT_MS;
+    std::string m_currentMusicId;
+    bool m_musicPaused = false;
+
+    AudioCommandQueue m_commandQueue;
+    SDL_Thread* m_worker = nullptr;
+    SDL_sem* m_commandSignal = nullptr;
+    SDL_atomic_t m_workerQuit;
+    SDL_atomic_t m_executedCount;
+    SDL_atomic_t m_lastLatencyMicros;
+    SDL_atomic_t m_maxLatencyMicros;
+    SDL_atomic_t m_averageLatencyMicros;
+    Uint32 m_postedCount = 0;
+    Uint32 m_droppedCommands = 0;
+    int m_maxQueueDepth = 0;
 
     bool IsMusicLoaded(const std::string& id);
-    bool IsSoundLoaded(const std::string& id);
 };
 
 #endif // AUDIOMANAGER_H
@@ -0,0 +1,382 @@
+#include "MusicStreamer.h"
+#include "../Debug/Tracer.h"
+#include <cmath>
+
+MusicStreamer::MusicStreamer()
+    : m_enabled(false), m_frequency(0), m_trackLock(nullptr), m_trackCount(0),
+      m_hasPendingPlay(false), m_worker(nullptr), m_wake(nullptr) {
+    for (int i = 0; i < MUSIC_STREAM_DECKS; ++i) {
+        m_decks[i].state = DECK_IDLE;
+        m_decks[i].track = -1;
+        m_decks[i].position = 0;
+        m_decks[i].loopsLeft = 0;
+        m_decks[i].playing = false;
+        m_decks[i].phase = 0.0f;
+        m_decks[i].phaseStep = 0.0f;
+        m_decks[i].fadeFramesLeft = 0;
+    }
+}
+
+bool MusicStreamer::Init() {
+    Uint16 format = 0;
+    int channels = 0;
+    if (Mix_QuerySpec(&m_frequency, &format, &channels) == 0) {
+        SDL_Log("MusicStreamer::Init - Error: audio device not open.");
+        return false;
+    }
+    if (format != AUDIO_S16SYS || channels != 2) {
+        SDL_Log("MusicStreamer::Init - Error: unsupported device format 0x%x with %d channels, need S16 stereo.", format, channels);
+        return false;
+    }
+
+    for (int i = 0; i < MUSIC_STREAM_DECKS; ++i) {
+        Deck& deck = m_decks[i];
+        deck.ring.assign(MUSIC_STREAM_RING_FRAMES * 2, 0);
+        SDL_AtomicSet(&deck.readFrame, 0);
+        SDL_AtomicSet(&deck.writeFrame, 0);
+        SDL_AtomicSet(&deck.busy, 0);
+        SDL_AtomicSet(&deck.ended, 0);
+    }
+    SDL_AtomicSet(&m_quit, 0);
+    SDL_AtomicSet(&m_paused, 0);
+    SDL_AtomicSet(&m_volume, MIX_MAX_VOLUME);
+    SDL_AtomicSet(&m_underruns, 0);
+
+    m_trackLock = SDL_CreateMutex();
+    m_wake = SDL_CreateSemaphore(0);
+    if (m_trackLock == nullptr || m_wake == nullptr) {
+        SDL_Log("MusicStreamer::Init - Error: %s", SDL_GetError());
+        Shutdown();
+        return false;
+    }
+    m_worker = SDL_CreateThread(&MusicStreamer::WorkerMain, "MusicStream", this);
+    if (m_worker == nullptr) {
+        SDL_Log("MusicStreamer::Init - Error: failed to create worker thread: %s", SDL_GetError());
+        Shutdown();
+        return false;
+    }
+
+    Mix_HookMusic(&MusicStreamer::MixCallback, this);
+    m_enabled = true;
+    SDL_Log("Music streaming enabled (%d frame ring per deck).", MUSIC_STREAM_RING_FRAMES);
+    return true;
+}
+
+void MusicStreamer::Reattach() {
+    if (m_enabled) {
+        Mix_HookMusic(&MusicStreamer::MixCallback, this);
+    }
+}
+
+void MusicStreamer::Shutdown() {
+    if (m_enabled) {
+        Mix_HookMusic(nullptr, nullptr);
+        m_enabled = false;
+    }
+    if (m_worker != nullptr) {
+        SDL_AtomicSet(&m_quit, 1);
+        SDL_SemPost(m_wake);
+        SDL_WaitThread(m_worker, nullptr);
+        m_worker = nullptr;
+    }
+    if (m_wake != nullptr) {
+        SDL_DestroySemaphore(m_wake);
+        m_wake = nullptr;
+    }
+    if (m_trackLock != nullptr) {
+        SDL_DestroyMutex(m_trackLock);
+        m_trackLock = nullptr;
+    }
+    for (Mix_Chunk* chunk : m_decoded) {
+        if (chunk != nullptr) {
+            Mix_FreeChunk(chunk);
+        }
+    }
+    m_decoded.clear();
+    m_trackSources.clear();
+    m_trackCount = 0;
+}
+
+int MusicStreamer::AddTrack(const std::string& source) {
+    SDL_LockMutex(m_trackLock);
+    m_trackSources.push_back(source);
+    SDL_UnlockMutex(m_trackLock);
+    return m_trackCount++;
+}
+
+void MusicStreamer::Prefetch(int track) {
+    if (!m_enabled || track < 0 || track >= m_trackCount) return;
+    AudioCommand command = {};
+    command.type = AUDIO_CMD_PREFETCH_MUSIC;
+    command.channel = track;
+    if (m_requests.Push(command)) SDL_SemPost(m_wake);
+}
+
+void MusicStreamer::Play(int track, int loops, int fadeMs) {
+    if (!m_enabled || track < 0 || track >= m_trackCount) return;
+    AudioCommand command = {};
+    command.type = AUDIO_CMD_PLAY_MUSIC;
+    command.channel = track;
+    command.loops = loops;
+    command.fadeMs = fadeMs;
+    if (m_requests.Push(command)) SDL_SemPost(m_wake);
+}
+
+void MusicStreamer::Stop(int fadeMs) {
+    if (!m_enabled) return;
+    AudioCommand command = {};
+    command.type = AUDIO_CMD_HALT_MUSIC;
+    command.fadeMs = fadeMs;
+    if (m_requests.Push(command)) SDL_SemPost(m_wake);
+}
+
+void MusicStreamer::SetPaused(bool paused) {
+    SDL_AtomicSet(&m_paused, paused ? 1 : 0);
+}
+
+void MusicStreamer::SetVolume(int volume) {
+    SDL_AtomicSet(&m_volume, (volume < 0) ? 0 : (volume > MIX_MAX_VOLUME) ? MIX_MAX_VOLUME : volume);
+}
+
+int MusicStreamer::MsToFrames(int ms) const {
+    return (ms > 0) ? static_cast<int>(static_cast<Sint64>(ms) * m_frequency / 1000) : 0;
+}
+
+// ---- Worker thread ----
+
+int MusicStreamer::WorkerMain(void* userData) {
+    MusicStreamer* streamer = static_cast<MusicStreamer*>(userData);
+    AudioCommand command;
+    Tracer::GetInstance()->SetThreadName("MusicStream");
+    while (!SDL_AtomicGet(&streamer->m_quit)) {
+        SDL_SemWaitTimeout(streamer->m_wake, MUSIC_STREAM_SERVICE_MS);
+        while (streamer->m_requests.Pop(&command)) {
+            streamer->HandleCommand(command);
+        }
+        if (streamer->m_hasPendingPlay && streamer->StartPending()) {
+            streamer->m_hasPendingPlay = false;
+        }
+        for (int i = 0; i < MUSIC_STREAM_DECKS; ++i) {
+            Deck& deck = streamer->m_decks[i];
+            if (deck.state == DECK_STARTED && !SDL_AtomicGet(&deck.busy)) {
+                deck.state = DECK_IDLE;
+            }
+            if (deck.state != DECK_IDLE) {
+                streamer->FillDeck(deck);
+            }
+        }
+    }
+    return 0;
+}
+
+void MusicStreamer::HandleCommand(const AudioCommand& command) {
+    switch (command.type) {
+        case AUDIO_CMD_PREFETCH_MUSIC: {
+            if (!EnsureDecoded(command.channel)) break;
+            if (FindDeck(command.channel, true) >= 0) break;
+            int deck = FindDeck(-1, false);
+            if (deck >= 0) PrimeDeck(deck, command.channel, -1);
+            break;
+        }
+        case AUDIO_CMD_PLAY_MUSIC:
+            m_pendingPlay = command;
+            m_hasPendingPlay = !StartPending();
+            break;
+        case AUDIO_CMD_HALT_MUSIC: {
+            m_hasPendingPlay = false;
+            AudioCommand stop = {};
+            stop.type = AUDIO_CMD_HALT_MUSIC;
+            stop.fadeMs = MsToFrames(command.fadeMs);
+            m_mixerCommands.Push(stop);
+            break;
+        }
+        default:
+            break;
+    }
+}
+
+bool MusicStreamer::StartPending() {
+    int track = m_pendingPlay.channel;
+    if (!EnsureDecoded(track)) return true;
+
+    int deck = FindDeck(track, true);
+    if (deck < 0) {
+        // Both decks may still be audible (one fading out); retry next service tick.
+        deck = FindDeck(-1, false);
+        if (deck < 0) return false;
+        PrimeDeck(deck, track, m_pendingPlay.loops);
+    } else {
+        m_decks[deck].loopsLeft = m_pendingPlay.loops;
+    }
+
+    m_decks[deck].state = DECK_STARTED;
+    FillDeck(m_decks[deck]);
+    AudioCommand start = {};
+    start.type = AUDIO_CMD_PLAY_MUSIC;
+    start.channel = deck;
+    start.fadeMs = MsToFrames(m_pendingPlay.fadeMs);
+    m_mixerCommands.Push(start);
+    return true;
+}
+
+bool MusicStreamer::EnsureDecoded(int track) {
+    if (track < static_cast<int>(m_decoded.size()) && m_decoded[track] != nullptr) return true;
+
+    SDL_LockMutex(m_trackLock);
+    std::string source = (track < static_cast<int>(m_trackSources.size())) ? m_trackSources[track] : std::string();
+    SDL_UnlockMutex(m_trackLock);
+    if (source.empty()) return false;
+
+    TRACE_SCOPE("DecodeMusic", source.c_str());
+    Uint32 start = SDL_GetTicks();
+    Mix_Chunk* chunk = Mix_LoadWAV(source.c_str());
+    if (chunk == nullptr) {
+        SDL_Log("MusicStreamer - Failed to decode '%s': %s", source.c_str(), Mix_GetError());
+        return false;
+    }
+    if (static_cast<int>(m_decoded.size()) <= track) m_decoded.resize(track + 1, nullptr);
+    m_decoded[track] = chunk;
+    SDL_Log("MusicStreamer - Decoded '%s' in %u ms.", source.c_str(), SDL_GetTicks() - start);
+    return true;
+}
+
+int MusicStreamer::FindDeck(int track, bool allowPrimed) {
+    for (int i = 0; i < MUSIC_STREAM_DECKS; ++i) {
+        const Deck& deck = m_decks[i];
+        if (allowPrimed) {
+            if (deck.state == DECK_PRIMED && deck.track == track) return i;
+        } else if (deck.state == DECK_IDLE) {
+            return i;
+        }
+    }
+    if (!allowPrimed) {
+        // Reuse a deck primed for a track that is no longer wanted.
+        for (int i = 0; i < MUSIC_STREAM_DECKS; ++i) {
+            if (m_decks[i].state == DECK_PRIMED) return i;
+        }
+    }
+    return -1;
+}
+
+void MusicStreamer::PrimeDeck(int index, int track, int loops) {
+    Deck& deck = m_decks[index];
+    // The mixer callback only reads decks it is playing, and it clears busy after
+    // it stops. FindDeck hands out idle decks (busy already clear) or primed ones
+    // the mixer was never told to play, so the ring can be reset here.
+    SDL_AtomicSet(&deck.readFrame, 0);
+    SDL_AtomicSet(&deck.writeFrame, 0);
+    SDL_AtomicSet(&deck.ended, 0);
+    SDL_AtomicSet(&deck.busy, 1);
+    deck.state = DECK_PRIMED;
+    deck.track = track;
+    deck.position = 0;
+    deck.loopsLeft = loops;
+    FillDeck(deck);
+}
+
+void MusicStreamer::FillDeck(Deck& deck) {
+    if (SDL_AtomicGet(&deck.ended)) return;
+    const Mix_Chunk* chunk = m_decoded[deck.track];
+    const Sint16* samples = reinterpret_cast<const Sint16*>(chunk->abuf);
+    int totalFrames = static_cast<int>(chunk->alen / (2 * sizeof(Sint16)));
+
+    Uint32 write = static_cast<Uint32>(SDL_AtomicGet(&deck.writeFrame));
+    Uint32 read = static_cast<Uint32>(SDL_AtomicGet(&deck.readFrame));
+    int space = MUSIC_STREAM_RING_FRAMES - static_cast<int>(write - read);
+    while (space > 0) {
+        if (deck.position >= totalFrames) {
+            // Mix_PlayMusic semantics: -1 loops forever, 0 and 1 both play once.
+            if (deck.loopsLeft < 0 || deck.loopsLeft > 1) {
+                if (deck.loopsLeft > 1) deck.loopsLeft--;
+                deck.position = 0;
+            } else {
+                SDL_AtomicSet(&deck.ended, 1);
+                break;
+            }
+        }
+        int ringIndex = static_cast<int>(write % MUSIC_STREAM_RING_FRAMES);
+        int count = totalFrames - deck.position;
+        if (count > space) count = space;
+        if (count > MUSIC_STREAM_RING_FRAMES - ringIndex) count = MUSIC_STREAM_RING_FRAMES - ringIndex;
+        SDL_memcpy(&deck.ring[ringIndex * 2], samples + deck.position * 2, count * 2 * sizeof(Sint16));
+        deck.position += count;
+        write += count;
+        space -= count;
+    }
+    SDL_AtomicSet(&deck.writeFrame, static_cast<int>(write));
+}
+
+// ---- Mixer callback ----
+
+void MusicStreamer::StartFade(Deck& deck, float target, int frames) {
+    if (frames <= 0) {
+        deck.phase = target;
+        deck.phaseStep = 0.0f;
+        deck.fadeFramesLeft = 0;
+        return;
+    }
+    deck.phaseStep = (target - deck.phase) / frames;
+    deck.fadeFramesLeft = frames;
+}
+
+void MusicStreamer::ApplyMixerCommands() {
+    AudioCommand command;
+    while (m_mixerCommands.Pop(&command)) {
+        for (int i = 0; i < MUSIC_STREAM_DECKS; ++i) {
+            Deck& deck = m_decks[i];
+            if (command.type == AUDIO_CMD_PLAY_MUSIC && i == command.channel) {
+                deck.playing = true;
+                deck.phase = 0.0f;
+                StartFade(deck, 1.0f, command.fadeMs);
+            } else if (deck.playing) {
+                StartFade(deck, 0.0f, command.fadeMs);
+            }
+        }
+    }
+}
+
+void MusicStreamer::MixCallback(void* userData, Uint8* stream, int len) {
+    MusicStreamer* streamer = static_cast<MusicStreamer*>(userData);
+    streamer->ApplyMixerCommands();
+    if (SDL_AtomicGet(&streamer->m_paused)) return;
+
+    Sint16* out = reinterpret_cast<Sint16*>(stream);
+    int frames = len / static_cast<int>(2 * sizeof(Sint16));
+    float master = SDL_AtomicGet(&streamer->m_volume) / static_cast<float>(MIX_MAX_VOLUME);
+    const float halfPi = 1.57079633f;
+
+    for (int d = 0; d < MUSIC_STREAM_DECKS; ++d) {
+        Deck& deck = streamer->m_decks[d];
+        if (!deck.playing) continue;
+
+        Uint32 read = static_cast<Uint32>(SDL_AtomicGet(&deck.readFrame));
+        Uint32 write = static_cast<Uint32>(SDL_AtomicGet(&deck.writeFrame));
+        int available = static_cast<int>(write - read);
+        int count = (available < frames) ? available : frames;
+
+        for (int i = 0; i < count; ++i) {
+            // Equal-power curve: a deck's gain is sin(phase * pi/2), so two
+            // opposite linear ramps keep the summed power constant.
+            float gain = std::sin(deck.phase * halfPi) * master;
+            if (deck.fadeFramesLeft > 0) {
+                deck.phase += deck.phaseStep;
+                if (--deck.fadeFramesLeft == 0) deck.phase = (deck.phaseStep > 0.0f) ? 1.0f : 0.0f;
+            }
+            int ringIndex = static_cast<int>((read + i) % MUSIC_STREAM_RING_FRAMES) * 2;
+            for (int c = 0; c < 2; ++c) {
+                int sample = out[i * 2 + c] + static_cast<int>(deck.ring[ringIndex + c] * gain);
+                out[i * 2 + c] = static_cast<Sint16>((sample < -32768) ? -32768 : (sample > 32767) ? 32767 : sample);
+            }
+        }
+        SDL_AtomicSet(&deck.readFrame, static_cast<int>(read + count));
+
+        bool finished = (count < frames) && SDL_AtomicGet(&deck.ended);
+        bool silent = deck.fadeFramesLeft == 0 && deck.phase <= 0.0f;
+        if (finished || silent) {
+            deck.playing = false;
+            SDL_AtomicSet(&deck.busy, 0);
+        } else if (count < frames) {
+            SDL_AtomicAdd(&streamer->m_underruns, 1);
+        }
+    }
+}
@@ -0,0 +1,100 @@
+#ifndef MUSICSTREAMER_H
+#define MUSICSTREAMER_H
+
+#include <string>
+#include <vector>
+#include <SDL.h>
+#include <SDL_mixer.h>
+#include "AudioCommandQueue.h"
+
+#define MUSIC_STREAM_DECKS 2
+#define MUSIC_STREAM_RING_FRAMES 32768
+#define MUSIC_STREAM_SERVICE_MS 10
+#define MUSIC_CROSSFADE_DEFAULT_MS 750
+
+// Music player installed with Mix_HookMusic. A worker thread decodes tracks
+// and keeps a PCM ring per deck topped up; the mixer callback only reads
+// the rings and applies equal-power gain ramps, so a transition is a
+// crossfade between two decks rather than a halt and a decoder restart.
+// All public calls are for the game thread and never wait on either thread.
+class MusicStreamer {
+public:
+    MusicStreamer();
+
+    bool Init();
+    void Shutdown();
+    void Reattach();
+    inline bool IsEnabled() const { return m_enabled; }
+
+    int AddTrack(const std::string& source);
+    void Prefetch(int track);
+    void Play(int track, int loops, int fadeMs);
+    void Stop(int fadeMs);
+    void SetPaused(bool paused);
+    void SetVolume(int volume);
+    inline int GetUnderrunCount() { return SDL_AtomicGet(&m_underruns); }
+
+private:
+    enum DeckState {
+        DECK_IDLE,
+        DECK_PRIMED,
+        DECK_STARTED
+    };
+
+    struct Deck {
+        std::vector<Sint16> ring;
+        SDL_atomic_t readFrame;
+        SDL_atomic_t writeFrame;
+        SDL_atomic_t busy;
+        SDL_atomic_t ended;
+
+        // Worker side.
+        DeckState state;
+        int track;
+        int position;
+        int loopsLeft;
+
+        // Mixer callback side.
+        bool playing;
+        float phase;
+        float phaseStep;
+        int fadeFramesLeft;
+    };
+
+    static int WorkerMain(void* userData);
+    static void MixCallback(void* userData, Uint8* stream, int len);
+
+    void HandleCommand(const AudioCommand& command);
+    bool StartPending();
+    bool EnsureDecoded(int track);
+    int FindDeck(int track, bool allowPrimed);
+    void PrimeDeck(int deck, int track, int loops);
+    void FillDeck(Deck& deck);
+    int MsToFrames(int ms) const;
+
+    void ApplyMixerCommands();
+    void StartFade(Deck& deck, float target, int frames);
+
+    bool m_enabled;
+    int m_frequency;
+    Deck m_decks[MUSIC_STREAM_DECKS];
+
+    SDL_mutex* m_trackLock;
+    std::vector<std::string> m_trackSources;
+    std::vector<Mix_Chunk*> m_decoded;
+    int m_trackCount;
+
+    AudioCommandQueue m_requests;
+    AudioCommandQueue m_mixerCommands;
+    AudioCommand m_pendingPlay;
+    bool m_hasPendingPlay;
+
+    SDL_Thread* m_worker;
+    SDL_sem* m_wake;
+    SDL_atomic_t m_quit;
+    SDL_atomic_t m_paused;
+    SDL_atomic_t m_volume;
+    SDL_atomic_t m_underruns;
+};
+
+#endif // MUSICSTREAMER_H
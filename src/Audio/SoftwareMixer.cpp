@@ -0,0 +1,335 @@
+#include "SoftwareMixer.h"
+#include <cmath>
+#include <cstring>
+
+#if defined(__x86_64__) || defined(__i386__) || defined(_M_X64) || defined(_M_IX86)
+#define SOFT_MIXER_X86 1
+#include <emmintrin.h>
+#if defined(__GNUC__)
+#define SOFT_MIXER_HAS_AVX2 1
+#include <immintrin.h>
+#endif
+#endif
+
+typedef void (*MixVoiceFn)(float* acc, const Sint16* src, int frames, float gainLeft, float gainRight);
+typedef void (*ResolveFn)(Sint16* out, const float* acc, int frames);
+
+static void MixVoiceScalar(float* acc, const Sint16* src, int frames, float gainLeft, float gainRight) {
+    for (int i = 0; i < frames; ++i) {
+        acc[2 * i] += src[2 * i] * gainLeft;
+        acc[2 * i + 1] += src[2 * i + 1] * gainRight;
+    }
+}
+
+static void ResolveScalar(Sint16* out, const float* acc, int frames) {
+    for (int i = 0; i < frames * 2; ++i) {
+        int sample = out[i] + static_cast<int>(std::lrint(acc[i]));
+        out[i] = static_cast<Sint16>((sample < -32768) ? -32768 : (sample > 32767) ? 32767 : sample);
+    }
+}
+
+#ifdef SOFT_MIXER_X86
+static void MixVoiceSSE2(float* acc, const Sint16* src, int frames, float gainLeft, float gainRight) {
+    const __m128 gain = _mm_setr_ps(gainLeft, gainRight, gainLeft, gainRight);
+    int samples = frames * 2;
+    int i = 0;
+    for (; i + 8 <= samples; i += 8) {
+        __m128i s = _mm_loadu_si128(reinterpret_cast<const __m128i*>(src + i));
+        __m128 lo = _mm_cvtepi32_ps(_mm_srai_epi32(_mm_unpacklo_epi16(s, s), 16));
+        __m128 hi = _mm_cvtepi32_ps(_mm_srai_epi32(_mm_unpackhi_epi16(s, s), 16));
+        _mm_storeu_ps(acc + i, _mm_add_ps(_mm_loadu_ps(acc + i), _mm_mul_ps(lo, gain)));
+        _mm_storeu_ps(acc + i + 4, _mm_add_ps(_mm_loadu_ps(acc + i + 4), _mm_mul_ps(hi, gain)));
+    }
+    MixVoiceScalar(acc + i, src + i, (samples - i) / 2, gainLeft, gainRight);
+}
+
+static void ResolveSSE2(Sint16* out, const float* acc, int frames) {
+    int samples = frames * 2;
+    int i = 0;
+    for (; i + 8 <= samples; i += 8) {
+        __m128i s = _mm_loadu_si128(reinterpret_cast<const __m128i*>(out + i));
+        __m128i lo = _mm_add_epi32(_mm_srai_epi32(_mm_unpacklo_epi16(s, s), 16), _mm_cvtps_epi32(_mm_loadu_ps(acc + i)));
+        __m128i hi = _mm_add_epi32(_mm_srai_epi32(_mm_unpackhi_epi16(s, s), 16), _mm_cvtps_epi32(_mm_loadu_ps(acc + i + 4)));
+        _mm_storeu_si128(reinterpret_cast<__m128i*>(out + i), _mm_packs_epi32(lo, hi));
+    }
+    ResolveScalar(out + i, acc + i, (samples - i) / 2);
+}
+#endif
+
+#ifdef SOFT_MIXER_HAS_AVX2
+__attribute__((target("avx2")))
+static void MixVoiceAVX2(float* acc, const Sint16* src, int frames, float gainLeft, float gainRight) {
+    const __m256 gain = _mm256_setr_ps(gainLeft, gainRight, gainLeft, gainRight, gainLeft, gainRight, gainLeft, gainRight);
+    int samples = frames * 2;
+    int i = 0;
+    for (; i + 16 <= samples; i += 16) {
+        __m256 lo = _mm256_cvtepi32_ps(_mm256_cvtepi16_epi32(_mm_loadu_si128(reinterpret_cast<const __m128i*>(src + i))));
+        __m256 hi = _mm256_cvtepi32_ps(_mm256_cvtepi16_epi32(_mm_loadu_si128(reinterpret_cast<const __m128i*>(src + i + 8))));
+        _mm256_storeu_ps(acc + i, _mm256_add_ps(_mm256_loadu_ps(acc + i), _mm256_mul_ps(lo, gain)));
+        _mm256_storeu_ps(acc + i + 8, _mm256_add_ps(_mm256_loadu_ps(acc + i + 8), _mm256_mul_ps(hi, gain)));
+    }
+    MixVoiceSSE2(acc + i, src + i, (samples - i) / 2, gainLeft, gainRight);
+}
+#endif
+
+static MixVoiceFn GetMixFunction(SoftMixerKernel kernel) {
+    switch (kernel) {
+#ifdef SOFT_MIXER_HAS_AVX2
+        case SOFT_MIXER_KERNEL_AVX2: return &MixVoiceAVX2;
+#endif
+#ifdef SOFT_MIXER_X86
+        case SOFT_MIXER_KERNEL_SSE2: return &MixVoiceSSE2;
+#endif
+        default: return &MixVoiceScalar;
+    }
+}
+
+static ResolveFn GetResolveFunction(SoftMixerKernel kernel) {
+#ifdef SOFT_MIXER_X86
+    if (kernel != SOFT_MIXER_KERNEL_SCALAR) return &ResolveSSE2;
+#endif
+    return &ResolveScalar;
+}
+
+static bool IsKernelAvailable(SoftMixerKernel kernel) {
+    switch (kernel) {
+        case SOFT_MIXER_KERNEL_SCALAR: return true;
+#ifdef SOFT_MIXER_X86
+        case SOFT_MIXER_KERNEL_SSE2: return SDL_HasSSE2() == SDL_TRUE;
+#endif
+#ifdef SOFT_MIXER_HAS_AVX2
+        case SOFT_MIXER_KERNEL_AVX2: return SDL_HasAVX2() == SDL_TRUE;
+#endif
+        default: return false;
+    }
+}
+
+SoftwareMixer::SoftwareMixer() : m_enabled(false), m_kernel(SOFT_MIXER_KERNEL_SCALAR), m_onFinished(nullptr), m_masterGain(1.0f) {
+}
+
+SoftMixerKernel SoftwareMixer::DetectKernel() {
+    if (IsKernelAvailable(SOFT_MIXER_KERNEL_AVX2)) return SOFT_MIXER_KERNEL_AVX2;
+    if (IsKernelAvailable(SOFT_MIXER_KERNEL_SSE2)) return SOFT_MIXER_KERNEL_SSE2;
+    return SOFT_MIXER_KERNEL_SCALAR;
+}
+
+const char* SoftwareMixer::GetKernelName(SoftMixerKernel kernel) {
+    switch (kernel) {
+        case SOFT_MIXER_KERNEL_SSE2: return "sse2";
+        case SOFT_MIXER_KERNEL_AVX2: return "avx2";
+        default: return "scalar";
+    }
+}
+
+bool SoftwareMixer::Init(int voiceCount) {
+    int frequency = 0;
+    Uint16 format = 0;
+    int channels = 0;
+    if (Mix_QuerySpec(&frequency, &format, &channels) == 0) {
+        SDL_Log("SoftwareMixer::Init - Error: audio device not open.");
+        return false;
+    }
+    if (format != AUDIO_S16SYS || channels != 2) {
+        SDL_Log("SoftwareMixer::Init - Error: unsupported device format 0x%x with %d channels, need S16 stereo.", format, channels);
+        return false;
+    }
+    m_kernel = DetectKernel();
+    Voice idle = {};
+    m_voices.assign(voiceCount, idle);
+    m_accumulator.assign(SOFT_MIXER_BLOCK_FRAMES * 2, 0.0f);
+    Mix_SetPostMix(&SoftwareMixer::PostMix, this);
+    m_enabled = true;
+    SDL_Log("Software mixer enabled (%s kernel, %d voices).", GetKernelName(m_kernel), voiceCount);
+    return true;
+}
+
+void SoftwareMixer::Reattach() {
+    if (m_enabled) {
+        Mix_SetPostMix(&SoftwareMixer::PostMix, this);
+    }
+}
+
+void SoftwareMixer::Shutdown() {
+    if (!m_enabled) return;
+    Mix_SetPostMix(nullptr, nullptr);
+    m_enabled = false;
+}
+
+bool SoftwareMixer::Play(int channel, Uint32 tag, Mix_Chunk* chunk, int loops, float pan) {
+    if (!m_enabled || chunk == nullptr || channel < 0 || channel >= static_cast<int>(m_voices.size())) return false;
+    AudioCommand command = {};
+    command.type = AUDIO_CMD_PLAY_SOUND;
+    command.channel = channel;
+    command.tag = tag;
+    command.chunk = chunk;
+    command.loops = loops;
+    command.pan = (pan < -1.0f) ? -1.0f : (pan > 1.0f) ? 1.0f : pan;
+    return m_commands.Push(command);
+}
+
+void SoftwareMixer::SetMasterVolume(int volume) {
+    if (!m_enabled) return;
+    AudioCommand command = {};
+    command.type = AUDIO_CMD_CHANNEL_VOLUME;
+    command.volume = volume;
+    m_commands.Push(command);
+}
+
+void SoftwareMixer::StopAll() {
+    if (!m_enabled) return;
+    AudioCommand command = {};
+    command.type = AUDIO_CMD_HALT_CHANNEL;
+    command.channel = -1;
+    m_commands.Push(command);
+}
+
+void SoftwareMixer::PostMix(void* userData, Uint8* stream, int len) {
+    SoftwareMixer* mixer = static_cast<SoftwareMixer*>(userData);
+    mixer->ApplyCommands();
+    Sint16* out = reinterpret_cast<Sint16*>(stream);
+    int frames = len / static_cast<int>(2 * sizeof(Sint16));
+    while (frames > 0) {
+        int block = (frames < SOFT_MIXER_BLOCK_FRAMES) ? frames : SOFT_MIXER_BLOCK_FRAMES;
+        mixer->MixBlock(out, block);
+        out += block * 2;
+        frames -= block;
+    }
+}
+
+void SoftwareMixer::ApplyCommands() {
+    AudioCommand command;
+    while (m_commands.Pop(&command)) {
+        switch (command.type) {
+            case AUDIO_CMD_PLAY_SOUND:
+                StartVoice(command);
+                break;
+            case AUDIO_CMD_CHANNEL_VOLUME:
+                m_masterGain = command.volume / static_cast<float>(MIX_MAX_VOLUME);
+                break;
+            case AUDIO_CMD_HALT_CHANNEL:
+                for (int i = 0; i < static_cast<int>(m_voices.size()); ++i) StopVoice(i);
+                break;
+            default:
+                break;
+        }
+    }
+}
+
+void SoftwareMixer::StopVoice(int channel) {
+    Voice& voice = m_voices[channel];
+    if (!voice.active) return;
+    voice.active = false;
+    if (m_onFinished != nullptr) m_onFinished(channel, voice.tag);
+}
+
+void SoftwareMixer::StartVoice(const AudioCommand& command) {
+    // A stolen channel reports its old play as finished before the new one starts.
+    StopVoice(command.channel);
+    int frames = static_cast<int>(command.chunk->alen / (2 * sizeof(Sint16)));
+    if (frames <= 0) {
+        if (m_onFinished != nullptr) m_onFinished(command.channel, command.tag);
+        return;
+    }
+
+    // Equal-power pan, normalised so a centred voice plays at chunk volume.
+    const float quarterPi = 0.78539816f;
+    float angle = (command.pan + 1.0f) * quarterPi * 0.5f;
+    float gain = command.chunk->volume / static_cast<float>(MIX_MAX_VOLUME) * 1.41421356f;
+
+    Voice& voice = m_voices[command.channel];
+    voice.samples = reinterpret_cast<const Sint16*>(command.chunk->abuf);
+    voice.frames = frames;
+    voice.position = 0;
+    voice.loopsLeft = command.loops;
+    voice.gainLeft = std::cos(angle) * gain;
+    voice.gainRight = std::sin(angle) * gain;
+    voice.tag = command.tag;
+    voice.active = true;
+}
+
+void SoftwareMixer::MixBlock(Sint16* out, int frames) {
+    MixVoiceFn mix = GetMixFunction(m_kernel);
+    float* acc = m_accumulator.data();
+    std::memset(acc, 0, frames * 2 * sizeof(float));
+
+    bool any = false;
+    for (int i = 0; i < static_cast<int>(m_voices.size()); ++i) {
+        Voice& voice = m_voices[i];
+        if (!voice.active) continue;
+        any = true;
+        float gainLeft = voice.gainLeft * m_masterGain;
+        float gainRight = voice.gainRight * m_masterGain;
+        int written = 0;
+        while (written < frames && voice.active) {
+            int count = voice.frames - voice.position;
+            if (count > frames - written) count = frames - written;
+            mix(acc + written * 2, voice.samples + voice.position * 2, count, gainLeft, gainRight);
+            written += count;
+            voice.position += count;
+            if (voice.position >= voice.frames) {
+                if (voice.loopsLeft == 0) {
+                    StopVoice(i);
+                } else {
+                    if (voice.loopsLeft > 0) voice.loopsLeft--;
+                    voice.position = 0;
+                }
+            }
+        }
+    }
+    if (any) {
+        GetResolveFunction(m_kernel)(out, acc, frames);
+    }
+}
+
+void SoftwareMixer::RunBenchmark() {
+    const int voiceCounts[] = {8, 64, 256};
+    const int sourceFrames = 48000;
+    const int blocks = 200;
+    const int blockBytes = SOFT_MIXER_BLOCK_FRAMES * 2 * sizeof(Sint16);
+
+    std::vector<Sint16> source(sourceFrames * 2);
+    Uint32 seed = 12345;
+    for (size_t i = 0; i < source.size(); ++i) {
+        seed = seed * 1664525u + 1013904223u;
+        source[i] = static_cast<Sint16>((seed >> 16) & 0xFFFF) / 4;
+    }
+    std::vector<Sint16> output(SOFT_MIXER_BLOCK_FRAMES * 2);
+    std::vector<float> acc(SOFT_MIXER_BLOCK_FRAMES * 2);
+    double frequency = static_cast<double>(SDL_GetPerformanceFrequency());
+
+    SDL_Log("Mixer benchmark: %d blocks of %d frames, S16 stereo.", blocks, SOFT_MIXER_BLOCK_FRAMES);
+    for (int voices : voiceCounts) {
+        // Each voice reads from its own offset so the working set grows with the voice count.
+        int stride = (sourceFrames - SOFT_MIXER_BLOCK_FRAMES) / voices;
+
+        Uint64 start = SDL_GetPerformanceCounter();
+        for (int b = 0; b < blocks; ++b) {
+            std::memset(output.data(), 0, blockBytes);
+            for (int v = 0; v < voices; ++v) {
+                SDL_MixAudioFormat(reinterpret_cast<Uint8*>(output.data()),
+                                   reinterpret_cast<const Uint8*>(source.data() + v * stride * 2),
+                                   AUDIO_S16SYS, blockBytes, MIX_MAX_VOLUME);
+            }
+        }
+        double stockUs = (SDL_GetPerformanceCounter() - start) * 1000000.0 / frequency / blocks;
+        SDL_Log("  %3d voices: stock SDL_MixAudioFormat %8.1f us/block", voices, stockUs);
+
+        for (int k = 0; k < SOFT_MIXER_KERNEL_COUNT; ++k) {
+            SoftMixerKernel kernel = static_cast<SoftMixerKernel>(k);
+            if (!IsKernelAvailable(kernel)) continue;
+            MixVoiceFn mix = GetMixFunction(kernel);
+            ResolveFn resolve = GetResolveFunction(kernel);
+            start = SDL_GetPerformanceCounter();
+            for (int b = 0; b < blocks; ++b) {
+                std::memset(output.data(), 0, blockBytes);
+                std::memset(acc.data(), 0, acc.size() * sizeof(float));
+                for (int v = 0; v < voices; ++v) {
+                    mix(acc.data(), source.data() + v * stride * 2, SOFT_MIXER_BLOCK_FRAMES, 0.7f, 0.7f);
+                }
+                resolve(output.data(), acc.data(), SOFT_MIXER_BLOCK_FRAMES);
+            }
+            double us = (SDL_GetPerformanceCounter() - start) * 1000000.0 / frequency / blocks;
+            SDL_Log("  %3d voices: %-6s %8.1f us/block (%.2fx stock)", voices, GetKernelName(kernel), us, stockUs / us);
+        }
+    }
+}
@@ -0,0 +1,75 @@
+#ifndef SOFTWAREMIXER_H
+#define SOFTWAREMIXER_H
+
+#include <vector>
+#include <SDL.h>
+#include <SDL_mixer.h>
+#include "AudioCommandQueue.h"
+
+#define SOFT_MIXER_BLOCK_FRAMES 1024
+
+enum SoftMixerKernel {
+    SOFT_MIXER_KERNEL_SCALAR,
+    SOFT_MIXER_KERNEL_SSE2,
+    SOFT_MIXER_KERNEL_AVX2,
+    SOFT_MIXER_KERNEL_COUNT
+};
+
+// Called from the mix callback when the play tagged `tag` ends on `channel`.
+typedef void (*SoftVoiceFinishedFn)(int channel, Uint32 tag);
+
+// Optional effects backend that runs inside SDL_mixer's post-mix hook. Voices
+// are the already-converted S16 stereo chunks, accumulated in float with a
+// vectorised kernel and added on top of whatever SDL_mixer produced.
+// Play() and the other control calls are for the game thread only; the mix
+// callback picks them up through an SPSC queue, so neither side locks.
+// Voices are addressed by channel like SDL_mixer's, so the caller does the
+// voice allocation and stealing for both backends, and Init() is given the
+// size of its pool.
+class SoftwareMixer {
+public:
+    SoftwareMixer();
+
+    bool Init(int voiceCount);
+    void Shutdown();
+    void Reattach();
+    inline bool IsEnabled() const { return m_enabled; }
+    inline SoftMixerKernel GetKernel() const { return m_kernel; }
+
+    inline void SetFinishedCallback(SoftVoiceFinishedFn callback) { m_onFinished = callback; }
+    bool Play(int channel, Uint32 tag, Mix_Chunk* chunk, int loops, float pan);
+    void SetMasterVolume(int volume);
+    void StopAll();
+
+    static SoftMixerKernel DetectKernel();
+    static const char* GetKernelName(SoftMixerKernel kernel);
+    static void RunBenchmark();
+
+private:
+    struct Voice {
+        const Sint16* samples;
+        int frames;
+        int position;
+        int loopsLeft;
+        float gainLeft;
+        float gainRight;
+        Uint32 tag;
+        bool active;
+    };
+
+    static void PostMix(void* userData, Uint8* stream, int len);
+    void ApplyCommands();
+    void StartVoice(const AudioCommand& command);
+    void StopVoice(int channel);
+    void MixBlock(Sint16* out, int frames);
+
+    bool m_enabled;
+    SoftMixerKernel m_kernel;
+    AudioCommandQueue m_commands;
+    std::vector<Voice> m_voices;
+    SoftVoiceFinishedFn m_onFinished;
+    float m_masterGain;
+    std::vector<float> m_accumulator;
+};
+
+#endif // SOFTWAREMIXER_H
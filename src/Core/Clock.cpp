@@ -0,0 +1,115 @@
+#include "Clock.h"
+
+Clock* Clock::s_Instance = nullptr;
+
+void Clock::Init() {
+    m_frequency = SDL_GetPerformanceFrequency();
+    m_lastCounter = SDL_GetPerformanceCounter();
+    m_pendingGameMicros = 0.0;
+    for (int i = 0; i < CLOCK_DOMAIN_COUNT; ++i) {
+        m_domains[i].micros = 0.0;
+        m_domains[i].deltaMicros = 0.0;
+        m_domains[i].scale = 1.0f;
+        m_domains[i].paused = false;
+    }
+}
+
+void Clock::Tick() {
+    Uint64 counter = SDL_GetPerformanceCounter();
+    double realMicros = (counter - m_lastCounter) * 1000000.0 / m_frequency;
+    m_lastCounter = counter;
+    if (m_fixedFrameMicros > 0) {
+        realMicros = static_cast<double>(m_fixedFrameMicros);
+    }
+
+    Domain& real = m_domains[CLOCK_REAL];
+    real.deltaMicros = real.paused ? 0.0 : realMicros * real.scale;
+    real.micros += real.deltaMicros;
+
+    // Hitches (window drags, breakpoints) must not turn into a burst of
+    // simulation, so scaled domains see at most one clamped frame.
+    double clampedMicros = realMicros;
+    if (clampedMicros > CLOCK_MAX_FRAME_DELTA * 1000000.0) {
+        clampedMicros = CLOCK_MAX_FRAME_DELTA * 1000000.0;
+    }
+
+    Domain& ui = m_domains[CLOCK_UI];
+    ui.deltaMicros = ui.paused ? 0.0 : clampedMicros * ui.scale;
+    ui.micros += ui.deltaMicros;
+
+    Domain& game = m_domains[CLOCK_GAME];
+    game.deltaMicros = 0.0;
+    if (!game.paused) {
+        m_pendingGameMicros += clampedMicros * game.scale;
+    }
+}
+
+bool Clock::StepGame(Uint64 stepMicros) {
+    Domain& game = m_domains[CLOCK_GAME];
+    if (game.paused || m_pendingGameMicros < stepMicros) {
+        return false;
+    }
+    m_pendingGameMicros -= stepMicros;
+    game.micros += stepMicros;
+    game.deltaMicros += stepMicros;
+    return true;
+}
+
+Uint32 Clock::GetPendingGameSteps(Uint64 stepMicros) const {
+    if (m_domains[CLOCK_GAME].paused) return 0;
+    return static_cast<Uint32>(m_pendingGameMicros / stepMicros);
+}
+
+Uint32 Clock::GetTicks(ClockDomain domain) const {
+    return static_cast<Uint32>(m_domains[domain].micros / 1000.0);
+}
+
+Uint64 Clock::GetMicros(ClockDomain domain) const {
+    return static_cast<Uint64>(m_domains[domain].micros);
+}
+
+float Clock::GetDeltaTime(ClockDomain domain) const {
+    return static_cast<float>(m_domains[domain].deltaMicros / 1000000.0);
+}
+
+void Clock::ResetTime(ClockDomain domain) {
+    m_domains[domain].micros = 0.0;
+    m_domains[domain].deltaMicros = 0.0;
+    if (domain == CLOCK_GAME) {
+        m_pendingGameMicros = 0.0;
+    }
+}
+
+void Clock::SetTime(ClockDomain domain, Uint64 micros) {
+    m_domains[domain].micros = static_cast<double>(micros);
+    m_domains[domain].deltaMicros = 0.0;
+}
+
+void Clock::DropPendingGameTime() {
+    m_pendingGameMicros = 0.0;
+}
+
+void Clock::SetPaused(ClockDomain domain, bool paused) {
+    m_domains[domain].paused = paused;
+    if (domain == CLOCK_GAME && paused) {
+        m_pendingGameMicros = 0.0;
+    }
+}
+
+bool Clock::IsPaused(ClockDomain domain) const {
+    return m_domains[domain].paused;
+}
+
+void Clock::SetTimeScale(ClockDomain domain, float scale) {
+    m_domains[domain].scale = (scale < 0.0f) ? 0.0f : scale;
+    SDL_Log("Clock domain %d time scale set to %.2f", domain, m_domains[domain].scale);
+}
+
+float Clock::GetTimeScale(ClockDomain domain) const {
+    return m_domains[domain].scale;
+}
+
+void Clock::SetFixedFrameDelta(Uint64 micros) {
+    m_fixedFrameMicros = micros;
+    SDL_Log("Clock fixed frame delta set to %llu us", static_cast<unsigned long long>(micros));
+}
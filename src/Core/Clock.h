@@ -0,0 +1,65 @@
+#ifndef CLOCK_H
+#define CLOCK_H
+
+#include "SDL.h"
+
+#define CLOCK_MAX_FRAME_DELTA 0.05f
+#define CLOCK_FAST_FORWARD_SCALE 64.0f
+
+enum ClockDomain {
+    CLOCK_REAL,
+    CLOCK_GAME,
+    CLOCK_UI,
+    CLOCK_DOMAIN_COUNT
+};
+
+// Central time source. REAL follows the wall clock, UI drives menus and
+// transitions, GAME only advances when the simulation consumes a step so
+// every gameplay timer sees exactly the simulated time.
+class Clock {
+public:
+    static Clock* GetInstance() {
+        return s_Instance = (s_Instance != nullptr) ? s_Instance : new Clock();
+    }
+
+    void Init();
+    void Tick();
+    bool StepGame(Uint64 stepMicros);
+    Uint32 GetPendingGameSteps(Uint64 stepMicros) const;
+
+    Uint32 GetTicks(ClockDomain domain) const;
+    Uint64 GetMicros(ClockDomain domain) const;
+    float GetDeltaTime(ClockDomain domain) const;
+
+    void ResetTime(ClockDomain domain);
+    void SetTime(ClockDomain domain, Uint64 micros);
+    void DropPendingGameTime();
+    void SetPaused(ClockDomain domain, bool paused);
+    bool IsPaused(ClockDomain domain) const;
+    void SetTimeScale(ClockDomain domain, float scale);
+    float GetTimeScale(ClockDomain domain) const;
+
+    // Advance every frame by a fixed amount instead of the wall clock, so
+    // offline runs are deterministic and not limited to real time. 0 = off.
+    void SetFixedFrameDelta(Uint64 micros);
+    inline Uint64 GetFixedFrameDelta() const { return m_fixedFrameMicros; }
+
+private:
+    Clock() : m_frequency(1), m_lastCounter(0), m_pendingGameMicros(0.0), m_fixedFrameMicros(0) {}
+    static Clock* s_Instance;
+
+    struct Domain {
+        double micros;
+        double deltaMicros;
+        float scale;
+        bool paused;
+    };
+
+    Uint64 m_frequency;
+    Uint64 m_lastCounter;
+    double m_pendingGameMicros;
+    Uint64 m_fixedFrameMicros;
+    Domain m_domains[CLOCK_DOMAIN_COUNT];
+};
+
+#endif // CLOCK_H
@@ -1,170 +1,72 @@
 #include <algorithm>
 #include <cmath>
+#include <cstring>
 #include <iomanip>
-#include <numeric>
 #include <sstream>
 #include <string>
 #include <vector>
 
 #include "../Audio/AudioManager.h"
+#include "../Debug/AllocTracker.h"
+#include "../Debug/FrameCapture.h"
+#include "../Debug/LatencyProbe.h"
+#include "../Debug/SessionReport.h"
+#include "../Debug/Tracer.h"
+#include "../Graphics/RenderStats.h"
 #include "../Graphics/TextureManager.h"
+#include "../Input/InputManager.h"
+#include "../Input/InputRecorder.h"
 #include "../Menu/MainMenu.h"
+#include "../Objects/GhostManager.h"
 #include "../Objects/Player.h"
 #include "../Menu/Pause_Menu.h"
+#include "../Net/NetSession.h"
+#include "Clock.h"
+#include "EventQueue.h"
+#include "FramePacer.h"
+#include "Log.h"
 #include "Engine.h"
 
 Engine* Engine::s_Instance = nullptr;
 
 
-void Engine::TogglePause() {
-  if (m_gameState == STATE_PLAYING) {
-    m_isPaused = !m_isPaused;
-    if (m_isPaused) {
-      m_gameState = STATE_PAUSED;
-      SDL_Log("Jeu mis en pause");
-    } else {
-      m_gameState = STATE_PLAYING;
-      SDL_Log("Jeu repris");
-    }
+void Engine::SetPaused(bool paused) {
+  // The other peer keeps racing; a net race can only be left.
+  if (paused && NetSession::GetInstance()->IsActive()) return;
+  if (m_isPaused != paused) {
+    GameEvent event;
+    event.type = EVENT_PAUSE_CHANGED;
+    event.time = Clock::GetInstance()->GetTicks(CLOCK_GAME);
+    event.pause.paused = paused;
+    EventQueue::GetInstance()->Push(event);
   }
+  if (paused && !m_isPaused) {
+    PauseMenu::GetInstance()->Open();
+  }
+  if (paused != m_isPaused) {
+    InvalidateScene();
+  }
+  m_isPaused = paused;
+  Clock::GetInstance()->SetPaused(CLOCK_GAME, paused);
+  InputManager::GetInstance()->ClearQueue();
+  if (!paused && m_Player) ResyncHeldBrakes();
 }
 
-void Engine::RenderPauseMenu() {
-
-    SDL_SetRenderDrawBlendMode(m_Renderer, SDL_BLENDMODE_BLEND);
-
-    int menuWidth = 400;
-    int menuHeight = 200;
-    int menuX = (SCREEN_WIDTH - menuWidth) / 2;
-    int menuY = (SCREEN_HEIGHT - menuHeight) / 2;
-    SDL_Rect pauseMenuRect = { menuX, menuY, menuWidth, menuHeight };
-
-
-    SDL_SetRenderDrawColor(m_Renderer, 71, 71, 71, 23);
-    SDL_RenderFillRect(m_Renderer, &pauseMenuRect);
-
-
-    SDL_Color textColor = {25, 15, 70};
-    TTF_Font* font = TTF_OpenFont("assets/FiraCode-Bold.ttf", 54);
-    if (!font) {
-        SDL_Log("Erreur chargement font: %s", TTF_GetError());
-        return;
-    }
-
-    SDL_Surface* continueSurface = TTF_RenderText_Solid(font, "Continuer ", textColor);
-    SDL_Texture* continueTexture = SDL_CreateTextureFromSurface(m_Renderer, continueSurface);
-    SDL_FreeSurface(continueSurface);
-    SDL_Rect continueRect = { menuX + 100, menuY + 40, 200, 40 };
-    SDL_RenderCopy(m_Renderer, continueTexture, NULL, &continueRect);
-    SDL_DestroyTexture(continueTexture);
-
-    SDL_Surface* restartSurface = TTF_RenderText_Solid(font, "Quitter ", textColor);
-    SDL_Texture* restartTexture = SDL_CreateTextureFromSurface(m_Renderer, restartSurface);
-    SDL_FreeSurface(restartSurface);
-    SDL_Rect restartRect = { menuX + 100, menuY + 90, 200, 40 };
-    SDL_RenderCopy(m_Renderer, restartTexture, NULL, &restartRect);
-    SDL_DestroyTexture(restartTexture);
-
-   SDL_Color gold = {26, 15, 70, 255};
-   if(m_menuOption == 0) {
-      SDL_Surface* arrowSurface = TTF_RenderText_Solid(font, ">", gold);
-      SDL_Rect arrowRect = {continueRect.x - 30, continueRect.y, 20, 30};
-      SDL_RenderCopy(m_Renderer, SDL_CreateTextureFromSurface(m_Renderer, arrowSurface), NULL, &arrowRect);
-}
-   else {
-     SDL_Surface* arrowSurface = TTF_RenderText_Solid(font, ">", gold);
-     SDL_Rect arrowRect = {restartRect.x - 30, restartRect.y, 20, 30};
-     SDL_RenderCopy(m_Renderer, SDL_CreateTextureFromSurface(m_Renderer, arrowSurface), NULL, &arrowRect);
-}
-
-
-    TTF_CloseFont(font);
-}
-
-
-
-void Engine::ResetGameData()
-{
-
-    m_remainingSeconds = 60;
-    m_totalDistanceTraveled = 0.0f;
-    m_showGameOverScreen = false;
-
-    m_obstacles.clear();
-
-    m_obstacleSpawnInterval = 2.3f;
-    m_timeSinceLastSpawn = 0.0f;
-    m_minSpawnInterval = 0.55f;
-    m_spawnIntervalReduction = 0.18f;
-
-    m_lastMaxSpeedIncreaseTime = 0;
-    m_maxSpeedIncreaseInterval = 1000;
-    m_maxSpeedIncreaseAmount = 20.0f;
-
-    if (m_Player != nullptr) {
-        delete m_Player;
-        m_Player = nullptr;
-    }
-
-    m_gameState = STATE_PLAYING;
-    m_isPaused = false;
-
-
-    m_currentMasterVolume = VOLUME_MAX;
-    m_isMuted = false;
+void Engine::ResetGameData() {
+  m_remainingSeconds = 60;
+  m_showGameOverScreen = false;
+  m_obstacles.clear();
+  m_timeSinceLastSpawn = 1.0f;
+  m_obstacleSpawnInterval = 2.3f;
+  for (int i = 0; i < MAX_RIDERS; ++i) {
+    m_riderDistance[i] = 0.0f;
+    if (m_riders[i]) m_riders[i]->reset(PLAYER_START_X, m_laneYPositions);
+  }
 }
 
 
 
 
-void Engine::HandleEvents(SDL_Event& e) {
-    if (e.type == SDL_KEYDOWN) {
-        if (e.key.keysym.sym == SDLK_p) {
-            TogglePause();
-        }
-
-        if (m_isPaused) {
-            if (e.key.keysym.sym == SDLK_UP) {
-                m_menuOption = 0;
-                SDL_Log("Option sélectionnée: Continuer");
-            }
-            if (e.key.keysym.sym == SDLK_DOWN) {
-                m_menuOption = 1;
-                SDL_Log("Option sélectionnée: Redémarrer");
-            }
-            if (e.key.keysym.sym == SDLK_RETURN) {
-                if (m_menuOption == 0) {
-                    m_isPaused = false;
-                    m_gameState = STATE_PLAYING;
-                    SDL_Log("Jeu repris");
-                } else if (m_menuOption == 1) {
-                    ResetGameData();
-                    m_isPaused = false;
-
-                    m_gameState = STATE_MAIN_MENU;
-                    SDL_Log("Jeu redémarré");
-                }
-            }
-        }
-    }
-    else if (e.type == SDL_MOUSEBUTTONDOWN && m_isPaused) {
-        if (e.button.button == SDL_BUTTON_LEFT) {
-            SDL_Point mousePos = {e.button.x, e.button.y};
-
-            if (SDL_PointInRect(&mousePos, &continueRect)) {
-                m_isPaused = false;
-                m_gameState = STATE_PLAYING;
-                SDL_Log("Clic sur Continuer");
-            }
-            else if (SDL_PointInRect(&mousePos, &restartRect)) {
-                ResetGameData();
-                m_isPaused = false;
-                m_gameState = STATE_MAIN_MENU;
-                SDL_Log("Clic sur Redémarrer");
-            }
-        }
-    }
-}
 void Engine::ApplyMasterVolume() {
   if (m_isMuted) {
     AudioManager::GetInstance()->SetMusicVolume(0);
@@ -212,8 +114,22 @@ void Engine::ToggleMute() {
   ApplyMasterVolume();
 }
 
+void Engine::SetHeadless(bool headless) {
+  m_headless = headless;
+}
+
+void Engine::SetSeed(Uint32 seed) {
+  m_rng.Seed(seed);
+  SDL_Log("Engine RNG seeded with %u", seed);
+}
+
 bool Engine::Init() {
-  if (SDL_Init(SDL_INIT_VIDEO | SDL_INIT_TIMER | SDL_INIT_AUDIO) != 0) {
+  if (m_headless) {
+    // Keep an explicit driver choice from the environment, e.g. offscreen.
+    SDL_setenv("SDL_VIDEODRIVER", "dummy", 0);
+    SDL_setenv("SDL_AUDIODRIVER", "dummy", 0);
+  }
+  if (SDL_Init(SDL_INIT_VIDEO | SDL_INIT_TIMER | SDL_INIT_AUDIO | SDL_INIT_GAMECONTROLLER) != 0) {
     SDL_Log("Failed to initialize SDL: %s", SDL_GetError());
     return false;
   }
@@ -236,16 +152,30 @@ bool Engine::Init() {
     return false;
   }
 
-  m_Window = SDL_CreateWindow("Velo Game", SDL_WINDOWPOS_CENTERED, SDL_WINDOWPOS_CENTERED, SCREEN_WIDTH, SCREEN_HEIGHT, 0);
-  if (m_Window == nullptr) {
-    SDL_Log("Failed to create Window: %s", SDL_GetError());
-    AudioManager::GetInstance()->Clean();
-    TTF_Quit();
-    IMG_Quit();
-    SDL_Quit();
-    return false;
+  if (m_headless) {
+    // No window at all: the software renderer draws into a plain surface.
+    m_frameSurface = SDL_CreateRGBSurfaceWithFormat(0, SCREEN_WIDTH, SCREEN_HEIGHT, 32, SDL_PIXELFORMAT_RGBA32);
+    if (m_frameSurface == nullptr) {
+      SDL_Log("Failed to create headless surface: %s", SDL_GetError());
+      AudioManager::GetInstance()->Clean();
+      TTF_Quit();
+      IMG_Quit();
+      SDL_Quit();
+      return false;
+    }
+    m_Renderer = SDL_CreateSoftwareRenderer(m_frameSurface);
+  } else {
+    m_Window = SDL_CreateWindow("Velo Game", SDL_WINDOWPOS_CENTERED, SDL_WINDOWPOS_CENTERED, SCREEN_WIDTH, SCREEN_HEIGHT, 0);
+    if (m_Window == nullptr) {
+      SDL_Log("Failed to create Window: %s", SDL_GetError());
+      AudioManager::GetInstance()->Clean();
+      TTF_Quit();
+      IMG_Quit();
+      SDL_Quit();
+      return false;
+    }
+    m_Renderer = SDL_CreateRenderer(m_Window, -1, SDL_RENDERER_ACCELERATED | SDL_RENDERER_PRESENTVSYNC);
   }
-  m_Renderer = SDL_CreateRenderer(m_Window, -1, SDL_RENDERER_ACCELERATED | SDL_RENDERER_PRESENTVSYNC);
   if (m_Renderer == nullptr) {
     SDL_Log("Failed to create Renderer: %s", SDL_GetError());
     SDL_DestroyWindow(m_Window);
@@ -265,6 +195,9 @@ bool Engine::Init() {
     SDL_Quit();
     return false;
   }
+  if (!PauseMenu::GetInstance()->Init()) {
+    SDL_Log("Erreur : Échec de l'initialisation du menu pause.");
+  }
 
   if (!TextureManager::GetInstance()->Load("background", "assets/Background1.png")) {
     return false;
@@ -302,6 +235,8 @@ bool Engine::Init() {
   }
 
   m_obstacleTextureIds.clear();
+  // Spawning never exceeds MAX_OBSTACLES, so the list never reallocates mid-run.
+  m_obstacles.reserve(MAX_OBSTACLES);
   std::vector<std::pair<std::string, std::string>> obstaclesToLoad = {{"obstacle1", "assets/obstacle1.png"}, {"obstacle2", "assets/obstacle2.png"}, {"obstacle3", "assets/obstacle3.png"}, {"obstacle4", "assets/obstacle4.png"}};
   bool firstObstacleLoaded = false;
   for (const auto& obsData : obstaclesToLoad) {
@@ -330,21 +265,26 @@ bool Engine::Init() {
   if (!AudioManager::GetInstance()->LoadMusic("game_music", "assets/audio/game_loop.ogg")) {
     SDL_Log("Failed to load game music");
   }
-  if (!AudioManager::GetInstance()->LoadSound("click", "assets/audio/button_click.wav")) {
+  AudioManager::GetInstance()->PrefetchMusic("menu_music");
+  if (!AudioManager::GetInstance()->LoadSound("click", "assets/audio/button_click.wav", 1, 2)) {
     SDL_Log("Failed to load click sound");
   }
-  if (!AudioManager::GetInstance()->LoadSound("crash", "assets/audio/player_crash.wav")) {
+  if (!AudioManager::GetInstance()->LoadSound("crash", "assets/audio/player_crash.wav", 2, 2)) {
     SDL_Log("Failed to load crash sound");
   }
-  if (!AudioManager::GetInstance()->LoadSound("win", "assets/audio/level_win.wav")) {
+  if (!AudioManager::GetInstance()->LoadSound("win", "assets/audio/level_win.wav", 3, 1)) {
     SDL_Log("Failed to load win sound");
   }
-  if (!AudioManager::GetInstance()->LoadSound("lose", "assets/audio/game_over.wav")) {
+  if (!AudioManager::GetInstance()->LoadSound("lose", "assets/audio/game_over.wav", 3, 1)) {
     SDL_Log("Failed to load lose sound");
   }
-  if (!AudioManager::GetInstance()->LoadSound("countdown", "assets/audio/timer_tick.wav")) {
+  if (!AudioManager::GetInstance()->LoadSound("countdown", "assets/audio/timer_tick.wav", 1, 1)) {
     SDL_Log("Failed to load countdown sound");
   }
+  m_crashSound = AudioManager::GetInstance()->GetSoundHandle("crash");
+  m_countdownSound = AudioManager::GetInstance()->GetSoundHandle("countdown");
+  m_winSound = AudioManager::GetInstance()->GetSoundHandle("win");
+  m_loseSound = AudioManager::GetInstance()->GetSoundHandle("lose");
 
   m_uiFont = TTF_OpenFont("assets/FiraCode-Bold.ttf", 24);
   if (m_uiFont == nullptr) {
@@ -363,12 +303,17 @@ bool Engine::Init() {
   m_laneYPositions.push_back(TRACK_Y_POSITION + laneHeight * 0.5f);
   m_laneYPositions.push_back(TRACK_Y_POSITION + laneHeight * 1.5f);
   m_laneYPositions.push_back(TRACK_Y_POSITION + laneHeight * 2.5f);
-  m_Player = new Player();
-  float playerStartX = 150.0f;
-  if (!m_Player || !m_Player->load("player", playerStartX, m_laneYPositions)) {
+  bool ridersLoaded = true;
+  for (int i = 0; i < MAX_RIDERS; ++i) {
+    m_riders[i] = new Player(i);
+    if (!m_riders[i]->load("player", PLAYER_START_X, m_laneYPositions)) ridersLoaded = false;
+  }
+  if (!ridersLoaded) {
     SDL_Log("Failed player load");
-    if (m_Player) delete m_Player;
-    m_Player = nullptr;
+    for (int i = 0; i < MAX_RIDERS; ++i) {
+      delete m_riders[i];
+      m_riders[i] = nullptr;
+    }
     AudioManager::GetInstance()->Clean();
     TextureManager::GetInstance()->Clean();
     TTF_CloseFont(m_uiFont);
@@ -379,11 +324,21 @@ bool Engine::Init() {
     SDL_Quit();
     return false;
   }
+  if (NetSession::GetInstance()->IsActive()) {
+    if (m_splitScreen) SDL_Log("Engine::Init - Split screen is not available in a net race.");
+    m_splitScreen = false;
+    m_riderCount = 2;
+    m_localRider = NetSession::GetInstance()->GetLocalRider();
+  } else if (m_splitScreen) {
+    m_riderCount = 2;
+  }
+  m_Player = m_riders[m_localRider];
+  CreateHudText();
 
   SDL_Color textColor = {255, 255, 255, 255};
-  SDL_Surface* surface = TTF_RenderText_Solid(m_uiFont, "Cliquer sur Esc pour retourner au menu principale", textColor);
+  SDL_Surface* surface = RenderStats::GetInstance()->RenderText(m_uiFont, "Cliquer sur Esc pour retourner au menu principale", textColor);
   if (surface) {
-    m_returnPromptTexture = SDL_CreateTextureFromSurface(m_Renderer, surface);
+    m_returnPromptTexture = RenderStats::GetInstance()->CreateTextureFromSurface(m_Renderer, surface);
     if (m_returnPromptTexture) {
       m_returnPromptRect.w = surface->w;
       m_returnPromptRect.h = surface->h;
@@ -397,27 +352,35 @@ bool Engine::Init() {
     SDL_Log("Failed to create return prompt surface: %s", TTF_GetError());
   }
 
-  m_lastTick = SDL_GetTicks();
+  Clock::GetInstance()->Init();
+  FramePacer::GetInstance()->Init(m_Renderer, m_Window);
+  m_resolutionScaler.Init(SCREEN_WIDTH, SCREEN_HEIGHT);
+  if (!FrameCapture::GetInstance()->Init(m_Renderer, SCREEN_WIDTH, SCREEN_HEIGHT)) {
+    return false;
+  }
+  if (FrameCapture::GetInstance()->IsEnabled()) {
+    // Captured frames must not depend on how fast this machine renders.
+    m_resolutionScaler.SetFixedScale(RES_SCALE_MAX);
+  }
+  InputManager::GetInstance()->Init();
+  // Headless runs must render the same frames whatever was played before.
+  GhostManager::GetInstance()->Init(m_headless ? nullptr : GHOST_BEST_PATH);
+  m_lastUpdateTicks = SDL_GetTicks();
+  m_gameTimers.Reset(Clock::GetInstance()->GetTicks(CLOCK_GAME));
   m_deltaTime = 0.0f;
-  m_BackgroundScrollX = 0.0f;
   m_IsRunning = true;
   m_remainingSeconds = 60;
-  m_lastSecondUpdate = SDL_GetTicks();
-  m_gameOverStartTime = 0;
   m_showGameOverScreen = false;
-  m_totalDistanceTraveled = 0.0f;
   m_timeSinceLastSpawn = 1.0f;
   m_obstacleSpawnInterval = 2.3f;
-  m_lastDifficultyIncreaseTime = SDL_GetTicks();
-  m_lastMaxSpeedIncreaseTime = SDL_GetTicks();
-  m_distanceTexture = nullptr;
-  m_lastDisplayedDistance = -1;
-  m_lastCountdownSecondPlayed = -1;
   m_showReturnPrompt = false;
-  m_endScreenStartTime = 0;
+
+  EventQueue::GetInstance()->Subscribe(EVENT_MASK_ALL, &Engine::OnAudioEvents, this);
+  EventQueue::GetInstance()->Subscribe(EVENT_MASK(EVENT_COLLISION) | EVENT_MASK(EVENT_LANE_CHANGE), &Engine::OnStatsEvents, this);
 
   ApplyMasterVolume();
-  SetGameState(STATE_MAIN_MENU);
+  // A net race starts as soon as the peers find each other.
+  SetGameState(NetSession::GetInstance()->IsActive() ? STATE_START_SCREEN : STATE_MAIN_MENU);
 
   SDL_Log("Engine initialization successful!");
   return true;
@@ -430,240 +393,780 @@ void Engine::SetGameState(GameState newState) {
   m_gameState = newState;
   SDL_Log("Changing GameState from %d to %d", oldState, newState);
   m_showReturnPrompt = false;
+  InvalidateScene();
+  if (oldState != STATE_PAUSED && newState != STATE_PAUSED) {
+    m_gameTimers.CancelAll();
+  }
 
-    if (oldState == STATE_PLAYING && newState == STATE_PAUSED) {
-        AudioManager::GetInstance()->PauseMusic();
-    }
-    else if (oldState == STATE_PAUSED && newState == STATE_PLAYING) {
-        AudioManager::GetInstance()->ResumeMusic();
+  GameEvent event;
+  event.type = EVENT_STATE_CHANGED;
+  event.time = Clock::GetInstance()->GetTicks(CLOCK_GAME);
+  event.stateChange.oldState = oldState;
+  event.stateChange.newState = newState;
+  EventQueue::GetInstance()->Push(event);
+
+  if (oldState == STATE_PLAYING && newState != STATE_PAUSED) {
+    InputRecorder::GetInstance()->EndRun(m_runStep);
+    // Split screen forces a win for rider 0 whoever finished, so those runs
+    // are not kept as ghosts either.
+    if (!m_splitScreen && (newState == STATE_WIN || newState == STATE_GAME_OVER)) {
+      GhostManager::GetInstance()->EndRun(m_runStep, GetLocalDistance(), newState == STATE_WIN);
+    } else {
+      GhostManager::GetInstance()->DiscardRun();
     }
+    const char* result = newState == STATE_WIN ? "win" : newState == STATE_GAME_OVER ? "lose" : "quit";
+    SessionReport::GetInstance()->EndRun(result, GetLocalDistance(), m_collisionCount,
+                                         m_Player ? m_Player->getSpeed() : 0.0f);
+  }
+
   switch (newState) {
-    case STATE_MAIN_MENU:
-      AudioManager::GetInstance()->PlayMusic("menu_music", -1);
-      break;
-    case STATE_ABOUT:
-      if (!Mix_PlayingMusic() || !Mix_FadingMusic()) {
-        AudioManager::GetInstance()->PlayMusic("menu_music", -1);
+    case STATE_PLAYING:
+      if (oldState != STATE_PAUSED) {
+        m_collisionCount = 0;
+        m_laneChangeCount = 0;
+        SessionReport::GetInstance()->BeginRun();
+        BeginRun();
+        ScheduleRunTimers(m_difficultyIncreaseInterval, m_maxSpeedIncreaseInterval, 1000);
+        CaptureSnapshot(&m_runStartSnapshot);
+        m_snapshots.Clear();
+        *m_snapshots.Push() = m_runStartSnapshot;
+        GhostManager::GetInstance()->BeginRun();
+        if (m_Player) GhostManager::GetInstance()->Sample(m_runStep, m_Player->GetY(), GetLocalDistance());
       }
       break;
-    case STATE_START_SCREEN:
-      AudioManager::GetInstance()->StopMusic();
-      break;
-    case STATE_PLAYING:
-      if (oldState != STATE_START_SCREEN) {
-        AudioManager::GetInstance()->StopMusic();
+
+    case STATE_MAIN_MENU:
+      if (NetSession::GetInstance()->IsActive()) {
+        NetSession::GetInstance()->Close();
+        m_riderCount = 1;
+        m_localRider = 0;
+        m_Player = m_riders[0];
       }
-      AudioManager::GetInstance()->PlayMusic("game_music", -1);
-      m_lastCountdownSecondPlayed = -1;
       break;
 
     case STATE_GAME_OVER:
-      AudioManager::GetInstance()->StopMusic();
-      AudioManager::GetInstance()->PlaySound("lose", 0);
-      m_endScreenStartTime = SDL_GetTicks();
+      m_showGameOverScreen = false;
+      m_gameTimers.Schedule(GAME_OVER_SCREEN_DELAY, [this]() {
+        SDL_Log("Game Over delay finished. Displaying Game Over screen.");
+        m_showGameOverScreen = true;
+        InvalidateScene();
+      });
+      m_gameTimers.Schedule(RETURN_PROMPT_DELAY, [this]() {
+        m_showReturnPrompt = true;
+        InvalidateScene();
+      });
       break;
     case STATE_WIN:
-      AudioManager::GetInstance()->StopMusic();
-      AudioManager::GetInstance()->PlaySound("win", 0);
-      m_endScreenStartTime = SDL_GetTicks();
+      m_gameTimers.Schedule(RETURN_PROMPT_DELAY, [this]() {
+        m_showReturnPrompt = true;
+        InvalidateScene();
+      });
       break;
+    default:
+      break;
+  }
+}
+
+void Engine::OnAudioEvents(const GameEvent* events, int count, void* userData) {
+  Engine* engine = static_cast<Engine*>(userData);
+  AudioManager* audio = AudioManager::GetInstance();
+  for (int i = 0; i < count; ++i) {
+    const GameEvent& event = events[i];
+    switch (event.type) {
+      case EVENT_COLLISION:
+        audio->PlaySound(engine->m_crashSound, 0, engine->GetLanePan(event.collision.y + engine->m_obstacleTextureHeight / 2.0f));
+        break;
+      case EVENT_SECOND_TICK:
+        if (event.secondTick.remainingSeconds <= 10 && event.secondTick.remainingSeconds > 0) {
+          audio->PlaySound(engine->m_countdownSound, 0);
+        }
+        break;
+      case EVENT_WIN:
+        audio->StopMusic();
+        audio->PlaySound(engine->m_winSound, 0);
+        break;
+      case EVENT_LOSE:
+        audio->StopMusic();
+        audio->PlaySound(engine->m_loseSound, 0);
+        break;
+      case EVENT_PAUSE_CHANGED:
+        if (event.pause.paused) {
+          audio->PauseMusic();
+        } else {
+          audio->ResumeMusic();
+        }
+        break;
+      case EVENT_STATE_CHANGED:
+        switch (event.stateChange.newState) {
+          case STATE_MAIN_MENU:
+            if (!audio->IsMusicPlaying("menu_music")) {
+              audio->PlayMusic("menu_music", -1);
+            }
+            audio->PrefetchMusic("game_music");
+            break;
+          case STATE_ABOUT:
+            if (!audio->IsMusicPlaying("menu_music")) {
+              audio->PlayMusic("menu_music", -1);
+            }
+            break;
+          case STATE_START_SCREEN:
+            audio->StopMusic();
+            audio->PrefetchMusic("game_music");
+            break;
+          case STATE_PLAYING:
+            if (event.stateChange.oldState == STATE_PAUSED) {
+              audio->ResumeMusic();
+              break;
+            }
+            audio->PlayMusic("game_music", -1);
+            audio->PrefetchMusic("menu_music");
+            break;
+          default:
+            break;
+        }
+        break;
+      default:
+        break;
+    }
+  }
+}
+
+float Engine::GetLanePan(float y) const {
+  if (m_laneYPositions.size() < 2) return 0.0f;
+  float top = m_laneYPositions.front();
+  float bottom = m_laneYPositions.back();
+  float t = (y - top) / (bottom - top);
+  t = (t < 0.0f) ? 0.0f : (t > 1.0f) ? 1.0f : t;
+  return (t * 2.0f - 1.0f) * LANE_PAN_WIDTH;
+}
+
+void Engine::OnStatsEvents(const GameEvent* events, int count, void* userData) {
+  Engine* engine = static_cast<Engine*>(userData);
+  for (int i = 0; i < count; ++i) {
+    if (events[i].type == EVENT_COLLISION) {
+      engine->m_collisionCount++;
+      TRACE_INSTANT("Collision");
+      LOG_DEBUG("Collision detected! (%d this run)", engine->m_collisionCount);
+    } else if (events[i].type == EVENT_LANE_CHANGE) {
+      // Same rule as collisions: a net race only counts the local rider.
+      if (engine->m_splitScreen || events[i].laneChange.rider == engine->m_localRider) {
+        engine->m_laneChangeCount++;
+      }
+    }
+  }
+}
+
+void Engine::BeginRun() {
+  // Every run starts from step 0 on a fresh game clock and its own seed, so
+  // a recorded run replays identically regardless of when it was started.
+  InputRecorder* recorder = InputRecorder::GetInstance();
+  Uint32 seed;
+  if (NetSession::GetInstance()->IsActive()) {
+    seed = NetSession::GetInstance()->GetSeed();
+  } else {
+    seed = recorder->IsReplaying() ? recorder->GetReplaySeed() : m_rng();
+  }
+  m_rng.Seed(seed);
+  Clock::GetInstance()->ResetTime(CLOCK_GAME);
+  m_gameTimers.Reset(0);
+  m_runStep = 0;
+  m_netLocalInput = 0;
+  m_netChecksumFrame = 0;
+  m_netResimCheckStep = 0;
+  recorder->BeginRun(seed);
+}
+
+void Engine::ScheduleRunTimers(Uint32 difficultyDelay, Uint32 maxSpeedDelay, Uint32 countdownDelay) {
+  m_difficultyTimer = m_gameTimers.SchedulePeriodic(m_difficultyIncreaseInterval, [this]() {
+    m_obstacleSpawnInterval -= m_spawnIntervalReduction;
+    if (m_obstacleSpawnInterval < m_minSpawnInterval) m_obstacleSpawnInterval = m_minSpawnInterval;
+    LOG_INFO("Spawn Rate Increased! New interval: %.2f", m_obstacleSpawnInterval);
+  }, difficultyDelay);
+  m_maxSpeedTimer = m_gameTimers.SchedulePeriodic(m_maxSpeedIncreaseInterval, [this]() {
+    for (int i = 0; i < m_riderCount; ++i) {
+      m_riders[i]->IncreaseMaxSpeed(m_maxSpeedIncreaseAmount, m_absoluteMaxPlayerSpeed);
+    }
+  }, maxSpeedDelay);
+  m_countdownTimer = m_gameTimers.SchedulePeriodic(1000, [this]() { OnCountdownSecond(); }, countdownDelay);
+}
+
+void Engine::SetSnapshotInterval(Uint32 steps) {
+  m_snapshotInterval = steps > 0 ? steps : 1;
+  SDL_Log("Engine: snapshot every %u steps (%u kept)", m_snapshotInterval, SNAPSHOT_RING_CAPACITY);
+}
+
+// Fails rather than saving part of the state; a partial snapshot would
+// restore to a different run.
+bool Engine::CaptureSnapshot(GameSnapshot* out) const {
+  if (m_obstacles.size() > SNAPSHOT_MAX_OBSTACLES) return false;
+  // Cleared first so padding is zero and checksums only see real state.
+  std::memset(static_cast<void*>(out), 0, sizeof(*out));
+  out->runStep = m_runStep;
+  out->gameMicros = Clock::GetInstance()->GetMicros(CLOCK_GAME);
+  out->rng = m_rng;
+  out->riderCount = m_riderCount;
+  for (int i = 0; i < m_riderCount; ++i) {
+    m_riders[i]->SaveState(&out->players[i]);
+    out->riderDistance[i] = m_riderDistance[i];
+  }
+
+  int count = 0;
+  for (const auto& obs : m_obstacles) {
+    ObstacleState& state = out->obstacles[count++];
+    state.collider = obs.collider;
+    state.x = obs.x;
+    state.textureIndex = static_cast<Uint8>(obs.textureIndex);
+    state.hitMask = obs.hitMask;
+  }
+  out->obstacleCount = count;
+
+  out->remainingSeconds = m_remainingSeconds;
+  out->obstacleSpawnInterval = m_obstacleSpawnInterval;
+  out->timeSinceLastSpawn = m_timeSinceLastSpawn;
+  out->collisionCount = m_collisionCount;
+  out->laneChangeCount = m_laneChangeCount;
+
+  out->difficultyTimerMs = m_gameTimers.GetRemaining(m_difficultyTimer);
+  out->maxSpeedTimerMs = m_gameTimers.GetRemaining(m_maxSpeedTimer);
+  out->countdownTimerMs = m_gameTimers.GetRemaining(m_countdownTimer);
+  return true;
+}
+
+void Engine::RestoreSimState(const GameSnapshot& snapshot) {
+  m_runStep = snapshot.runStep;
+  Clock::GetInstance()->SetTime(CLOCK_GAME, snapshot.gameMicros);
+  m_gameTimers.Reset(Clock::GetInstance()->GetTicks(CLOCK_GAME));
+  ScheduleRunTimers(snapshot.difficultyTimerMs, snapshot.maxSpeedTimerMs, snapshot.countdownTimerMs);
+  m_rng = snapshot.rng;
+  for (int i = 0; i < snapshot.riderCount; ++i) {
+    m_riders[i]->LoadState(snapshot.players[i]);
+    m_riderDistance[i] = snapshot.riderDistance[i];
+  }
+
+  m_obstacles.clear();
+  for (int i = 0; i < snapshot.obstacleCount; ++i) {
+    const ObstacleState& state = snapshot.obstacles[i];
+    Obstacle obs;
+    obs.collider = state.collider;
+    obs.x = state.x;
+    obs.hitMask = state.hitMask;
+    obs.textureIndex = state.textureIndex;
+    m_obstacles.push_back(obs);
+  }
+
+  m_remainingSeconds = snapshot.remainingSeconds;
+  m_obstacleSpawnInterval = snapshot.obstacleSpawnInterval;
+  m_timeSinceLastSpawn = snapshot.timeSinceLastSpawn;
+  m_collisionCount = snapshot.collisionCount;
+  m_laneChangeCount = snapshot.laneChangeCount;
+}
+
+void Engine::RestoreSnapshot(const GameSnapshot& snapshot, bool fork) {
+  RestoreSimState(snapshot);
+
+  InputRecorder* recorder = InputRecorder::GetInstance();
+  if (fork) {
+    recorder->Fork(m_runStep);
+  } else {
+    recorder->Rewind(m_runStep);
+  }
+  GhostManager::GetInstance()->Rewind(m_runStep);
+  InputManager::GetInstance()->ClearQueue();
+  ResyncHeldBrakes();
+  InvalidateScene();
+}
+
+void Engine::ResyncHeldBrakes() {
+  // Live input continues from whatever is held now, not from the snapshot.
+  InputRecorder* recorder = InputRecorder::GetInstance();
+  if (recorder->IsReplaying()) return;
+  if (m_splitScreen) {
+    for (int r = 0; r < m_riderCount; ++r) {
+      m_riders[r]->handleAction(ACTION_BRAKE, InputManager::GetInstance()->IsHeld(ACTION_BRAKE, r));
+    }
+    return;
+  }
+  // With one rider every player's bindings drive it.
+  bool brakeHeld = false;
+  for (int p = 0; p < INPUT_MAX_PLAYERS; ++p) brakeHeld = brakeHeld || InputManager::GetInstance()->IsHeld(ACTION_BRAKE, p);
+  m_Player->handleAction(ACTION_BRAKE, brakeHeld);
+  recorder->Record(m_runStep, ACTION_BRAKE, brakeHeld);
+}
+
+bool Engine::Rewind(int back, bool fork) {
+  if (m_gameState != STATE_PLAYING || m_Player == nullptr || m_snapshots.GetCount() == 0) return false;
+  if (NetSession::GetInstance()->IsActive()) return false;
+  if (back >= m_snapshots.GetCount()) back = m_snapshots.GetCount() - 1;
+  // Dropping the newer entries leaves the target as the newest one; its
+  // slot is only reused by the next capture, after the restore.
+  const GameSnapshot* snapshot = m_snapshots.Peek(back);
+  m_snapshots.DropNewest(back);
+  SDL_Log("Rewinding from step %u to step %u%s", m_runStep, snapshot->runStep, fork ? " (fork)" : "");
+  RestoreSnapshot(*snapshot, fork);
+  return true;
+}
+
+void Engine::RestartRun() {
+  if (m_gameState != STATE_PLAYING || m_Player == nullptr) return;
+  if (NetSession::GetInstance()->IsActive()) return;
+  SDL_Log("Restarting run from step 0");
+  m_snapshots.Clear();
+  *m_snapshots.Push() = m_runStartSnapshot;
+  RestoreSnapshot(m_runStartSnapshot, false);
+}
+
+void Engine::OnCountdownSecond() {
+  if (m_remainingSeconds <= 0) return;
+  m_remainingSeconds--;
+
+  GameEvent event;
+  event.type = EVENT_SECOND_TICK;
+  event.time = Clock::GetInstance()->GetTicks(CLOCK_GAME);
+  event.secondTick.remainingSeconds = m_remainingSeconds;
+  EventQueue::GetInstance()->Push(event);
+
+  if (m_remainingSeconds == 0) {
+    SDL_Log("TIME'S UP! Entering Game Over sequence...");
+    event.type = EVENT_LOSE;
+    event.result.distance = GetLocalDistance();
+    EventQueue::GetInstance()->Push(event);
+    SetGameState(STATE_GAME_OVER);
   }
 }
 
 void Engine::SpawnObstacle() {
   if (m_obstacleTextureIds.empty() || m_laneYPositions.empty() || m_obstacleTextureWidth <= 0 || m_laneYPositions.size() < 1) return;
 
-  std::vector<int> availableLaneIndices(m_laneYPositions.size());
-  std::iota(availableLaneIndices.begin(), availableLaneIndices.end(), 0);
-  int nearThresholdX = SCREEN_WIDTH / 2;
+  int availableLaneIndices[MAX_LANES];
+  int availableCount = 0;
+  for (size_t i = 0; i < m_laneYPositions.size() && i < MAX_LANES; ++i) {
+    availableLaneIndices[availableCount++] = static_cast<int>(i);
+  }
+  float leaderDistance = m_riderDistance[0];
+  for (int r = 1; r < m_riderCount; ++r) leaderDistance = std::max(leaderDistance, m_riderDistance[r]);
+  float nearThresholdX = leaderDistance + SCREEN_WIDTH / 2;
   for (const auto& existingObstacle : m_obstacles) {
-    if (existingObstacle.isActive && existingObstacle.collider.x > nearThresholdX) {
+    if (existingObstacle.x > nearThresholdX) {
       float obsCenterY = existingObstacle.collider.y + existingObstacle.collider.h / 2.0f;
       for (size_t i = 0; i < m_laneYPositions.size(); ++i) {
         if (std::abs(obsCenterY - m_laneYPositions[i]) < (m_laneYPositions[1] - m_laneYPositions[0]) * 0.4f) {
-          availableLaneIndices.erase(std::remove(availableLaneIndices.begin(), availableLaneIndices.end(), i), availableLaneIndices.end());
+          availableCount = static_cast<int>(std::remove(availableLaneIndices, availableLaneIndices + availableCount, static_cast<int>(i)) - availableLaneIndices);
           break;
         }
       }
     }
   }
-  if (availableLaneIndices.empty()) {
+  int room = MAX_OBSTACLES - static_cast<int>(m_obstacles.size());
+  if (availableCount == 0 || room <= 0) {
     return;
   }
   std::uniform_int_distribution<int> chanceDist(1, 100);
-  bool spawnTwo = (availableLaneIndices.size() >= 2) && (chanceDist(m_rng) <= m_doubleSpawnChance);
-  int obstaclesToSpawn = spawnTwo ? 2 : 1;
+  bool spawnTwo = (availableCount >= 2) && (chanceDist(m_rng) <= m_doubleSpawnChance);
+  int obstaclesToSpawn = std::min(spawnTwo ? 2 : 1, room);
   std::uniform_int_distribution<int> textureDist(0, m_obstacleTextureIds.size() - 1);
   for (int i = 0; i < obstaclesToSpawn; ++i) {
-    if (availableLaneIndices.empty()) break;
-    std::uniform_int_distribution<int> availableLaneDist(0, availableLaneIndices.size() - 1);
+    if (availableCount == 0) break;
+    std::uniform_int_distribution<int> availableLaneDist(0, availableCount - 1);
     int chosenAvailableIndex = availableLaneDist(m_rng);
     int finalLaneIndex = availableLaneIndices[chosenAvailableIndex];
     Obstacle newObstacle;
-    newObstacle.textureId = m_obstacleTextureIds[textureDist(m_rng)];
+    newObstacle.textureIndex = textureDist(m_rng);
     newObstacle.collider.w = m_obstacleTextureWidth;
     newObstacle.collider.h = m_obstacleTextureHeight;
-    newObstacle.collider.x = SCREEN_WIDTH + 50;
+    newObstacle.x = leaderDistance + SCREEN_WIDTH + 50.0f;
+    newObstacle.collider.x = static_cast<int>(newObstacle.x);
     newObstacle.collider.y = static_cast<int>(m_laneYPositions[finalLaneIndex] - m_obstacleTextureHeight / 2.0f);
-    newObstacle.isActive = true;
     m_obstacles.push_back(newObstacle);
-    availableLaneIndices.erase(availableLaneIndices.begin() + chosenAvailableIndex);
+    std::copy(availableLaneIndices + chosenAvailableIndex + 1, availableLaneIndices + availableCount,
+              availableLaneIndices + chosenAvailableIndex);
+    availableCount--;
   }
 }
 
 void Engine::Update() {
+  ALLOC_ZONE("Update");
+  TRACE_SCOPE("Update");
+  Clock::GetInstance()->Tick();
+  AudioManager::GetInstance()->BeginFrame();
 
    if (m_isPaused) {
+     EventQueue::GetInstance()->Dispatch();
      return;
 }
-  Uint32 currentTick = SDL_GetTicks();
-  m_deltaTime = (currentTick - m_lastTick) / 1000.0f;
-  m_lastTick = currentTick;
-  if (m_deltaTime > 0.05f) m_deltaTime = 0.05f;
 
   if (m_gameState == STATE_MAIN_MENU) {
-    MainMenu::GetInstance()->Update(m_deltaTime);
-  } else if (m_gameState == STATE_PLAYING) {
-    if (m_Player) m_Player->update(m_deltaTime);
-    float playerSpeed = m_Player ? m_Player->getSpeed() : 0.0f;
-    float scrollAmount = playerSpeed * m_deltaTime;
-    m_BackgroundScrollX -= scrollAmount;
-    if (m_BackgroundScrollX <= -SCREEN_WIDTH) m_BackgroundScrollX += SCREEN_WIDTH;
-    m_totalDistanceTraveled += playerSpeed * m_deltaTime;
-    int currentDisplayedDistance = static_cast<int>(m_totalDistanceTraveled / 10.0f);
-    if (currentDisplayedDistance != m_lastDisplayedDistance) {
-      if (m_distanceTexture != nullptr) {
-        SDL_DestroyTexture(m_distanceTexture);
-        m_distanceTexture = nullptr;
-      }
-      std::stringstream ssDistance;
-      ssDistance << "Distance: " << currentDisplayedDistance << " m / 3500 m";
-      SDL_Color textColor = {255, 255, 255, 255};
-      if (m_uiFont) {
-        SDL_Surface* surface = TTF_RenderText_Solid(m_uiFont, ssDistance.str().c_str(), textColor);
-        if (surface) {
-          m_distanceTexture = SDL_CreateTextureFromSurface(m_Renderer, surface);
-          if (m_distanceTexture) {
-            SDL_QueryTexture(m_distanceTexture, NULL, NULL, &m_distanceRect.w, &m_distanceRect.h);
-          } else {
-            SDL_Log("Failed to create distance texture: %s", SDL_GetError());
-          }
-          SDL_FreeSurface(surface);
-        } else {
-          SDL_Log("Failed to create distance surface: %s", TTF_GetError());
-        }
+    MainMenu::GetInstance()->Update(Clock::GetInstance()->GetDeltaTime(CLOCK_UI));
+  }
+
+  // Spread this frame's steps over the real time since the last update so
+  // each queued input lands in the step it happened in.
+  Uint32 frameStart = m_lastUpdateTicks;
+  Uint32 frameEnd = SDL_GetTicks();
+  m_lastUpdateTicks = frameEnd;
+  if (NetSession::GetInstance()->IsActive() && UpdateNet(frameStart, frameEnd)) {
+    TraceCounters();
+    EventQueue::GetInstance()->Dispatch();
+    return;
+  }
+  Uint32 stepCount = Clock::GetInstance()->GetPendingGameSteps(SIM_STEP_MICROS);
+  for (Uint32 i = 0; Clock::GetInstance()->StepGame(SIM_STEP_MICROS); ++i) {
+    Uint32 stepEnd = frameStart + (frameEnd - frameStart) * (i + 1) / stepCount;
+    ApplyInputActions(stepEnd);
+    Step(SIM_STEP_MICROS / 1000000.0f);
+    m_runStep++;
+    if (m_gameState == STATE_PLAYING) {
+      if (m_runStep % m_snapshotInterval == 0 && !CaptureSnapshot(m_snapshots.Push())) m_snapshots.DropNewest(1);
+      GhostManager::GetInstance()->Sample(m_runStep, m_Player->GetY(), GetLocalDistance());
+    }
+    if (m_isPaused) break;
+  }
+  TraceCounters();
+  EventQueue::GetInstance()->Dispatch();
+  LatencyProbe::GetInstance()->UpdateBench();
+}
+
+void Engine::TraceCounters() {
+  if (m_gameState != STATE_PLAYING || !Tracer::GetInstance()->IsActive()) return;
+  TRACE_COUNTER("Speed", m_Player->getSpeed());
+  TRACE_COUNTER("Obstacles", static_cast<int>(m_obstacles.size()));
+}
+
+bool Engine::UpdateNet(Uint32 frameStart, Uint32 frameEnd) {
+  NetSession* net = NetSession::GetInstance();
+  net->Poll();
+  if (net->HasTimedOut()) {
+    SDL_Log("Engine::UpdateNet - Peer timed out, leaving the race.");
+    SetGameState(STATE_MAIN_MENU);
+    return false;
+  }
+  if (m_gameState == STATE_START_SCREEN) {
+    if (net->IsConnected()) {
+      ResetGameData();
+      SetGameState(STATE_PLAYING);
+    }
+    Clock::GetInstance()->DropPendingGameTime();
+    return true;
+  }
+  if (m_gameState != STATE_PLAYING) {
+    // The race is over but the peer may still be waiting for our inputs;
+    // the end screens themselves run on the regular step loop.
+    net->SendInputs();
+    return false;
+  }
+
+  if (!NetRollback()) return false;
+  Uint32 stepCount = Clock::GetInstance()->GetPendingGameSteps(SIM_STEP_MICROS);
+  for (Uint32 i = 0; m_gameState == STATE_PLAYING; ++i) {
+    if (!net->CanAdvance(m_runStep)) {
+      // Too far ahead of the peer; wait rather than predict any further.
+      net->OnStall();
+      Clock::GetInstance()->DropPendingGameTime();
+      break;
+    }
+    if (!Clock::GetInstance()->StepGame(SIM_STEP_MICROS)) break;
+    ApplyInputActions(frameStart + (frameEnd - frameStart) * (i + 1) / stepCount);
+    net->AddLocalInput(m_netLocalInput);
+    m_netLocalInput &= NET_INPUT_HELD_MASK;
+    if (!CaptureSnapshot(&m_netStates[m_runStep % NET_ROLLBACK_FRAMES])) {
+      SDL_Log("Engine::UpdateNet - Error: cannot save step %u for rollback, leaving the race.", m_runStep);
+      SetGameState(STATE_MAIN_MENU);
+      return false;
+    }
+    SimulateNetFrame();
+    net->OnFrame();
+    if (m_gameState == STATE_PLAYING) {
+      GhostManager::GetInstance()->Sample(m_runStep, m_Player->GetY(), GetLocalDistance());
+    }
+  }
+  CheckNetResimulation();
+  UpdateNetChecksum();
+  net->SendInputs();
+  return true;
+}
+
+void Engine::ApplyRiderInput(Player* rider, Uint8 input) {
+  if (input & NET_INPUT_LANE_UP) rider->handleAction(ACTION_LANE_UP, true);
+  if (input & NET_INPUT_LANE_DOWN) rider->handleAction(ACTION_LANE_DOWN, true);
+  bool brake = (input & NET_INPUT_BRAKE) != 0;
+  if (brake != rider->IsBraking()) rider->handleAction(ACTION_BRAKE, brake);
+}
+
+void Engine::SimulateNetFrame() {
+  NetSession* net = NetSession::GetInstance();
+  for (int r = 0; r < m_riderCount; ++r) {
+    Uint8 input = (r == m_localRider) ? net->GetLocalInput(m_runStep) : net->GetRemoteInput(m_runStep);
+    ApplyRiderInput(m_riders[r], input);
+  }
+  Step(SIM_STEP_MICROS / 1000000.0f);
+  m_runStep++;
+}
+
+bool Engine::NetRollback() {
+  NetSession* net = NetSession::GetInstance();
+  Uint32 frame;
+  if (!net->TakeRollbackFrame(&frame) || frame >= m_runStep) return true;
+  if (m_runStep - frame >= NET_ROLLBACK_FRAMES) {
+    SDL_Log("Engine::NetRollback - Error: step %u is no longer saved.", frame);
+    return true;
+  }
+
+  Uint64 rollbackStart = SDL_GetPerformanceCounter();
+  TRACE_SCOPE("NetRollback");
+  Uint32 targetStep = m_runStep;
+  if (!ResimulateNet(frame)) {
+    SDL_Log("Engine::NetRollback - Error: cannot save step %u for rollback, leaving the race.", m_runStep);
+    SetGameState(STATE_MAIN_MENU);
+    return false;
+  }
+
+  float resimMs = static_cast<float>((SDL_GetPerformanceCounter() - rollbackStart) * 1000.0 / SDL_GetPerformanceFrequency());
+  net->OnRollback(targetStep - frame, resimMs);
+  return true;
+}
+
+// Restores the state saved for `frame` and steps back up to the current
+// step with the inputs known now. The re-simulated steps already played
+// their sounds and counted their collisions the first time, so their
+// events are dropped and the run counters carried over.
+bool Engine::ResimulateNet(Uint32 frame) {
+  Uint32 targetStep = m_runStep;
+  Uint64 gameMicros = Clock::GetInstance()->GetMicros(CLOCK_GAME);
+  int collisionCount = m_collisionCount;
+  int laneChangeCount = m_laneChangeCount;
+  EventQueue::GetInstance()->SetSuppressedMask(EVENT_MASK(EVENT_COLLISION) | EVENT_MASK(EVENT_LANE_CHANGE) | EVENT_MASK(EVENT_SECOND_TICK));
+  RestoreSimState(m_netStates[frame % NET_ROLLBACK_FRAMES]);
+  bool saved = true;
+  while (m_runStep < targetStep && m_gameState == STATE_PLAYING) {
+    // Same order as UpdateNet: the clock steps before the state is saved.
+    Clock::GetInstance()->SetTime(CLOCK_GAME, static_cast<Uint64>(m_runStep + 1) * SIM_STEP_MICROS);
+    saved = CaptureSnapshot(&m_netStates[m_runStep % NET_ROLLBACK_FRAMES]);
+    if (!saved) break;
+    SimulateNetFrame();
+    GhostManager::GetInstance()->Sample(m_runStep, m_Player->GetY(), GetLocalDistance());
+  }
+  EventQueue::GetInstance()->SetSuppressedMask(0);
+  Clock::GetInstance()->SetTime(CLOCK_GAME, gameMicros);
+  m_collisionCount = collisionCount;
+  m_laneChangeCount = laneChangeCount;
+  return saved;
+}
+
+// --net-check-resim: every NET_CHECKSUM_INTERVAL steps, re-simulate the
+// last NET_MAX_ROLLBACK steps with unchanged input and compare each saved
+// state with the one recorded when the step first ran. Any difference
+// means a rollback would desync the peers.
+void Engine::CheckNetResimulation() {
+  if (!m_netResimCheck || m_gameState != STATE_PLAYING || m_runStep < NET_MAX_ROLLBACK) return;
+  if (m_runStep - m_netResimCheckStep < NET_CHECKSUM_INTERVAL) return;
+  m_netResimCheckStep = m_runStep;
+
+  Uint32 frame = m_runStep - NET_MAX_ROLLBACK;
+  Uint32 expected[NET_MAX_ROLLBACK];
+  for (Uint32 i = 0; i < NET_MAX_ROLLBACK; ++i) {
+    expected[i] = SnapshotChecksum(m_netStates[(frame + i) % NET_ROLLBACK_FRAMES]);
+  }
+  if (!ResimulateNet(frame)) {
+    SDL_Log("Engine::CheckNetResimulation - Error: cannot save step %u.", m_runStep);
+    m_netResimMismatches++;
+    return;
+  }
+  for (Uint32 i = 0; i < NET_MAX_ROLLBACK; ++i) {
+    Uint32 actual = SnapshotChecksum(m_netStates[(frame + i) % NET_ROLLBACK_FRAMES]);
+    if (actual != expected[i]) {
+      SDL_Log("Engine::CheckNetResimulation - Error: step %u re-simulated to %08x, first run saved %08x.",
+              frame + i, actual, expected[i]);
+      m_netResimMismatches++;
+    }
+  }
+}
+
+void Engine::UpdateNetChecksum() {
+  // Only steps both peers have simulated with confirmed input are compared.
+  NetSession* net = NetSession::GetInstance();
+  Uint32 confirmed = std::min(net->GetConfirmedFrameCount(), m_runStep);
+  Uint32 frame = (confirmed / NET_CHECKSUM_INTERVAL) * NET_CHECKSUM_INTERVAL;
+  if (frame <= m_netChecksumFrame || frame >= m_runStep || m_runStep - frame >= NET_ROLLBACK_FRAMES) return;
+  m_netChecksumFrame = frame;
+  net->SetLocalChecksum(frame, SnapshotChecksum(m_netStates[frame % NET_ROLLBACK_FRAMES]));
+}
+
+void Engine::ApplyInputActions(Uint32 upToTimestamp) {
+  InputRecorder* recorder = InputRecorder::GetInstance();
+  InputActionEvent input;
+  while (InputManager::GetInstance()->PopActionUntil(upToTimestamp, &input)) {
+    if (m_gameState != STATE_PLAYING || m_Player == nullptr) continue;
+    if (NetSession::GetInstance()->IsActive()) {
+      // Net races send input bits instead; the rider applies them in the step.
+      if (input.action == ACTION_LANE_UP && input.pressed) m_netLocalInput |= NET_INPUT_LANE_UP;
+      if (input.action == ACTION_LANE_DOWN && input.pressed) m_netLocalInput |= NET_INPUT_LANE_DOWN;
+      if (input.action == ACTION_BRAKE) {
+        m_netLocalInput = input.pressed ? (m_netLocalInput | NET_INPUT_BRAKE) : (m_netLocalInput & ~NET_INPUT_BRAKE);
       }
-      m_lastDisplayedDistance = currentDisplayedDistance;
+      InputManager::GetInstance()->MarkApplied(input);
+      continue;
     }
-    if (currentTick - m_lastDifficultyIncreaseTime >= m_difficultyIncreaseInterval) {
-      m_obstacleSpawnInterval -= m_spawnIntervalReduction;
-      if (m_obstacleSpawnInterval < m_minSpawnInterval) m_obstacleSpawnInterval = m_minSpawnInterval;
-      m_lastDifficultyIncreaseTime = currentTick;
-      SDL_Log("Spawn Rate Increased! New interval: %.2f", m_obstacleSpawnInterval);
+    if (m_splitScreen) {
+      // Recordings hold one rider's input; split screen runs are not recorded.
+      m_riders[input.player]->handleAction(input.action, input.pressed);
+      InputManager::GetInstance()->MarkApplied(input);
+      LatencyProbe::GetInstance()->OnInputApplied(input);
+      continue;
     }
-    if (currentTick - m_lastMaxSpeedIncreaseTime >= m_maxSpeedIncreaseInterval) {
-      if (m_Player) m_Player->IncreaseMaxSpeed(m_maxSpeedIncreaseAmount, m_absoluteMaxPlayerSpeed);
-      m_lastMaxSpeedIncreaseTime = currentTick;
+    if (recorder->IsReplaying()) {
+      // Taking the controls during a replay forks the run at this step.
+      recorder->Fork(m_runStep);
+    }
+    m_Player->handleAction(input.action, input.pressed);
+    recorder->Record(m_runStep, input.action, input.pressed);
+    InputManager::GetInstance()->MarkApplied(input);
+    LatencyProbe::GetInstance()->OnInputApplied(input);
+  }
+
+  if (m_gameState != STATE_PLAYING || m_Player == nullptr || NetSession::GetInstance()->IsActive() || m_splitScreen) return;
+  InputAction action;
+  bool pressed;
+  while (recorder->PopReplayAction(m_runStep, &action, &pressed)) {
+    m_Player->handleAction(action, pressed);
+  }
+}
+
+void Engine::Step(float deltaTime) {
+  ALLOC_ZONE("Step");
+  TRACE_SCOPE("SimStep");
+  MetricTimer stepTimer(METRIC_SIM_STEP);
+  m_deltaTime = deltaTime;
+  m_gameTimers.Advance(Clock::GetInstance()->GetTicks(CLOCK_GAME));
+
+  if (m_gameState == STATE_PLAYING) {
+    for (int r = 0; r < m_riderCount; ++r) {
+      m_riders[r]->update(m_deltaTime);
+      m_riderDistance[r] += m_riders[r]->getSpeed() * m_deltaTime;
     }
     m_timeSinceLastSpawn += m_deltaTime;
 
     if (m_timeSinceLastSpawn >= m_obstacleSpawnInterval) {
-      int activeObstacles = 0;
-      for (const auto& obs : m_obstacles) {
-        if (obs.isActive) activeObstacles++;
-          }
-
-      if (activeObstacles < MAX_ACTIVE_OBSTACLES) {
+      if (static_cast<int>(m_obstacles.size()) < MAX_ACTIVE_OBSTACLES) {
           SpawnObstacle();
           m_timeSinceLastSpawn = 0.0f;
   }
 }
 
-    SDL_Rect playerFullCollider = m_Player->GetCollider();
+    float trailingDistance = m_riderDistance[0];
+    for (int r = 1; r < m_riderCount; ++r) trailingDistance = std::min(trailingDistance, m_riderDistance[r]);
     for (auto it = m_obstacles.begin(); it != m_obstacles.end();) {
-      if (!it->isActive) {
-        it++;
-        continue;
-      }
-      it->collider.x -= static_cast<int>(scrollAmount);
-      SDL_Rect obstacleFullCollider = it->collider;
-      float reductionFactor = 0.6f;
-      SDL_Rect playerCollisionBox;
-      playerCollisionBox.w = static_cast<int>(playerFullCollider.w * reductionFactor);
-      playerCollisionBox.h = static_cast<int>(playerFullCollider.h * reductionFactor);
-      playerCollisionBox.x = playerFullCollider.x + (playerFullCollider.w - playerCollisionBox.w) / 2;
-      playerCollisionBox.y = playerFullCollider.y + (playerFullCollider.h - playerCollisionBox.h) / 2;
-      SDL_Rect obstacleCollisionBox;
-      obstacleCollisionBox.w = static_cast<int>(obstacleFullCollider.w * reductionFactor);
-      obstacleCollisionBox.h = static_cast<int>(obstacleFullCollider.h * reductionFactor);
-      obstacleCollisionBox.x = obstacleFullCollider.x + (obstacleFullCollider.w - obstacleCollisionBox.w) / 2;
-      obstacleCollisionBox.y = obstacleFullCollider.y + (obstacleFullCollider.h - obstacleCollisionBox.h) / 2;
-      if (SDL_HasIntersection(&playerCollisionBox, &obstacleCollisionBox)) {
-        SDL_Log("Collision detected!");
-        AudioManager::GetInstance()->PlaySound("crash", 0);
-        m_Player->ApplySpeedPenalty();
-        it->isActive = false;
+      // Obstacles sit at a course distance; each rider sees them shifted by
+      // how far they have ridden, and hits them independently.
+      for (int r = 0; r < m_riderCount; ++r) {
+        if (it->hitMask & (1 << r)) continue;
+        SDL_Rect playerFullCollider = m_riders[r]->GetCollider();
+        SDL_Rect obstacleFullCollider = it->collider;
+        obstacleFullCollider.x = static_cast<int>(it->x - m_riderDistance[r]);
+        float reductionFactor = 0.6f;
+        SDL_Rect playerCollisionBox;
+        playerCollisionBox.w = static_cast<int>(playerFullCollider.w * reductionFactor);
+        playerCollisionBox.h = static_cast<int>(playerFullCollider.h * reductionFactor);
+        playerCollisionBox.x = playerFullCollider.x + (playerFullCollider.w - playerCollisionBox.w) / 2;
+        playerCollisionBox.y = playerFullCollider.y + (playerFullCollider.h - playerCollisionBox.h) / 2;
+        SDL_Rect obstacleCollisionBox;
+        obstacleCollisionBox.w = static_cast<int>(obstacleFullCollider.w * reductionFactor);
+        obstacleCollisionBox.h = static_cast<int>(obstacleFullCollider.h * reductionFactor);
+        obstacleCollisionBox.x = obstacleFullCollider.x + (obstacleFullCollider.w - obstacleCollisionBox.w) / 2;
+        obstacleCollisionBox.y = obstacleFullCollider.y + (obstacleFullCollider.h - obstacleCollisionBox.h) / 2;
+        if (SDL_HasIntersection(&playerCollisionBox, &obstacleCollisionBox)) {
+          // A shared screen plays and counts every rider's crashes.
+          if (m_splitScreen || r == m_localRider) {
+            GameEvent event;
+            event.type = EVENT_COLLISION;
+            event.time = Clock::GetInstance()->GetTicks(CLOCK_GAME);
+            event.collision.x = obstacleFullCollider.x;
+            event.collision.y = obstacleFullCollider.y;
+            EventQueue::GetInstance()->Push(event);
+          }
+          m_riders[r]->ApplySpeedPenalty();
+          it->hitMask |= 1 << r;
+        }
       }
-      if (it->collider.x + it->collider.w < 0) {
+      bool hitByAll = it->hitMask == (1 << m_riderCount) - 1;
+      if (hitByAll || it->x + it->collider.w - trailingDistance < 0) {
         it = m_obstacles.erase(it);
       } else {
         ++it;
       }
     }
-    Uint32 currentTime = SDL_GetTicks();
-    if (currentTime - m_lastSecondUpdate >= 1000 && m_remainingSeconds > 0) {
-      m_remainingSeconds--;
-      m_lastSecondUpdate = currentTime;
-      if (m_remainingSeconds <= 10 && m_remainingSeconds > 0) {
-        if (m_lastCountdownSecondPlayed != m_remainingSeconds) {
-          AudioManager::GetInstance()->PlaySound("countdown", 0);
-          m_lastCountdownSecondPlayed = m_remainingSeconds;
-        }
-      }
-      if (m_remainingSeconds == 0) {
-        SDL_Log("TIME'S UP! Entering Game Over sequence...");
-        m_gameOverStartTime = SDL_GetTicks();
-        m_showGameOverScreen = false;
-        SetGameState(STATE_GAME_OVER);
-      }
-    }
-    if (m_totalDistanceTraveled >= WIN_DISTANCE) {
-      SDL_Log("WIN CONDITION MET! Distance: %.2f", m_totalDistanceTraveled);
-      SetGameState(STATE_WIN);
+    for (int r = 0; r < m_riderCount; ++r) {
+      if (m_riderDistance[r] < WIN_DISTANCE) continue;
+      // On a shared screen whoever finishes first wins the race for both.
+      bool localWin = m_splitScreen || r == m_localRider;
+      SDL_Log("%s Rider %d, distance: %.2f", localWin ? "WIN CONDITION MET!" : "RIVAL FINISHED FIRST!", r + 1, m_riderDistance[r]);
+      GameEvent event;
+      event.type = localWin ? EVENT_WIN : EVENT_LOSE;
+      event.time = Clock::GetInstance()->GetTicks(CLOCK_GAME);
+      event.result.distance = GetLocalDistance();
+      EventQueue::GetInstance()->Push(event);
+      SetGameState(localWin ? STATE_WIN : STATE_GAME_OVER);
+      break;
     }
   }
+}
 
-   else if (m_gameState == STATE_GAME_OVER) {
-    if (!m_showGameOverScreen) {
-      Uint32 currentTime = SDL_GetTicks();
-      if (currentTime - m_gameOverStartTime >= 2000) {
-        SDL_Log("Game Over delay finished. Displaying Game Over screen.");
-        m_showGameOverScreen = true;
-      }
+void Engine::Render() {
+  ALLOC_ZONE("Render");
+  TRACE_SCOPE("Render");
+  if (!AlwaysRender()) {
+    if (m_gameState == STATE_MAIN_MENU && !m_needsPresent && MainMenu::GetInstance()->IsIdle()) return;
+    if (m_gameState != STATE_MAIN_MENU && IsStaticScene() && !m_needsPresent &&
+        (!m_isPaused || PauseMenu::GetInstance()->IsIdle())) return;
+  }
+  // Skipped frames above are not render samples.
+  MetricTimer renderTimer(METRIC_RENDER);
+  FrameCapture::GetInstance()->BeginFrame(m_Renderer);
+
+  if (m_gameState == STATE_MAIN_MENU) {
+    MainMenu::GetInstance()->Render();
+    m_needsPresent = false;
+    PresentFrame();
+    return;
+  }
+
+  if (IsStaticScene()) {
+    if (!m_sceneCache.IsValid() && m_sceneCache.Begin(m_Renderer, SCREEN_WIDTH, SCREEN_HEIGHT)) {
+      DrawScene();
+      DrawHud();
+      m_sceneCache.End(m_Renderer);
     }
-    if (!m_showReturnPrompt && SDL_GetTicks() - m_endScreenStartTime >= RETURN_PROMPT_DELAY) {
-      m_showReturnPrompt = true;
+    if (m_sceneCache.IsValid()) {
+      m_sceneCache.Draw(m_Renderer);
+    } else {
+      DrawScene();
+      DrawHud();
     }
-  } else if (m_gameState == STATE_WIN) {
-    if (!m_showReturnPrompt && SDL_GetTicks() - m_endScreenStartTime >= RETURN_PROMPT_DELAY) {
-      m_showReturnPrompt = true;
+    if (m_isPaused) {
+      PauseMenu::GetInstance()->Render();
     }
-  }
-}
-void Engine::Render() {
-  if (m_isPaused) {
-    RenderPauseMenu();
-    SDL_RenderPresent(m_Renderer);
+    m_needsPresent = false;
+    PresentFrame();
     return;
+  }
+
+  Uint64 renderStart = SDL_GetPerformanceCounter();
+  m_resolutionScaler.Begin(m_Renderer);
+  DrawScene();
+  m_resolutionScaler.End(m_Renderer);
+  DrawHud();
+
+  // With vsync, present blocks until the flip and says nothing about fill
+  // cost, so only the submission is timed.
+  bool vsync = FramePacer::GetInstance()->HasVsync();
+  Uint64 renderEnd = SDL_GetPerformanceCounter();
+  m_needsPresent = false;
+  PresentFrame();
+  if (!vsync) renderEnd = SDL_GetPerformanceCounter();
+  float renderCostMs = static_cast<float>((renderEnd - renderStart) * 1000.0 / SDL_GetPerformanceFrequency());
+  m_resolutionScaler.Update(renderCostMs, FramePacer::GetInstance()->GetFrameBudgetMs());
 }
 
+void Engine::DrawScene() {
   switch (m_gameState) {
-    case STATE_MAIN_MENU: {
-      MainMenu::GetInstance()->Render();
-      SDL_RenderPresent(m_Renderer);
-      return;
-    }
-
     case STATE_GAME_OVER: {
       if (m_showGameOverScreen) {
         SDL_SetRenderDrawColor(m_Renderer, 0, 0, 0, 255);
@@ -674,23 +1177,15 @@ void Engine::Render() {
           int imgY = (SCREEN_HEIGHT - imgH) / 2;
           TextureManager::GetInstance()->Draw("gameover", imgX, imgY, imgW, imgH);
         } else {
-          SDL_Log("Warning: Could not find 'gameover' texture to render.");
+          LOG_WARN("Could not find 'gameover' texture to render.");
         }
         if (m_showReturnPrompt && m_returnPromptTexture) {
-          SDL_RenderCopy(m_Renderer, m_returnPromptTexture, NULL, &m_returnPromptRect);
+          RenderStats::GetInstance()->Copy(m_Renderer, m_returnPromptTexture, NULL, &m_returnPromptRect);
         }
       } else {
         SDL_SetRenderDrawColor(m_Renderer, 100, 150, 200, 255);
         SDL_RenderClear(m_Renderer);
-        int bgScrollInt = static_cast<int>(m_BackgroundScrollX);
-        TextureManager::GetInstance()->Draw("background", bgScrollInt, 0, SCREEN_WIDTH, 400);
-        TextureManager::GetInstance()->Draw("background", bgScrollInt + SCREEN_WIDTH, 0, SCREEN_WIDTH, 400);
-        TextureManager::GetInstance()->Draw("track", 0, static_cast<int>(TRACK_Y_POSITION), SCREEN_WIDTH, static_cast<int>(TRACK_HEIGHT));
-        if (m_Player) m_Player->draw();
-        for (const auto& obs : m_obstacles) {
-          if (obs.isActive)
-            TextureManager::GetInstance()->Draw(obs.textureId, obs.collider.x, obs.collider.y, obs.collider.w, obs.collider.h);
-        }
+        DrawViews();
         if (TextureManager::GetInstance()->QueryTexture("end", nullptr, nullptr))
           TextureManager::GetInstance()->Draw("end", m_timerRect.x, m_timerRect.y, m_timerRect.w, m_timerRect.h);
         else if (TextureManager::GetInstance()->QueryTexture("00", nullptr, nullptr))
@@ -708,10 +1203,10 @@ void Engine::Render() {
         int imgY = (SCREEN_HEIGHT - imgH) / 2;
         TextureManager::GetInstance()->Draw("win", imgX, imgY, imgW, imgH);
       } else {
-        SDL_Log("Warning: Could not find 'win' texture to render.");
+        LOG_WARN("Could not find 'win' texture to render.");
       }
       if (m_showReturnPrompt && m_returnPromptTexture) {
-        SDL_RenderCopy(m_Renderer, m_returnPromptTexture, NULL, &m_returnPromptRect);
+        RenderStats::GetInstance()->Copy(m_Renderer, m_returnPromptTexture, NULL, &m_returnPromptRect);
       }
       break;
     }
@@ -729,41 +1224,7 @@ void Engine::Render() {
     case STATE_PLAYING: {
       SDL_SetRenderDrawColor(m_Renderer, 100, 150, 200, 255);
       SDL_RenderClear(m_Renderer);
-      int bgScrollInt = static_cast<int>(m_BackgroundScrollX);
-      TextureManager::GetInstance()->Draw("background", bgScrollInt, 0, SCREEN_WIDTH, 400);
-      TextureManager::GetInstance()->Draw("background", bgScrollInt + SCREEN_WIDTH, 0, SCREEN_WIDTH, 400);
-      TextureManager::GetInstance()->Draw("track", 0, static_cast<int>(TRACK_Y_POSITION), SCREEN_WIDTH, static_cast<int>(TRACK_HEIGHT));
-
-      if (m_gameState == STATE_PLAYING) {
-        for (const auto& obs : m_obstacles) {
-          if (obs.isActive)
-            TextureManager::GetInstance()->Draw(obs.textureId, obs.collider.x, obs.collider.y, obs.collider.w, obs.collider.h);
-        }
-      }
-
-      if (m_Player) m_Player->draw();
-
-      if (m_gameState == STATE_START_SCREEN) {
-        if (TextureManager::GetInstance()->QueryTexture("start", nullptr, nullptr))
-          TextureManager::GetInstance()->Draw("start", m_timerRect.x, m_timerRect.y, m_timerRect.w, m_timerRect.h);
-      }
-
-      if (m_gameState == STATE_PLAYING) {
-        std::string currentTimerTextureId = "end";
-        if (m_remainingSeconds > 0 && m_remainingSeconds <= 60) {
-          std::ostringstream ss;
-          ss << std::setw(2) << std::setfill('0') << m_remainingSeconds;
-          currentTimerTextureId = ss.str();
-        }
-        if (TextureManager::GetInstance()->QueryTexture(currentTimerTextureId, nullptr, nullptr)) {
-          TextureManager::GetInstance()->Draw(currentTimerTextureId, m_timerRect.x, m_timerRect.y, m_timerRect.w, m_timerRect.h);
-        }
-      }
-
-      if (m_distanceTexture != nullptr && (m_gameState == STATE_PLAYING || m_gameState == STATE_START_SCREEN)) {
-        SDL_RenderCopy(m_Renderer, m_distanceTexture, NULL, &m_distanceRect);
-      }
-
+      DrawViews();
       break;
     }
 
@@ -773,122 +1234,356 @@ void Engine::Render() {
       break;
     }
   }
+}
+
+float Engine::GetBackgroundScroll(int rider) const {
+  return -std::fmod(m_riderDistance[rider], static_cast<float>(SCREEN_WIDTH));
+}
+
+// Split screen shows the lower half of each rider's world (the track and the
+// bottom of the sky) in its own half of the screen. Both views draw from the
+// same textures and obstacle list; only the offset and clip change.
+void Engine::DrawViews() {
+  if (!m_splitScreen) {
+    DrawWorld(m_localRider);
+    return;
+  }
+  for (int view = 0; view < m_riderCount; ++view) {
+    SDL_Rect clip = {0, view * SPLIT_VIEW_HEIGHT, SCREEN_WIDTH, SPLIT_VIEW_HEIGHT};
+    SDL_RenderSetClipRect(m_Renderer, &clip);
+    TextureManager::GetInstance()->SetDrawOffset(0, view * SPLIT_VIEW_HEIGHT - (SCREEN_HEIGHT - SPLIT_VIEW_HEIGHT));
+    DrawWorld(view);
+  }
+  TextureManager::GetInstance()->SetDrawOffset(0, 0);
+  SDL_RenderSetClipRect(m_Renderer, NULL);
+  SDL_Rect divider = {0, SPLIT_VIEW_HEIGHT - 1, SCREEN_WIDTH, 2};
+  SDL_SetRenderDrawColor(m_Renderer, 0, 0, 0, 255);
+  SDL_RenderFillRect(m_Renderer, &divider);
+}
+
+void Engine::DrawWorld(int viewer) {
+  int bgScrollInt = static_cast<int>(GetBackgroundScroll(viewer));
+  TextureManager::GetInstance()->Draw("background", bgScrollInt, 0, SCREEN_WIDTH, 400);
+  TextureManager::GetInstance()->Draw("background", bgScrollInt + SCREEN_WIDTH, 0, SCREEN_WIDTH, 400);
+  TextureManager::GetInstance()->Draw("track", 0, static_cast<int>(TRACK_Y_POSITION), SCREEN_WIDTH, static_cast<int>(TRACK_HEIGHT));
+
+  if (m_gameState != STATE_START_SCREEN) {
+    for (const auto& obs : m_obstacles) {
+      if (obs.hitMask & (1 << viewer)) continue;
+      int x = static_cast<int>(obs.x - m_riderDistance[viewer]);
+      if (x + obs.collider.w < 0 || x >= SCREEN_WIDTH) continue;
+      TextureManager::GetInstance()->Draw(m_obstacleTextureIds[obs.textureIndex], x, obs.collider.y, obs.collider.w, obs.collider.h);
+    }
+    if (m_gameState == STATE_PLAYING) {
+      GhostManager::GetInstance()->Draw(m_riders[viewer], m_runStep, PLAYER_START_X, m_riderDistance[viewer]);
+    }
+    DrawRivals(viewer);
+  }
+  if (m_riders[viewer]) m_riders[viewer]->draw();
+}
+
+void Engine::DrawRivals(int viewer) {
+  if (m_riderCount < 2 || m_riders[viewer] == nullptr) return;
+  SDL_Point centers[MAX_RIDERS];
+  int count = 0;
+  for (int r = 0; r < m_riderCount; ++r) {
+    if (r == viewer) continue;
+    centers[count].x = static_cast<int>(PLAYER_START_X + m_riderDistance[r] - m_riderDistance[viewer]);
+    centers[count].y = static_cast<int>(m_riders[r]->GetY());
+    count++;
+  }
+  m_riders[viewer]->drawGhosts(centers, count, RIVAL_ALPHA);
+}
+
+void Engine::DrawHud() {
+  if (m_gameState != STATE_START_SCREEN && m_gameState != STATE_PLAYING) return;
+
+  if (m_gameState == STATE_START_SCREEN) {
+    if (TextureManager::GetInstance()->QueryTexture("start", nullptr, nullptr))
+      TextureManager::GetInstance()->Draw("start", m_timerRect.x, m_timerRect.y, m_timerRect.w, m_timerRect.h);
+  }
+
+  if (m_gameState == STATE_PLAYING) {
+    // m_timerTextures holds "start", "00".."60", "end".
+    const std::string& currentTimerTextureId = (m_remainingSeconds > 0 && m_remainingSeconds <= 60)
+        ? m_timerTextures[1 + m_remainingSeconds] : m_timerTextures.back();
+    if (TextureManager::GetInstance()->QueryTexture(currentTimerTextureId, nullptr, nullptr)) {
+      TextureManager::GetInstance()->Draw(currentTimerTextureId, m_timerRect.x, m_timerRect.y, m_timerRect.w, m_timerRect.h);
+    }
+  }
+
+  for (int view = 0; view < GetViewCount(); ++view) {
+    DrawDistance(view);
+  }
+}
 
-  SDL_RenderPresent(m_Renderer);
+// The distance readout changes almost every frame. Rather than rendering a
+// new surface and texture each time, the fixed parts and a strip of digits
+// are rendered once; the HUD font is monospaced, so digit n is simply the
+// n-th tenth of the strip.
+void Engine::CreateHudText() {
+  static const char* texts[HUD_TEXT_COUNT] = { "Distance: ", "0123456789", " m / 3500 m" };
+  SDL_Color textColor = {255, 255, 255, 255};
+  for (int i = 0; i < HUD_TEXT_COUNT; ++i) {
+    m_hudText[i] = nullptr;
+    m_hudTextSize[i].x = m_hudTextSize[i].y = 0;
+    SDL_Surface* surface = RenderStats::GetInstance()->RenderText(m_uiFont, texts[i], textColor);
+    if (surface == nullptr) {
+      SDL_Log("Failed to create HUD text surface: %s", TTF_GetError());
+      continue;
+    }
+    m_hudText[i] = RenderStats::GetInstance()->CreateTextureFromSurface(m_Renderer, surface);
+    if (m_hudText[i]) {
+      m_hudTextSize[i].x = surface->w;
+      m_hudTextSize[i].y = surface->h;
+    } else {
+      SDL_Log("Failed to create HUD text texture: %s", SDL_GetError());
+    }
+    SDL_FreeSurface(surface);
+  }
+}
+
+void Engine::ReleaseHudText() {
+  for (int i = 0; i < HUD_TEXT_COUNT; ++i) {
+    if (m_hudText[i] != nullptr) {
+      SDL_DestroyTexture(m_hudText[i]);
+      m_hudText[i] = nullptr;
+    }
+  }
+}
+
+void Engine::DrawDistance(int view) {
+  for (int i = 0; i < HUD_TEXT_COUNT; ++i) {
+    if (m_hudText[i] == nullptr) return;
+  }
+  char digits[16];
+  int length = SDL_snprintf(digits, sizeof(digits), "%d", static_cast<int>(m_riderDistance[GetViewRider(view)] / 10.0f));
+  SDL_Rect dst = {HUD_DISTANCE_X, HUD_DISTANCE_Y + view * SPLIT_VIEW_HEIGHT, m_hudTextSize[HUD_TEXT_LABEL].x, m_hudTextSize[HUD_TEXT_LABEL].y};
+  RenderStats::GetInstance()->Copy(m_Renderer, m_hudText[HUD_TEXT_LABEL], NULL, &dst);
+  dst.x += dst.w;
+
+  int digitWidth = m_hudTextSize[HUD_TEXT_DIGITS].x / 10;
+  SDL_Rect src = {0, 0, digitWidth, m_hudTextSize[HUD_TEXT_DIGITS].y};
+  dst.w = digitWidth;
+  dst.h = src.h;
+  for (int i = 0; i < length; ++i) {
+    src.x = (digits[i] - '0') * digitWidth;
+    RenderStats::GetInstance()->Copy(m_Renderer, m_hudText[HUD_TEXT_DIGITS], &src, &dst);
+    dst.x += digitWidth;
+  }
+
+  dst.w = m_hudTextSize[HUD_TEXT_UNITS].x;
+  dst.h = m_hudTextSize[HUD_TEXT_UNITS].y;
+  RenderStats::GetInstance()->Copy(m_Renderer, m_hudText[HUD_TEXT_UNITS], NULL, &dst);
+}
+
+bool Engine::AlwaysRender() const {
+  return m_headless || FrameCapture::GetInstance()->IsEnabled();
+}
+
+bool Engine::IsStaticScene() const {
+  if (m_isPaused) return true;
+  switch (m_gameState) {
+    case STATE_START_SCREEN:
+    case STATE_GAME_OVER:
+    case STATE_WIN:
+    case STATE_ABOUT:
+      return true;
+    default:
+      return false;
+  }
+}
+
+void Engine::InvalidateScene() {
+  m_sceneCache.Invalidate();
+  m_needsPresent = true;
+}
+
+int Engine::GetIdleWaitMs() const {
+  if (AlwaysRender() || LatencyProbe::GetInstance()->IsBenchRunning()) return 0;
+  if (m_gameState == STATE_PLAYING && !m_isPaused) return 0;
+  // Keep polling the socket while waiting for the peer or for a late input.
+  if (NetSession::GetInstance()->IsActive()) return IDLE_TIMER_WAIT_MS;
+  if (m_windowMinimized || !m_windowFocused) return IDLE_BACKGROUND_WAIT_MS;
+  if (m_needsPresent) return 0;
+
+  bool idle = false;
+  if (m_gameState == STATE_MAIN_MENU) {
+    idle = MainMenu::GetInstance()->IsIdle();
+  } else if (IsStaticScene()) {
+    idle = !m_isPaused || PauseMenu::GetInstance()->IsIdle();
+  }
+  if (!idle) return 0;
+  // Pending game timers (game over screen, return prompt) still need to fire
+  // close to on time; otherwise only the audio bookkeeping needs a wake-up.
+  return m_gameTimers.GetActiveCount() > 0 ? IDLE_TIMER_WAIT_MS : IDLE_WAIT_MS;
+}
+
+void Engine::HandleWindowEvent(const SDL_WindowEvent& window) {
+  switch (window.event) {
+    case SDL_WINDOWEVENT_FOCUS_LOST:
+    case SDL_WINDOWEVENT_MINIMIZED:
+      if (window.event == SDL_WINDOWEVENT_MINIMIZED) {
+        m_windowMinimized = true;
+      } else {
+        m_windowFocused = false;
+      }
+      if (m_gameState == STATE_PLAYING && !m_isPaused && !LatencyProbe::GetInstance()->IsBenchRunning()) {
+        SetPaused(true);
+      }
+      break;
+    case SDL_WINDOWEVENT_FOCUS_GAINED:
+      m_windowFocused = true;
+      break;
+    case SDL_WINDOWEVENT_RESTORED:
+    case SDL_WINDOWEVENT_MAXIMIZED:
+      m_windowMinimized = false;
+      m_needsPresent = true;
+      break;
+    case SDL_WINDOWEVENT_EXPOSED:
+    case SDL_WINDOWEVENT_SIZE_CHANGED:
+      m_needsPresent = true;
+      break;
+    default:
+      break;
+  }
+}
+
+void Engine::PresentFrame() {
+  RenderStats::GetInstance()->DrawOverlay(m_Renderer, m_uiFont);
+  FrameCapture::GetInstance()->EndFrame(m_Renderer);
+  LatencyProbe::GetInstance()->OnFrameRecorded();
+  {
+    TRACE_SCOPE("Present");
+    MetricTimer presentTimer(METRIC_PRESENT);
+    SDL_RenderPresent(m_Renderer);
+  }
+  RenderStats::GetInstance()->EndFrame();
+  InputManager::GetInstance()->OnFramePresented(SDL_GetTicks());
+  LatencyProbe::GetInstance()->OnFramePresented();
 }
 
 void Engine::Events() {
+  ALLOC_ZONE("Events");
+  TRACE_SCOPE("Events");
   SDL_Event event;
-  while (SDL_PollEvent(&event)) {
+  int waitMs = GetIdleWaitMs();
+  bool hasEvent;
+  if (waitMs > 0) {
+    {
+      TRACE_SCOPE("IdleWait");
+      hasEvent = SDL_WaitEventTimeout(&event, waitMs) != 0;
+    }
+    Tracer::GetInstance()->ExcludeIdleWait();
+    FramePacer::GetInstance()->Resync();
+  } else {
+    hasEvent = SDL_PollEvent(&event) != 0;
+  }
+  for (; hasEvent; hasEvent = SDL_PollEvent(&event) != 0) {
     if (event.type == SDL_QUIT) {
       Quit();
       return;
     }
+    if (event.type == SDL_WINDOWEVENT) {
+      HandleWindowEvent(event.window);
+      continue;
+    }
+    if (event.type == SDL_KEYDOWN && event.key.keysym.scancode == TRACE_TOGGLE_KEY && event.key.repeat == 0) {
+      Tracer::GetInstance()->Toggle();
+      continue;
+    }
+    if (event.type == SDL_KEYDOWN && event.key.keysym.scancode == RENDER_STATS_TOGGLE_KEY && event.key.repeat == 0) {
+      RenderStats::GetInstance()->ToggleOverlay();
+      m_needsPresent = true;
+      continue;
+    }
+    if (event.type == SDL_RENDER_TARGETS_RESET || event.type == SDL_RENDER_DEVICE_RESET) {
+      if (event.type == SDL_RENDER_DEVICE_RESET) {
+        m_sceneCache.Release();
+        m_resolutionScaler.Release();
+        RenderStats::GetInstance()->ReleaseOverlay();
+      }
+      InvalidateScene();
+      MainMenu::GetInstance()->HandleEvent(event);
+      PauseMenu::GetInstance()->HandleEvent(event);
+      continue;
+    }
+    if (event.type == SDL_AUDIODEVICEADDED || event.type == SDL_AUDIODEVICEREMOVED) {
+      AudioManager::GetInstance()->HandleDeviceEvent(event);
+      continue;
+    }
+    InputActionEvent input;
+    bool hasAction = InputManager::GetInstance()->HandleEvent(event, &input);
     switch (m_gameState) {
       case STATE_MAIN_MENU:
         MainMenu::GetInstance()->HandleEvent(event);
         break;
       case STATE_START_SCREEN:
-        if (event.type == SDL_KEYDOWN && event.key.keysym.sym == SDLK_RIGHT) {
-          SDL_Log("RIGHT ARROW pressed! Changing state to PLAYING.");
-          m_lastSecondUpdate = SDL_GetTicks();
-          m_remainingSeconds = 60;
-          m_gameOverStartTime = 0;
-          m_showGameOverScreen = false;
-          m_obstacles.clear();
-          m_timeSinceLastSpawn = 1.0f;
-          m_obstacleSpawnInterval = 2.3f;
-          m_lastDifficultyIncreaseTime = SDL_GetTicks();
-          m_lastMaxSpeedIncreaseTime = SDL_GetTicks();
-          m_totalDistanceTraveled = 0.0f;
-          m_lastDisplayedDistance = -1;
-          if (m_distanceTexture) {
-            SDL_DestroyTexture(m_distanceTexture);
-            m_distanceTexture = nullptr;
-          }
-          if (m_Player) {
-            m_Player->reset(150.0f, m_laneYPositions);
-          }
+        if (hasAction && input.pressed && input.action == ACTION_BACK && NetSession::GetInstance()->IsActive()) {
+          SetGameState(STATE_MAIN_MENU);
+        } else if (hasAction && input.pressed && input.action == ACTION_START && !NetSession::GetInstance()->IsActive()) {
+          SDL_Log("START pressed! Changing state to PLAYING.");
+          ResetGameData();
           SetGameState(STATE_PLAYING);
         }
         break;
       case STATE_PLAYING:
-        if (event.type == SDL_KEYDOWN && event.key.repeat == 0) {
-
-           if (event.key.keysym.sym == SDLK_p || event.key.keysym.sym == SDLK_ESCAPE) {
-             m_isPaused = !m_isPaused;
-             if (m_isPaused) {
-                AudioManager::GetInstance()->PauseMusic();
-    }        else {
-                AudioManager::GetInstance()->ResumeMusic();
-    }
+        if (m_isPaused) {
+          PauseMenu::GetInstance()->HandleEvent(event);
         }
-
-
-             if (m_isPaused) {
-               if (event.key.keysym.sym == SDLK_UP) {
-                  m_menuOption = 0;
-            }  else if (event.key.keysym.sym == SDLK_DOWN) {
-                  m_menuOption = 1;
-            }  else if (event.key.keysym.sym == SDLK_RETURN) {
-                  if (m_menuOption == 0) {
-                      m_isPaused = false;
-                } else if (m_menuOption == 1) {
-                      ResetGameData();
-                      m_isPaused = false;
-                }
-            }
-        }    else {
-
-               if (m_Player) {
-                  m_Player->handleEvent(event);
-            }
+        if (!hasAction) break;
+        if (input.pressed && input.action == ACTION_BACK && NetSession::GetInstance()->IsActive()) {
+          SetGameState(STATE_MAIN_MENU);
+        } else if (input.pressed && (input.action == ACTION_PAUSE || input.action == ACTION_BACK)) {
+          SetPaused(!m_isPaused);
+        } else if (m_isPaused) {
+          PauseMenu::GetInstance()->HandleAction(input);
+        } else if (input.pressed && input.action == ACTION_REWIND) {
+          Rewind(REWIND_SNAPSHOTS, false);
+        } else if (input.pressed && input.action == ACTION_RESTART) {
+          RestartRun();
+        } else if (input.action == ACTION_LANE_UP || input.action == ACTION_LANE_DOWN || input.action == ACTION_BRAKE) {
+          InputManager::GetInstance()->QueueAction(input);
         }
-    }
-        if (event.type == SDL_KEYUP && !m_isPaused && m_Player && event.key.repeat == 0) {
-           m_Player->handleEvent(event);
-    }
-    break;
+        break;
       case STATE_ABOUT:
-        if (event.type == SDL_KEYDOWN && event.key.keysym.sym == SDLK_ESCAPE) {
+        if (hasAction && input.pressed && input.action == ACTION_BACK) {
           SetGameState(STATE_MAIN_MENU);
         }
         break;
 
       case STATE_GAME_OVER:
       case STATE_WIN:
-        if (event.type == SDL_KEYDOWN && event.key.keysym.sym == SDLK_r) {
+        if (!hasAction || !input.pressed) break;
+        if (input.action == ACTION_RESTART && !NetSession::GetInstance()->IsActive()) {
           SDL_Log("Restarting game...");
-          m_BackgroundScrollX = 0.0f;
-          m_remainingSeconds = 60;
-          m_gameOverStartTime = 0;
-          m_showGameOverScreen = false;
-          m_obstacles.clear();
-          m_timeSinceLastSpawn = 1.0f;
-          m_obstacleSpawnInterval = 2.3f;
-          m_lastDifficultyIncreaseTime = SDL_GetTicks();
-          m_lastMaxSpeedIncreaseTime = SDL_GetTicks();
-          m_totalDistanceTraveled = 0.0f;
-          m_lastDisplayedDistance = -1;
-          if (m_distanceTexture) {
-            SDL_DestroyTexture(m_distanceTexture);
-            m_distanceTexture = nullptr;
-          }
-          if (m_Player) {
-            m_Player->reset(150.0f, m_laneYPositions);
-          }
+          ResetGameData();
           SetGameState(STATE_START_SCREEN);
-        } else if (event.type == SDL_KEYDOWN && event.key.keysym.sym == SDLK_ESCAPE) {
+        } else if (input.action == ACTION_BACK) {
           SetGameState(STATE_MAIN_MENU);
         }
         break;
     }
 
   }
+  EventQueue::GetInstance()->Dispatch();
 }
 
 bool Engine::Clean() {
   SDL_Log("Cleaning Engine...");
+  if (LatencyProbe::GetInstance()->IsEnabled()) {
+    LatencyProbe::GetInstance()->Report();
+  }
+  FramePacer::GetInstance()->Report();
+  NetSession::GetInstance()->Close();
+  FrameCapture::GetInstance()->Flush(m_Renderer);
+  FrameCapture::GetInstance()->Report();
+  FrameCapture::GetInstance()->Clean();
+  PauseMenu::GetInstance()->Clean();
+  MainMenu::GetInstance()->Clean();
+  GhostManager::GetInstance()->Clean();
+  m_sceneCache.Release();
+  m_resolutionScaler.Release();
   TextureManager::GetInstance()->Clean();
   if (m_returnPromptTexture) {
     SDL_DestroyTexture(m_returnPromptTexture);
@@ -896,23 +1591,25 @@ bool Engine::Clean() {
   }
   m_obstacles.clear();
   m_obstacleTextureIds.clear();
-  if (m_distanceTexture != nullptr) {
-    SDL_DestroyTexture(m_distanceTexture);
-    m_distanceTexture = nullptr;
-  }
+  ReleaseHudText();
+  RenderStats::GetInstance()->ReleaseOverlay();
   if (m_uiFont != nullptr) {
     TTF_CloseFont(m_uiFont);
     m_uiFont = nullptr;
   }
-  if (m_Player) {
-    delete m_Player;
-    m_Player = nullptr;
+  for (int i = 0; i < MAX_RIDERS; ++i) {
+    delete m_riders[i];
+    m_riders[i] = nullptr;
   }
+  m_Player = nullptr;
   AudioManager::GetInstance()->Clean();
+  InputManager::GetInstance()->Clean();
   SDL_DestroyRenderer(m_Renderer);
-  SDL_DestroyWindow(m_Window);
+  if (m_Window) SDL_DestroyWindow(m_Window);
+  if (m_frameSurface) SDL_FreeSurface(m_frameSurface);
   m_Renderer = nullptr;
   m_Window = nullptr;
+  m_frameSurface = nullptr;
   m_timerTextures.clear();
   TTF_Quit();
   IMG_Quit();
@@ -7,14 +7,39 @@
 #include "SDL.h"
 #include "SDL_image.h"
 #include "SDL_ttf.h"
-//#include "Obstacle.h"
+#include "../Obstacles/Obstacle.h"
 #include "../Audio/AudioManager.h"
+#include "../Graphics/RenderCache.h"
+#include "../Graphics/ResolutionScaler.h"
+#include "../Net/NetSession.h"
+#include "Clock.h"
+#include "Random.h"
+#include "Snapshot.h"
+#include "TimerWheel.h"
+#include "EventQueue.h"
 #define SCREEN_WIDTH 800
 #define SCREEN_HEIGHT 600
 #define VOLUME_MAX 128
 #define VOLUME_STEP 8
+#define SIM_STEP_MICROS 8333
+#define IDLE_WAIT_MS 100
+#define IDLE_TIMER_WAIT_MS 10
+#define IDLE_BACKGROUND_WAIT_MS 250
+#define PLAYER_START_X 150.0f
+#define REWIND_SNAPSHOTS 4
+#define RIVAL_ALPHA 200
+#define SPLIT_VIEW_HEIGHT (SCREEN_HEIGHT / 2)
+#define MAX_LANES 3
+#define HUD_DISTANCE_X 15
+#define HUD_DISTANCE_Y 15
 
 class Player;
+enum HudText {
+    HUD_TEXT_LABEL,
+    HUD_TEXT_DIGITS,
+    HUD_TEXT_UNITS,
+    HUD_TEXT_COUNT
+};
 enum GameState {
     STATE_MAIN_MENU,
     STATE_START_SCREEN,
@@ -43,6 +68,7 @@ public:
     inline bool IsRunning() const { return m_IsRunning; }
     inline SDL_Renderer* GetRenderer() { return m_Renderer; }
     inline GameState GetGameState() const { return m_gameState; }
+    inline TimerWheel* GetGameTimers() { return &m_gameTimers; }
     void SetGameState(GameState newState);
 
     void IncreaseVolume();
@@ -51,11 +77,34 @@ public:
     inline bool IsMuted() const { return m_isMuted; }
     inline int GetMasterVolume() const { return m_currentMasterVolume; }
 
-    void TogglePause();
-    void RenderPauseMenu();
-    void HandleEvents(SDL_Event& e);
+    void SetPaused(bool paused);
+    inline bool IsPaused() const { return m_isPaused; }
+    inline ResolutionScaler* GetResolutionScaler() { return &m_resolutionScaler; }
+
+    // Must be called before Init(): renders into a surface with no window
+    // and uses the dummy video and audio drivers unless others are set.
+    void SetHeadless(bool headless);
+    inline bool IsHeadless() const { return m_headless; }
+    void SetSeed(Uint32 seed);
+    // Must be called before Init(): two riders on one machine, each with a
+    // view of its own, simulated together in every step.
+    inline void SetSplitScreen(bool split) { m_splitScreen = split; }
+    inline bool IsSplitScreen() const { return m_splitScreen; }
+    inline int GetRiderCount() const { return m_riderCount; }
+    inline Uint32 GetRunStep() const { return m_runStep; }
     void ResetGameData();
 
+    // Rewinds the current run to the snapshot `back` entries before the
+    // newest one (clamped to the oldest). With fork, a replay stops there and
+    // live input takes over.
+    bool Rewind(int back, bool fork);
+    void RestartRun();
+    void SetSnapshotInterval(Uint32 steps);
+    // Re-simulates net race steps as a rollback would and reports any step
+    // that does not come out the same as the first time.
+    inline void SetNetResimCheck(bool check) { m_netResimCheck = check; }
+    inline int GetNetResimMismatches() const { return m_netResimMismatches; }
+
 private:
     Engine() :
         m_IsRunning(false),
@@ -63,42 +112,60 @@ private:
         m_Renderer(nullptr),
         m_Player(nullptr),
         m_isPaused(false),
-        m_menuOption(0),
-        m_lastTick(0),
         m_deltaTime(0.0f),
-        m_BackgroundScrollX(0.0f),
+        m_lastUpdateTicks(0),
         m_remainingSeconds(60),
-        m_lastSecondUpdate(0),
         m_gameState(STATE_START_SCREEN),
-        m_gameOverStartTime(0),
         m_showGameOverScreen(false),
         m_obstacleSpawnInterval(2.3f),
         m_timeSinceLastSpawn(0.0f),
         m_minSpawnInterval(0.55f),
-        m_lastDifficultyIncreaseTime(0),
         m_difficultyIncreaseInterval(6000),
         m_spawnIntervalReduction(0.18f),
         m_obstacleTextureWidth(0),
         m_obstacleTextureHeight(0),
         m_rng(std::random_device{}()),
-        m_lastMaxSpeedIncreaseTime(0),
         m_maxSpeedIncreaseInterval(1000),
         m_maxSpeedIncreaseAmount(20.0f),
         m_absoluteMaxPlayerSpeed(2000.0f),
         m_doubleSpawnChance(40),
-        m_totalDistanceTraveled(0.0f),
         m_uiFont(nullptr),
-        m_distanceTexture(nullptr),
-        m_lastDisplayedDistance(-1),
-        m_lastCountdownSecondPlayed(-1),
+        m_collisionCount(0),
+        m_laneChangeCount(0),
+        m_crashSound(INVALID_SOUND_HANDLE),
+        m_countdownSound(INVALID_SOUND_HANDLE),
+        m_winSound(INVALID_SOUND_HANDLE),
+        m_loseSound(INVALID_SOUND_HANDLE),
         m_currentMasterVolume(VOLUME_MAX),
         m_isMuted(false),
         m_volumeBeforeMute(VOLUME_MAX),
         m_returnPromptTexture(nullptr),
         m_showReturnPrompt(false),
-        m_endScreenStartTime(0)
-
-    {}
+        m_needsPresent(true),
+        m_windowFocused(true),
+        m_windowMinimized(false),
+        m_headless(false),
+        m_frameSurface(nullptr),
+        m_runStep(0),
+        m_difficultyTimer(INVALID_TIMER_ID),
+        m_maxSpeedTimer(INVALID_TIMER_ID),
+        m_countdownTimer(INVALID_TIMER_ID),
+        m_snapshotInterval(SNAPSHOT_DEFAULT_INTERVAL),
+        m_riderCount(1),
+        m_localRider(0),
+        m_splitScreen(false),
+        m_netLocalInput(0),
+        m_netChecksumFrame(0),
+        m_netResimCheck(false),
+        m_netResimCheckStep(0),
+        m_netResimMismatches(0)
+    {
+        for (int i = 0; i < HUD_TEXT_COUNT; ++i) m_hudText[i] = nullptr;
+        for (int i = 0; i < MAX_RIDERS; ++i) {
+            m_riders[i] = nullptr;
+            m_riderDistance[i] = 0.0f;
+        }
+    }
 
     int m_currentMasterVolume;
     bool m_isMuted;
@@ -108,59 +175,134 @@ private:
     SDL_Texture* m_returnPromptTexture;
     SDL_Rect m_returnPromptRect;
     bool m_showReturnPrompt;
-    Uint32 m_endScreenStartTime;
     const Uint32 RETURN_PROMPT_DELAY = 1500;
+    const Uint32 GAME_OVER_SCREEN_DELAY = 2000;
 
     bool m_IsRunning;
     SDL_Window* m_Window;
     SDL_Renderer* m_Renderer;
     static Engine* s_Instance;
     Player* m_Player;
-    Uint32 m_lastTick;
     float m_deltaTime;
-    float m_BackgroundScrollX;
+    Uint32 m_lastUpdateTicks;
     std::vector<float> m_laneYPositions;
     const float TRACK_Y_POSITION = 400.0f;
     const float TRACK_HEIGHT = 200.0f;
+    const float LANE_PAN_WIDTH = 0.6f;
     int m_remainingSeconds;
-    Uint32 m_lastSecondUpdate;
     std::vector<std::string> m_timerTextures;
     SDL_Rect m_timerRect = {SCREEN_WIDTH - 120, 20, 100, 100};
     GameState m_gameState;
-    Uint32 m_gameOverStartTime;
     bool m_showGameOverScreen;
     std::vector<Obstacle> m_obstacles;
     float m_obstacleSpawnInterval;
     float m_timeSinceLastSpawn;
     float m_minSpawnInterval;
-    Uint32 m_lastDifficultyIncreaseTime;
     const Uint32 m_difficultyIncreaseInterval;
     float m_spawnIntervalReduction;
     int m_obstacleTextureWidth;
     int m_obstacleTextureHeight;
     std::vector<std::string> m_obstacleTextureIds;
-    std::mt19937 m_rng;
-    Uint32 m_lastMaxSpeedIncreaseTime;
+    Pcg32 m_rng;
     Uint32 m_maxSpeedIncreaseInterval;
     float m_maxSpeedIncreaseAmount;
     const float m_absoluteMaxPlayerSpeed;
     const int m_doubleSpawnChance;
-    float m_totalDistanceTraveled;
     const float WIN_DISTANCE = 35000.0f;
     TTF_Font* m_uiFont;
-    SDL_Rect m_distanceRect = { 15, 15, 0, 0 };
-    SDL_Texture* m_distanceTexture;
-    int m_lastDisplayedDistance;
-    int m_lastCountdownSecondPlayed;
+    SDL_Texture* m_hudText[HUD_TEXT_COUNT];
+    SDL_Point m_hudTextSize[HUD_TEXT_COUNT];
+    int m_collisionCount;
+    int m_laneChangeCount;
+    SoundHandle m_crashSound;
+    SoundHandle m_countdownSound;
+    SoundHandle m_winSound;
+    SoundHandle m_loseSound;
+    TimerWheel m_gameTimers;
 
     const int MAX_ACTIVE_OBSTACLES = 1;
 
     void SpawnObstacle();
+    float GetLanePan(float y) const;
+    void Step(float deltaTime);
+    void ApplyInputActions(Uint32 upToTimestamp);
+    void PresentFrame();
+    void BeginRun();
+    void ScheduleRunTimers(Uint32 difficultyDelay, Uint32 maxSpeedDelay, Uint32 countdownDelay);
+    bool CaptureSnapshot(GameSnapshot* out) const;
+    void RestoreSnapshot(const GameSnapshot& snapshot, bool fork);
+    void RestoreSimState(const GameSnapshot& snapshot);
+    void CreateHudText();
+    void ReleaseHudText();
+    void DrawDistance(int view);
+    float GetBackgroundScroll(int rider) const;
+    void DrawViews();
+    void DrawWorld(int viewer);
+    void DrawRivals(int viewer);
+    void ResyncHeldBrakes();
+    inline float GetLocalDistance() const { return m_riderDistance[m_localRider]; }
+    inline int GetViewCount() const { return m_splitScreen ? m_riderCount : 1; }
+    inline int GetViewRider(int view) const { return m_splitScreen ? view : m_localRider; }
+
+    bool UpdateNet(Uint32 frameStart, Uint32 frameEnd);
+    void SimulateNetFrame();
+    bool NetRollback();
+    bool ResimulateNet(Uint32 frame);
+    void CheckNetResimulation();
+    void UpdateNetChecksum();
+    void TraceCounters();
+    void ApplyRiderInput(Player* rider, Uint8 input);
+    void OnCountdownSecond();
+    static void OnAudioEvents(const GameEvent* events, int count, void* userData);
+    static void OnStatsEvents(const GameEvent* events, int count, void* userData);
+
+    void DrawScene();
+    void DrawHud();
+    bool IsStaticScene() const;
+    bool AlwaysRender() const;
+    void InvalidateScene();
+    int GetIdleWaitMs() const;
+    void HandleWindowEvent(const SDL_WindowEvent& window);
 
     bool m_isPaused;
-    int m_menuOption=0;
-    SDL_Rect continueRect;
-    SDL_Rect restartRect;
+
+    // Static screens are composed once into m_sceneCache and only presented
+    // again when m_needsPresent is set or an overlay changes.
+    RenderCache m_sceneCache;
+    bool m_needsPresent;
+    bool m_windowFocused;
+    bool m_windowMinimized;
+
+    // Only the scrolling world goes through the scaler; the HUD and menus
+    // are drawn at native resolution on top.
+    ResolutionScaler m_resolutionScaler;
+
+    bool m_headless;
+    SDL_Surface* m_frameSurface;
+    Uint32 m_runStep;
+
+    TimerId m_difficultyTimer;
+    TimerId m_maxSpeedTimer;
+    TimerId m_countdownTimer;
+    Uint32 m_snapshotInterval;
+    SnapshotRing m_snapshots;
+    GameSnapshot m_runStartSnapshot;
+
+    // All riders share one world; m_Player is the local one, whose view is
+    // drawn and whose input this machine provides.
+    Player* m_riders[MAX_RIDERS];
+    float m_riderDistance[MAX_RIDERS];
+    int m_riderCount;
+    int m_localRider;
+    bool m_splitScreen;
+
+    // State before each of the last NET_ROLLBACK_FRAMES steps of a net race.
+    GameSnapshot m_netStates[NET_ROLLBACK_FRAMES];
+    Uint8 m_netLocalInput;
+    Uint32 m_netChecksumFrame;
+    bool m_netResimCheck;
+    Uint32 m_netResimCheckStep;
+    int m_netResimMismatches;
 };
 
 #endif // ENGINE_H
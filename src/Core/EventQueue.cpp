@@ -0,0 +1,60 @@
+#include "EventQueue.h"
+
+EventQueue* EventQueue::s_Instance = nullptr;
+
+bool EventQueue::Push(const GameEvent& event) {
+    if (EVENT_MASK(event.type) & m_suppressedMask) return true;
+    int& count = m_counts[m_writeBuffer];
+    if (count >= EVENT_QUEUE_CAPACITY) {
+        m_droppedCount++;
+        return false;
+    }
+    m_events[m_writeBuffer][count++] = event;
+    return true;
+}
+
+bool EventQueue::Subscribe(Uint32 typeMask, GameEventListener listener, void* userData) {
+    if (listener == nullptr || m_listenerCount >= EVENT_LISTENER_CAPACITY) {
+        SDL_Log("EventQueue::Subscribe - Error: listener table full or null listener.");
+        return false;
+    }
+    m_listeners[m_listenerCount].typeMask = typeMask;
+    m_listeners[m_listenerCount].callback = listener;
+    m_listeners[m_listenerCount].userData = userData;
+    m_listenerCount++;
+    return true;
+}
+
+void EventQueue::Unsubscribe(GameEventListener listener, void* userData) {
+    for (int i = 0; i < m_listenerCount; ++i) {
+        if (m_listeners[i].callback == listener && m_listeners[i].userData == userData) {
+            m_listeners[i] = m_listeners[--m_listenerCount];
+            return;
+        }
+    }
+}
+
+void EventQueue::Dispatch() {
+    int readBuffer = m_writeBuffer;
+    int count = m_counts[readBuffer];
+    if (count == 0) return;
+
+    m_writeBuffer = 1 - m_writeBuffer;
+    m_counts[m_writeBuffer] = 0;
+
+    const GameEvent* events = m_events[readBuffer];
+    Uint32 batchMask = 0;
+    for (int i = 0; i < count; ++i) {
+        batchMask |= EVENT_MASK(events[i].type);
+    }
+    for (int i = 0; i < m_listenerCount; ++i) {
+        if (m_listeners[i].typeMask & batchMask) {
+            m_listeners[i].callback(events, count, m_listeners[i].userData);
+        }
+    }
+    m_counts[readBuffer] = 0;
+}
+
+void EventQueue::Clear() {
+    m_counts[0] = m_counts[1] = 0;
+}
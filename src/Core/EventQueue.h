@@ -0,0 +1,80 @@
+#ifndef EVENTQUEUE_H
+#define EVENTQUEUE_H
+
+#include "SDL.h"
+
+#define EVENT_QUEUE_CAPACITY 256
+#define EVENT_LISTENER_CAPACITY 16
+#define EVENT_MASK(type) (1u << (type))
+#define EVENT_MASK_ALL 0xFFFFFFFFu
+
+enum GameEventType {
+    EVENT_COLLISION,
+    EVENT_LANE_CHANGE,
+    EVENT_SECOND_TICK,
+    EVENT_WIN,
+    EVENT_LOSE,
+    EVENT_STATE_CHANGED,
+    EVENT_PAUSE_CHANGED,
+    EVENT_TYPE_COUNT
+};
+
+struct GameEvent {
+    GameEventType type;
+    Uint32 time;
+    union {
+        struct { int x; int y; } collision;
+        struct { int rider; int fromLane; int toLane; } laneChange;
+        struct { int remainingSeconds; } secondTick;
+        struct { float distance; } result;
+        struct { int oldState; int newState; } stateChange;
+        struct { bool paused; } pause;
+    };
+};
+
+typedef void (*GameEventListener)(const GameEvent* events, int count, void* userData);
+
+// Fixed-capacity, double-buffered queue. Gameplay pushes during the frame;
+// Dispatch() hands each listener the whole batch once. Events pushed while
+// dispatching land in the other buffer and go out on the next Dispatch().
+class EventQueue {
+public:
+    static EventQueue* GetInstance() {
+        return s_Instance = (s_Instance != nullptr) ? s_Instance : new EventQueue();
+    }
+
+    bool Push(const GameEvent& event);
+    bool Subscribe(Uint32 typeMask, GameEventListener listener, void* userData);
+    void Unsubscribe(GameEventListener listener, void* userData);
+    void Dispatch();
+    void Clear();
+
+    // Events of the masked types are dropped, e.g. while re-simulating
+    // steps whose sounds and stats were already produced once.
+    inline void SetSuppressedMask(Uint32 mask) { m_suppressedMask = mask; }
+
+    inline int GetPendingCount() const { return m_counts[m_writeBuffer]; }
+    inline Uint32 GetDroppedCount() const { return m_droppedCount; }
+
+private:
+    EventQueue() : m_writeBuffer(0), m_listenerCount(0), m_droppedCount(0), m_suppressedMask(0) {
+        m_counts[0] = m_counts[1] = 0;
+    }
+    static EventQueue* s_Instance;
+
+    struct Listener {
+        Uint32 typeMask;
+        GameEventListener callback;
+        void* userData;
+    };
+
+    GameEvent m_events[2][EVENT_QUEUE_CAPACITY];
+    int m_counts[2];
+    int m_writeBuffer;
+    Listener m_listeners[EVENT_LISTENER_CAPACITY];
+    int m_listenerCount;
+    Uint32 m_droppedCount;
+    Uint32 m_suppressedMask;
+};
+
+#endif // EVENTQUEUE_H
@@ -0,0 +1,141 @@
+#include <cmath>
+#include "FramePacer.h"
+
+FramePacer* FramePacer::s_Instance = nullptr;
+
+void FramePacer::Init(SDL_Renderer* renderer, SDL_Window* window) {
+    m_frequency = SDL_GetPerformanceFrequency();
+    if (window == nullptr) {
+        // Headless: nothing to show frames on, so run as fast as possible.
+        SetTargetRate(0);
+        return;
+    }
+
+    SDL_DisplayMode mode;
+    if (SDL_GetCurrentDisplayMode(SDL_GetWindowDisplayIndex(window), &mode) == 0 && mode.refresh_rate > 0) {
+        m_displayHz = mode.refresh_rate;
+    }
+
+    SDL_RendererInfo info;
+    m_vsync = SDL_GetRendererInfo(renderer, &info) == 0 && (info.flags & SDL_RENDERER_PRESENTVSYNC) != 0;
+    if (m_vsync) {
+        SetTargetRate(0);
+        SDL_Log("FramePacer: renderer '%s' presents with vsync, pacing left to the display.", info.name);
+        return;
+    }
+    SetTargetRate(m_displayHz);
+    SDL_Log("FramePacer: no vsync, limiting to %d Hz.", m_displayHz);
+}
+
+float FramePacer::GetFrameBudgetMs() const {
+    return 1000.0f / (m_targetHz > 0 ? m_targetHz : m_displayHz);
+}
+
+void FramePacer::SetTargetRate(int hz) {
+    if (m_frequency <= 1) m_frequency = SDL_GetPerformanceFrequency();
+    m_targetHz = hz > 0 ? hz : 0;
+    m_periodTicks = m_targetHz > 0 ? m_frequency / m_targetHz : 0;
+    m_costTicks = 0.0;
+    Resync();
+}
+
+void FramePacer::Resync() {
+    m_resync = true;
+}
+
+void FramePacer::WaitForFrame() {
+    if (m_periodTicks == 0 || m_resync) {
+        m_frameStart = SDL_GetPerformanceCounter();
+        return;
+    }
+    double lead = m_costTicks + FRAME_PACER_SAFETY_MICROS * m_frequency / 1000000.0;
+    if (lead > static_cast<double>(m_periodTicks)) lead = static_cast<double>(m_periodTicks);
+    SleepUntil(m_deadline - static_cast<Uint64>(lead));
+    m_frameStart = SDL_GetPerformanceCounter();
+}
+
+void FramePacer::SleepUntil(Uint64 target) {
+    Uint64 now = SDL_GetPerformanceCounter();
+    if (now >= target) return;
+
+    Uint64 spinTicks = FRAME_PACER_SPIN_MICROS * m_frequency / 1000000;
+    double sleepTicks = static_cast<double>(target - now) - spinTicks - m_sleepOvershootTicks;
+    if (sleepTicks > 0.0) {
+        Uint32 sleepMs = static_cast<Uint32>(sleepTicks * 1000.0 / m_frequency);
+        if (sleepMs > 0) {
+            Uint64 before = SDL_GetPerformanceCounter();
+            SDL_Delay(sleepMs);
+            Uint64 slept = SDL_GetPerformanceCounter() - before;
+            double overshoot = static_cast<double>(slept) - sleepMs * static_cast<double>(m_frequency) / 1000.0;
+            if (overshoot < 0.0) overshoot = 0.0;
+            m_sleepOvershootTicks += (overshoot - m_sleepOvershootTicks) * 0.1;
+        }
+    }
+    while (SDL_GetPerformanceCounter() < target) {
+        // Spin the last stretch; sleeping here would overshoot the deadline.
+    }
+}
+
+void FramePacer::EndFrame() {
+    Uint64 now = SDL_GetPerformanceCounter();
+
+    if (m_lastPresent != 0 && !m_resync) {
+        double interval = static_cast<double>(now - m_lastPresent);
+        m_frames++;
+        double delta = interval - m_intervalMean;
+        m_intervalMean += delta / m_frames;
+        m_intervalM2 += delta * (interval - m_intervalMean);
+        if (interval > m_intervalMax) m_intervalMax = interval;
+    }
+    m_lastPresent = now;
+
+    if (m_periodTicks == 0) {
+        m_resync = false;
+        return;
+    }
+
+    if (m_resync) {
+        m_deadline = now + m_periodTicks;
+        m_resync = false;
+        return;
+    }
+
+    // Costs rise fast and decay slowly so one cheap frame does not make the
+    // next wake-up too late.
+    double cost = static_cast<double>(now - m_frameStart);
+    double rate = cost > m_costTicks ? FRAME_PACER_COST_RISE : FRAME_PACER_COST_FALL;
+    m_costTicks += (cost - m_costTicks) * rate;
+
+    Uint64 tolerance = FRAME_PACER_MISS_TOLERANCE_MICROS * m_frequency / 1000000;
+    if (now > m_deadline + tolerance) {
+        m_missed++;
+    }
+    m_deadline += m_periodTicks;
+    if (now > m_deadline) {
+        // More than a whole period behind: drop the lost frames instead of
+        // racing to catch up.
+        m_deadline = now + m_periodTicks;
+    }
+}
+
+void FramePacer::GetStats(FramePacerStats* out) const {
+    double toMs = 1000.0 / m_frequency;
+    out->frames = m_frames;
+    out->missed = m_missed;
+    out->averageMs = m_intervalMean * toMs;
+    out->stdDevMs = m_frames > 1 ? std::sqrt(m_intervalM2 / (m_frames - 1)) * toMs : 0.0;
+    out->maxMs = m_intervalMax * toMs;
+    out->learnedCostMs = m_costTicks * toMs;
+    out->targetHz = m_targetHz;
+}
+
+void FramePacer::Report() const {
+    FramePacerStats stats;
+    GetStats(&stats);
+    if (stats.frames == 0) {
+        SDL_Log("FramePacer: no frames recorded.");
+        return;
+    }
+    SDL_Log("FramePacer: %u frames at target %d Hz, avg %.2f ms, stddev %.2f ms, max %.2f ms, %u missed deadlines, learned cost %.2f ms",
+            stats.frames, stats.targetHz, stats.averageMs, stats.stdDevMs, stats.maxMs, stats.missed, stats.learnedCostMs);
+}
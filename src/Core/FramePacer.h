@@ -0,0 +1,75 @@
+#ifndef FRAMEPACER_H
+#define FRAMEPACER_H
+
+#include "SDL.h"
+
+#define FRAME_PACER_SPIN_MICROS 1500
+#define FRAME_PACER_SAFETY_MICROS 1000
+#define FRAME_PACER_MISS_TOLERANCE_MICROS 500
+#define FRAME_PACER_COST_RISE 0.25
+#define FRAME_PACER_COST_FALL 0.02
+#define FRAME_PACER_DEFAULT_HZ 60
+
+struct FramePacerStats {
+    Uint32 frames;
+    Uint32 missed;
+    double averageMs;
+    double stdDevMs;
+    double maxMs;
+    double learnedCostMs;
+    int targetHz;
+};
+
+// Paces the main loop when present does not block on vsync. Each frame has
+// a deadline one period after the previous one; the pacer sleeps until the
+// learned frame cost before that deadline, so events are polled as late as
+// possible, and finishes the wait with a short spin because SDL_Delay only
+// has millisecond granularity. A target of 0 leaves pacing to vsync and
+// only records stats.
+class FramePacer {
+public:
+    static FramePacer* GetInstance() {
+        return s_Instance = (s_Instance != nullptr) ? s_Instance : new FramePacer();
+    }
+
+    void Init(SDL_Renderer* renderer, SDL_Window* window);
+    void SetTargetRate(int hz);
+    inline int GetTargetRate() const { return m_targetHz; }
+    inline bool HasVsync() const { return m_vsync; }
+    float GetFrameBudgetMs() const;
+
+    void WaitForFrame();
+    void EndFrame();
+    void Resync();
+
+    void GetStats(FramePacerStats* out) const;
+    void Report() const;
+
+private:
+    FramePacer() : m_frequency(1), m_targetHz(0), m_displayHz(FRAME_PACER_DEFAULT_HZ), m_vsync(false), m_periodTicks(0), m_deadline(0), m_frameStart(0),
+        m_lastPresent(0), m_costTicks(0.0), m_sleepOvershootTicks(0.0), m_resync(true),
+        m_frames(0), m_missed(0), m_intervalMean(0.0), m_intervalM2(0.0), m_intervalMax(0.0) {}
+    static FramePacer* s_Instance;
+
+    void SleepUntil(Uint64 target);
+
+    Uint64 m_frequency;
+    int m_targetHz;
+    int m_displayHz;
+    bool m_vsync;
+    Uint64 m_periodTicks;
+    Uint64 m_deadline;
+    Uint64 m_frameStart;
+    Uint64 m_lastPresent;
+    double m_costTicks;
+    double m_sleepOvershootTicks;
+    bool m_resync;
+
+    Uint32 m_frames;
+    Uint32 m_missed;
+    double m_intervalMean;
+    double m_intervalM2;
+    double m_intervalMax;
+};
+
+#endif // FRAMEPACER_H
@@ -0,0 +1,320 @@
+#include <cstdlib>
+#include <cstring>
+#include "Log.h"
+
+Logger* Logger::s_Instance = nullptr;
+
+struct LogRateEntry {
+    const char* format;
+    Uint32 windowStart;
+    Uint32 count;
+    Uint32 suppressed;
+};
+
+struct LogRing {
+    LogRecord records[LOG_RING_CAPACITY];
+    SDL_atomic_t head;
+    SDL_atomic_t tail;
+    LogRateEntry rates[LOG_RATE_SLOTS];
+};
+
+static thread_local LogRing* t_ring = nullptr;
+static thread_local bool t_ringFailed = false;
+static thread_local LogRecord t_syncRecord;
+
+static const char* s_levelNames[] = { "debug", "info", "warn", "error" };
+static const char* s_levelTags[] = { "DEBUG", "INFO ", "WARN ", "ERROR" };
+
+Logger::Logger() : m_level(LOG_MIN_LEVEL), m_file(nullptr), m_thread(nullptr), m_wake(nullptr), m_registerLock(nullptr) {
+    SDL_AtomicSet(&m_running, 0);
+    SDL_AtomicSet(&m_ringCount, 0);
+    SDL_AtomicSet(&m_dropped, 0);
+    for (int i = 0; i < LOG_MAX_THREADS; ++i) m_rings[i] = nullptr;
+    m_registerLock = SDL_CreateMutex();
+}
+
+bool Logger::Start() {
+    if (SDL_AtomicGet(&m_running)) return true;
+    if (m_wake == nullptr) m_wake = SDL_CreateSemaphore(0);
+    // The caller's ring is allocated now rather than on its first message,
+    // which may be in the middle of a run with an allocation budget.
+    GetThreadRing();
+    SDL_AtomicSet(&m_running, 1);
+    m_thread = SDL_CreateThread(&Logger::DrainThread, "LogDrain", this);
+    if (m_thread == nullptr) {
+        SDL_AtomicSet(&m_running, 0);
+        SDL_Log("Logger::Start - Error: cannot create drain thread: %s", SDL_GetError());
+        return false;
+    }
+    // Early returns from main() still get their messages written.
+    static bool atExitRegistered = false;
+    if (!atExitRegistered) {
+        std::atexit(&Logger::StopAtExit);
+        atExitRegistered = true;
+    }
+    return true;
+}
+
+void Logger::Stop() {
+    if (!SDL_AtomicGet(&m_running)) return;
+    SDL_AtomicSet(&m_running, 0);
+    SDL_SemPost(m_wake);
+    SDL_WaitThread(m_thread, nullptr);
+    m_thread = nullptr;
+    int dropped = SDL_AtomicGet(&m_dropped);
+    if (dropped > 0) {
+        LOG_WARN("Logger: %d messages dropped because a log ring was full.", dropped);
+    }
+    if (m_file != nullptr) {
+        std::fclose(m_file);
+        m_file = nullptr;
+    }
+}
+
+void Logger::StopAtExit() {
+    GetInstance()->Stop();
+}
+
+bool Logger::SetLevel(const char* name) {
+    for (int i = LOG_LEVEL_DEBUG; i <= LOG_LEVEL_ERROR; ++i) {
+        if (std::strcmp(name, s_levelNames[i]) == 0) {
+            m_level = i;
+            return true;
+        }
+    }
+    SDL_Log("Logger::SetLevel - Error: unknown level '%s'.", name);
+    return false;
+}
+
+// Must be called before Start(); only the drain thread writes to the file.
+bool Logger::SetFile(const char* path) {
+    FILE* file = std::fopen(path, "w");
+    if (file == nullptr) {
+        SDL_Log("Logger::SetFile - Error: cannot open '%s'.", path);
+        return false;
+    }
+    if (m_file != nullptr) std::fclose(m_file);
+    m_file = file;
+    return true;
+}
+
+LogRing* Logger::GetThreadRing() {
+    if (t_ring != nullptr || t_ringFailed) return t_ring;
+    SDL_LockMutex(m_registerLock);
+    int count = SDL_AtomicGet(&m_ringCount);
+    if (count < LOG_MAX_THREADS) {
+        LogRing* ring = new LogRing();
+        SDL_AtomicSet(&ring->head, 0);
+        SDL_AtomicSet(&ring->tail, 0);
+        std::memset(ring->rates, 0, sizeof(ring->rates));
+        m_rings[count] = ring;
+        SDL_AtomicSet(&m_ringCount, count + 1);
+        t_ring = ring;
+    } else {
+        t_ringFailed = true;
+    }
+    SDL_UnlockMutex(m_registerLock);
+    return t_ring;
+}
+
+LogRecord* Logger::BeginRecord(int level, const char* format) {
+    LogRecord* record;
+    Uint32 suppressed = 0;
+    if (!SDL_AtomicGet(&m_running)) {
+        record = &t_syncRecord;
+    } else {
+        LogRing* ring = GetThreadRing();
+        if (ring == nullptr) {
+            SDL_AtomicIncRef(&m_dropped);
+            return nullptr;
+        }
+        Uint32 now = SDL_GetTicks();
+        LogRateEntry& rate = ring->rates[(reinterpret_cast<uintptr_t>(format) >> 3) % LOG_RATE_SLOTS];
+        if (rate.format != format) {
+            rate.format = format;
+            rate.windowStart = now;
+            rate.count = 0;
+            rate.suppressed = 0;
+        } else if (now - rate.windowStart >= LOG_RATE_WINDOW_MS) {
+            rate.windowStart = now;
+            rate.count = 0;
+        }
+        if (rate.count >= LOG_RATE_LIMIT) {
+            rate.suppressed++;
+            return nullptr;
+        }
+        Uint32 head = static_cast<Uint32>(SDL_AtomicGet(&ring->head));
+        if (head - static_cast<Uint32>(SDL_AtomicGet(&ring->tail)) >= LOG_RING_CAPACITY) {
+            SDL_AtomicIncRef(&m_dropped);
+            return nullptr;
+        }
+        rate.count++;
+        suppressed = rate.suppressed;
+        rate.suppressed = 0;
+        record = &ring->records[head % LOG_RING_CAPACITY];
+    }
+    record->time = SDL_GetTicks();
+    record->level = static_cast<Uint8>(level);
+    record->argCount = 0;
+    record->payloadUsed = 0;
+    record->suppressed = suppressed;
+    record->format = format;
+    return record;
+}
+
+void Logger::CommitRecord(LogRecord* record) {
+    if (record == &t_syncRecord) {
+        Emit(*record);
+        return;
+    }
+    // The atomic add is a full barrier: the record is complete before the
+    // drain thread can see the new head.
+    SDL_AtomicAdd(&t_ring->head, 1);
+    if (record->level >= LOG_LEVEL_ERROR) SDL_SemPost(m_wake);
+}
+
+void Logger::PackValue(LogRecord* record, LogArgType type, const void* value, int size) {
+    if (record->argCount >= LOG_MAX_ARGS) return;
+    int offset = (record->payloadUsed + 7) & ~7;
+    if (offset + size > LOG_PAYLOAD_SIZE) return;
+    std::memcpy(record->payload + offset, value, size);
+    record->payloadUsed = static_cast<Uint16>(offset + size);
+    record->types[record->argCount++] = static_cast<Uint8>(type);
+}
+
+void Logger::PackString(LogRecord* record, const char* value) {
+    if (record->argCount >= LOG_MAX_ARGS) return;
+    int offset = record->payloadUsed;
+    int room = LOG_PAYLOAD_SIZE - offset - 3;
+    if (room < 0) return;
+    if (value == nullptr) value = "(null)";
+    int length = static_cast<int>(std::strlen(value));
+    if (length > LOG_MAX_STRING) length = LOG_MAX_STRING;
+    if (length > room) length = room;
+    Uint16 stored = static_cast<Uint16>(length);
+    std::memcpy(record->payload + offset, &stored, sizeof(stored));
+    std::memcpy(record->payload + offset + 2, value, length);
+    record->payload[offset + 2 + length] = '\0';
+    record->payloadUsed = static_cast<Uint16>(offset + 3 + length);
+    record->types[record->argCount++] = LOG_ARG_STRING;
+}
+
+int Logger::DrainThread(void* data) {
+    Logger* logger = static_cast<Logger*>(data);
+    while (SDL_AtomicGet(&logger->m_running)) {
+        if (logger->DrainRings() == 0) SDL_SemWaitTimeout(logger->m_wake, LOG_DRAIN_INTERVAL_MS);
+    }
+    logger->DrainRings();
+    return 0;
+}
+
+int Logger::DrainRings() {
+    int drained = 0;
+    int count = SDL_AtomicGet(&m_ringCount);
+    for (int i = 0; i < count; ++i) {
+        LogRing* ring = m_rings[i];
+        Uint32 tail = static_cast<Uint32>(SDL_AtomicGet(&ring->tail));
+        Uint32 head = static_cast<Uint32>(SDL_AtomicGet(&ring->head));
+        for (; tail != head; ++tail, ++drained) {
+            Emit(ring->records[tail % LOG_RING_CAPACITY]);
+        }
+        SDL_AtomicSet(&ring->tail, static_cast<int>(tail));
+    }
+    if (drained > 0 && m_file != nullptr) std::fflush(m_file);
+    return drained;
+}
+
+static bool IsIntegerType(Uint8 type) {
+    return type <= LOG_ARG_ULONGLONG;
+}
+
+// Formats one conversion with the argument's captured type; a conversion
+// that does not match the captured argument prints "<?>" instead.
+static int FormatArg(char* out, int size, const char* spec, char conversion, const LogRecord& record, int arg, int* offset) {
+    if (arg >= record.argCount) return SDL_snprintf(out, size, "<?>");
+    Uint8 type = record.types[arg];
+    const Uint8* payload = record.payload;
+    if (type == LOG_ARG_STRING) {
+        Uint16 length;
+        std::memcpy(&length, payload + *offset, sizeof(length));
+        const char* text = reinterpret_cast<const char*>(payload + *offset + 2);
+        *offset += 3 + length;
+        return conversion == 's' ? SDL_snprintf(out, size, spec, text) : SDL_snprintf(out, size, "<?>");
+    }
+
+    int valueSize = type == LOG_ARG_INT || type == LOG_ARG_UINT ? static_cast<int>(sizeof(int))
+                  : type == LOG_ARG_LONG || type == LOG_ARG_ULONG ? static_cast<int>(sizeof(long))
+                  : type == LOG_ARG_POINTER ? static_cast<int>(sizeof(void*)) : 8;
+    *offset = (*offset + 7) & ~7;
+    const Uint8* value = payload + *offset;
+    *offset += valueSize;
+
+    bool wantsFloat = std::strchr("eEfFgGaA", conversion) != nullptr;
+    bool wantsInteger = std::strchr("diouxXc", conversion) != nullptr;
+    if (type == LOG_ARG_DOUBLE && wantsFloat) {
+        double v;
+        std::memcpy(&v, value, sizeof(v));
+        return SDL_snprintf(out, size, spec, v);
+    }
+    if (type == LOG_ARG_POINTER && conversion == 'p') {
+        void* v;
+        std::memcpy(&v, value, sizeof(v));
+        return SDL_snprintf(out, size, spec, v);
+    }
+    if (!IsIntegerType(type) || !wantsInteger) return SDL_snprintf(out, size, "<?>");
+    switch (type) {
+        case LOG_ARG_INT: { int v; std::memcpy(&v, value, sizeof(v)); return SDL_snprintf(out, size, spec, v); }
+        case LOG_ARG_UINT: { unsigned int v; std::memcpy(&v, value, sizeof(v)); return SDL_snprintf(out, size, spec, v); }
+        case LOG_ARG_LONG: { long v; std::memcpy(&v, value, sizeof(v)); return SDL_snprintf(out, size, spec, v); }
+        case LOG_ARG_ULONG: { unsigned long v; std::memcpy(&v, value, sizeof(v)); return SDL_snprintf(out, size, spec, v); }
+        case LOG_ARG_LONGLONG: { long long v; std::memcpy(&v, value, sizeof(v)); return SDL_snprintf(out, size, spec, v); }
+        default: { unsigned long long v; std::memcpy(&v, value, sizeof(v)); return SDL_snprintf(out, size, spec, v); }
+    }
+}
+
+void Logger::Emit(const LogRecord& record) {
+    char line[LOG_LINE_SIZE];
+    int used = SDL_snprintf(line, sizeof(line), "[%6u.%03u] %s ", record.time / 1000, record.time % 1000,
+                            s_levelTags[record.level]);
+    int arg = 0;
+    int offset = 0;
+    for (const char* p = record.format; *p != '\0' && used < LOG_LINE_SIZE - 1; ++p) {
+        if (*p != '%') {
+            line[used++] = *p;
+            continue;
+        }
+        if (p[1] == '%') {
+            line[used++] = '%';
+            ++p;
+            continue;
+        }
+        char spec[16];
+        int specLength = 0;
+        const char* q = p;
+        spec[specLength++] = *q++;
+        while (*q != '\0' && std::strchr("-+ #0123456789.hlLqjzt", *q) != nullptr && specLength < 14) {
+            spec[specLength++] = *q++;
+        }
+        if (*q == '\0') break;
+        spec[specLength++] = *q;
+        spec[specLength] = '\0';
+        int written = FormatArg(line + used, LOG_LINE_SIZE - used, spec, *q, record, arg++, &offset);
+        if (written > 0) used += written;
+        if (used > LOG_LINE_SIZE - 1) used = LOG_LINE_SIZE - 1;
+        p = q;
+    }
+    if (record.suppressed > 0 && used < LOG_LINE_SIZE - 1) {
+        used += SDL_snprintf(line + used, LOG_LINE_SIZE - used, " (%u similar suppressed)", record.suppressed);
+        if (used > LOG_LINE_SIZE - 1) used = LOG_LINE_SIZE - 1;
+    }
+    line[used] = '\0';
+
+    if (m_file != nullptr) {
+        std::fputs(line, m_file);
+        std::fputc('\n', m_file);
+        return;
+    }
+    SDL_LogPriority priority = record.level >= LOG_LEVEL_ERROR ? SDL_LOG_PRIORITY_ERROR
+                             : record.level == LOG_LEVEL_WARN ? SDL_LOG_PRIORITY_WARN : SDL_LOG_PRIORITY_INFO;
+    SDL_LogMessage(SDL_LOG_CATEGORY_APPLICATION, priority, "%s", line);
+}
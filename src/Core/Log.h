@@ -0,0 +1,152 @@
+#ifndef LOG_H
+#define LOG_H
+
+#include <cstdio>
+#include "SDL.h"
+
+#define LOG_LEVEL_DEBUG 0
+#define LOG_LEVEL_INFO 1
+#define LOG_LEVEL_WARN 2
+#define LOG_LEVEL_ERROR 3
+
+// Calls below this level are compiled out entirely.
+#ifndef LOG_MIN_LEVEL
+#define LOG_MIN_LEVEL LOG_LEVEL_DEBUG
+#endif
+
+#define LOG_RING_CAPACITY 256
+#define LOG_MAX_THREADS 16
+#define LOG_MAX_ARGS 8
+#define LOG_PAYLOAD_SIZE 192
+#define LOG_MAX_STRING 96
+#define LOG_LINE_SIZE 512
+#define LOG_DRAIN_INTERVAL_MS 5
+#define LOG_RATE_SLOTS 64
+#define LOG_RATE_LIMIT 5
+#define LOG_RATE_WINDOW_MS 1000
+
+enum LogArgType {
+    LOG_ARG_INT,
+    LOG_ARG_UINT,
+    LOG_ARG_LONG,
+    LOG_ARG_ULONG,
+    LOG_ARG_LONGLONG,
+    LOG_ARG_ULONGLONG,
+    LOG_ARG_DOUBLE,
+    LOG_ARG_STRING,
+    LOG_ARG_POINTER
+};
+
+// One message as captured on the logging thread: the format pointer and the
+// raw arguments. Formatting happens later on the drain thread, so formats
+// must be string literals; string arguments are copied (and truncated to
+// LOG_MAX_STRING).
+struct LogRecord {
+    Uint32 time;
+    Uint8 level;
+    Uint8 argCount;
+    Uint16 payloadUsed;
+    Uint32 suppressed;
+    const char* format;
+    Uint8 types[LOG_MAX_ARGS];
+    Uint8 payload[LOG_PAYLOAD_SIZE];
+};
+
+struct LogRing;
+
+// Deferred, level-filtered logging. LOG_* calls copy their arguments into a
+// ring owned by the calling thread (single producer, single consumer, no
+// locks) and return; a background thread formats and writes them to the
+// console or to a file. A full ring drops the message and counts it rather
+// than stalling the game. Each call site may log LOG_RATE_LIMIT messages
+// per LOG_RATE_WINDOW_MS; the rest are counted and the count is appended
+// to the next message that gets through. Before Start() and after Stop()
+// messages are written synchronously. Start() registers the calling
+// thread's ring up front; other threads get theirs on their first message.
+class Logger {
+public:
+    static Logger* GetInstance() {
+        return s_Instance = (s_Instance != nullptr) ? s_Instance : new Logger();
+    }
+
+    bool Start();
+    void Stop();
+
+    inline void SetLevel(int level) { m_level = level; }
+    bool SetLevel(const char* name);
+    bool SetFile(const char* path);
+    inline bool IsEnabled(int level) const { return level >= m_level; }
+
+    template <typename... Args>
+    void Write(int level, const char* format, Args... args);
+
+    LogRecord* BeginRecord(int level, const char* format);
+    void CommitRecord(LogRecord* record);
+    void PackValue(LogRecord* record, LogArgType type, const void* value, int size);
+    void PackString(LogRecord* record, const char* value);
+
+private:
+    Logger();
+    static Logger* s_Instance;
+
+    static int DrainThread(void* data);
+    static void StopAtExit();
+    LogRing* GetThreadRing();
+    int DrainRings();
+    void Emit(const LogRecord& record);
+
+    int m_level;
+    FILE* m_file;
+    SDL_Thread* m_thread;
+    SDL_sem* m_wake;
+    SDL_mutex* m_registerLock;
+    SDL_atomic_t m_running;
+    SDL_atomic_t m_ringCount;
+    LogRing* m_rings[LOG_MAX_THREADS];
+    SDL_atomic_t m_dropped;
+};
+
+namespace LogArgs {
+    inline void Pack(LogRecord* r, int v) { Logger::GetInstance()->PackValue(r, LOG_ARG_INT, &v, sizeof(v)); }
+    inline void Pack(LogRecord* r, unsigned int v) { Logger::GetInstance()->PackValue(r, LOG_ARG_UINT, &v, sizeof(v)); }
+    inline void Pack(LogRecord* r, long v) { Logger::GetInstance()->PackValue(r, LOG_ARG_LONG, &v, sizeof(v)); }
+    inline void Pack(LogRecord* r, unsigned long v) { Logger::GetInstance()->PackValue(r, LOG_ARG_ULONG, &v, sizeof(v)); }
+    inline void Pack(LogRecord* r, long long v) { Logger::GetInstance()->PackValue(r, LOG_ARG_LONGLONG, &v, sizeof(v)); }
+    inline void Pack(LogRecord* r, unsigned long long v) { Logger::GetInstance()->PackValue(r, LOG_ARG_ULONGLONG, &v, sizeof(v)); }
+    inline void Pack(LogRecord* r, double v) { Logger::GetInstance()->PackValue(r, LOG_ARG_DOUBLE, &v, sizeof(v)); }
+    inline void Pack(LogRecord* r, const char* v) { Logger::GetInstance()->PackString(r, v); }
+    inline void Pack(LogRecord* r, char* v) { Logger::GetInstance()->PackString(r, v); }
+    template <typename T>
+    inline void Pack(LogRecord* r, T* v) {
+        const void* p = v;
+        Logger::GetInstance()->PackValue(r, LOG_ARG_POINTER, &p, sizeof(p));
+    }
+
+    inline void PackAll(LogRecord*) {}
+    template <typename T, typename... Rest>
+    inline void PackAll(LogRecord* r, T first, Rest... rest) {
+        Pack(r, first);
+        PackAll(r, rest...);
+    }
+}
+
+template <typename... Args>
+void Logger::Write(int level, const char* format, Args... args) {
+    LogRecord* record = BeginRecord(level, format);
+    if (record == nullptr) return;
+    LogArgs::PackAll(record, args...);
+    CommitRecord(record);
+}
+
+#define LOG_WRITE(level, ...) \
+    do { \
+        if ((level) >= LOG_MIN_LEVEL && Logger::GetInstance()->IsEnabled(level)) \
+            Logger::GetInstance()->Write((level), __VA_ARGS__); \
+    } while (0)
+
+#define LOG_DEBUG(...) LOG_WRITE(LOG_LEVEL_DEBUG, __VA_ARGS__)
+#define LOG_INFO(...) LOG_WRITE(LOG_LEVEL_INFO, __VA_ARGS__)
+#define LOG_WARN(...) LOG_WRITE(LOG_LEVEL_WARN, __VA_ARGS__)
+#define LOG_ERROR(...) LOG_WRITE(LOG_LEVEL_ERROR, __VA_ARGS__)
+
+#endif // LOG_H
@@ -0,0 +1,37 @@
+#ifndef RANDOM_H
+#define RANDOM_H
+
+#include "SDL.h"
+
+// PCG32 (XSH RR). Its whole state is two 64-bit words, so it can be copied
+// into a snapshot and restored bit for bit. Satisfies the standard uniform
+// random bit generator requirements, so the <random> distributions take it.
+struct Pcg32 {
+    typedef Uint32 result_type;
+
+    Uint64 state;
+    Uint64 increment;
+
+    explicit Pcg32(Uint64 seed = 0) { Seed(seed); }
+
+    void Seed(Uint64 seed, Uint64 stream = 0x14057B7EF767814FULL) {
+        state = 0;
+        increment = (stream << 1) | 1u;
+        (*this)();
+        state += seed;
+        (*this)();
+    }
+
+    result_type operator()() {
+        Uint64 old = state;
+        state = old * 6364136223846793005ULL + increment;
+        Uint32 xorshifted = static_cast<Uint32>(((old >> 18) ^ old) >> 27);
+        Uint32 rot = static_cast<Uint32>(old >> 59);
+        return (xorshifted >> rot) | (xorshifted << ((32 - rot) & 31));
+    }
+
+    static constexpr result_type min() { return 0; }
+    static constexpr result_type max() { return 0xFFFFFFFFu; }
+};
+
+#endif // RANDOM_H
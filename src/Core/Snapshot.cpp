@@ -0,0 +1,40 @@
+#include <cstring>
+#include "Snapshot.h"
+
+Uint32 SnapshotChecksum(const GameSnapshot& snapshot) {
+    GameSnapshot copy;
+    std::memcpy(&copy, &snapshot, sizeof(copy));
+    copy.collisionCount = 0;
+    copy.laneChangeCount = 0;
+    const Uint8* bytes = reinterpret_cast<const Uint8*>(&copy);
+    Uint32 hash = 2166136261u;
+    for (size_t i = 0; i < sizeof(copy); ++i) {
+        hash = (hash ^ bytes[i]) * 16777619u;
+    }
+    return hash;
+}
+
+void SnapshotRing::Clear() {
+    m_head = 0;
+    m_count = 0;
+}
+
+GameSnapshot* SnapshotRing::Push() {
+    GameSnapshot* slot = &m_slots[m_head];
+    m_head = (m_head + 1) % SNAPSHOT_RING_CAPACITY;
+    if (m_count < SNAPSHOT_RING_CAPACITY) m_count++;
+    return slot;
+}
+
+const GameSnapshot* SnapshotRing::Peek(int back) const {
+    if (back < 0 || back >= m_count) return nullptr;
+    int index = (m_head - 1 - back + SNAPSHOT_RING_CAPACITY) % SNAPSHOT_RING_CAPACITY;
+    return &m_slots[index];
+}
+
+void SnapshotRing::DropNewest(int count) {
+    if (count <= 0) return;
+    if (count > m_count) count = m_count;
+    m_head = (m_head - count + SNAPSHOT_RING_CAPACITY) % SNAPSHOT_RING_CAPACITY;
+    m_count -= count;
+}
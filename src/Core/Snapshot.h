@@ -0,0 +1,69 @@
+#ifndef SNAPSHOT_H
+#define SNAPSHOT_H
+
+#include "SDL.h"
+#include "Random.h"
+#include "../Objects/Player.h"
+#include "../Obstacles/Obstacle.h"
+
+#define SNAPSHOT_RING_CAPACITY 256
+#define SNAPSHOT_MAX_OBSTACLES MAX_OBSTACLES
+#define SNAPSHOT_DEFAULT_INTERVAL 30
+
+struct ObstacleState {
+    SDL_Rect collider;
+    float x;
+    Uint8 textureIndex;
+    Uint8 hitMask;
+    Uint8 padding[2];
+};
+
+// Everything the simulation needs to continue from a given step. Plain data
+// only: timers are stored as the time left until they next fire and are
+// re-armed on restore, textures by index into the engine's obstacle list.
+struct GameSnapshot {
+    Uint32 runStep;
+    Uint64 gameMicros;
+    Pcg32 rng;
+
+    PlayerState players[MAX_RIDERS];
+    float riderDistance[MAX_RIDERS];
+    int riderCount;
+    ObstacleState obstacles[SNAPSHOT_MAX_OBSTACLES];
+    int obstacleCount;
+
+    int remainingSeconds;
+    float obstacleSpawnInterval;
+    float timeSinceLastSpawn;
+    int collisionCount;
+    int laneChangeCount;
+
+    Uint32 difficultyTimerMs;
+    Uint32 maxSpeedTimerMs;
+    Uint32 countdownTimerMs;
+};
+
+// FNV-1a over the simulation state, ignoring the run counters, which are
+// fed from dispatched events rather than by the simulation itself.
+Uint32 SnapshotChecksum(const GameSnapshot& snapshot);
+
+// Fixed ring of snapshots, newest last. Pushing when full overwrites the
+// oldest entry; every operation is constant time and never allocates.
+class SnapshotRing {
+public:
+    SnapshotRing() : m_head(0), m_count(0) {}
+
+    void Clear();
+    GameSnapshot* Push();
+    const GameSnapshot* Peek(int back) const;
+    void DropNewest(int count);
+
+    inline int GetCount() const { return m_count; }
+
+private:
+    GameSnapshot m_slots[SNAPSHOT_RING_CAPACITY];
+    int m_head;
+    int m_count;
+};
+
+#endif // SNAPSHOT_H
@@ -0,0 +1,176 @@
+#include "TimerWheel.h"
+
+TimerWheel::TimerWheel() : m_currentTime(0), m_activeCount(0) {
+    for (int level = 0; level < TIMER_WHEEL_LEVELS; ++level) {
+        for (int slot = 0; slot < TIMER_WHEEL_SLOTS; ++slot) {
+            m_slots[level][slot] = -1;
+        }
+    }
+}
+
+void TimerWheel::Reset(Uint32 now) {
+    CancelAll();
+    m_currentTime = now;
+}
+
+TimerId TimerWheel::Schedule(Uint32 delayMs, std::function<void()> callback) {
+    return Insert(delayMs, 0, std::move(callback));
+}
+
+TimerId TimerWheel::SchedulePeriodic(Uint32 intervalMs, std::function<void()> callback, Uint32 firstDelayMs) {
+    if (intervalMs == 0) {
+        SDL_Log("TimerWheel::SchedulePeriodic - Warning: zero interval, using 1 ms.");
+        intervalMs = 1;
+    }
+    return Insert(firstDelayMs > 0 ? firstDelayMs : intervalMs, intervalMs, std::move(callback));
+}
+
+TimerId TimerWheel::Insert(Uint32 delayMs, Uint32 intervalMs, std::function<void()> callback) {
+    int index;
+    if (!m_freeList.empty()) {
+        index = m_freeList.back();
+        m_freeList.pop_back();
+    } else {
+        index = static_cast<int>(m_timers.size());
+        m_timers.push_back(Timer());
+        m_timers[index].generation = 0;
+    }
+
+    Timer& timer = m_timers[index];
+    timer.expiry = m_currentTime + (delayMs > 0 ? delayMs : 1);
+    timer.interval = intervalMs;
+    timer.generation = static_cast<Uint16>(timer.generation + 1);
+    timer.active = true;
+    timer.callback = std::move(callback);
+    Link(index);
+    m_activeCount++;
+
+    return (static_cast<TimerId>(timer.generation) << 16) | static_cast<TimerId>(index + 1);
+}
+
+void TimerWheel::Cancel(TimerId id) {
+    int index = Resolve(id);
+    if (index >= 0) {
+        Unlink(index);
+        Release(index);
+    }
+}
+
+void TimerWheel::CancelAll() {
+    for (int index = 0; index < static_cast<int>(m_timers.size()); ++index) {
+        if (m_timers[index].active) {
+            Unlink(index);
+            Release(index);
+        }
+    }
+}
+
+bool TimerWheel::IsScheduled(TimerId id) const {
+    return Resolve(id) >= 0;
+}
+
+Uint32 TimerWheel::GetRemaining(TimerId id) const {
+    int index = Resolve(id);
+    if (index < 0) return 0;
+    return m_timers[index].expiry - m_currentTime;
+}
+
+void TimerWheel::Advance(Uint32 now) {
+    while (static_cast<Sint32>(now - m_currentTime) > 0) {
+        if (m_activeCount == 0) {
+            m_currentTime = now;
+            return;
+        }
+        m_currentTime++;
+
+        Uint32 t = m_currentTime;
+        if ((t & TIMER_WHEEL_SLOT_MASK) == 0) {
+            for (int level = 1; level < TIMER_WHEEL_LEVELS; ++level) {
+                int slot = (t >> (TIMER_WHEEL_SLOT_BITS * level)) & TIMER_WHEEL_SLOT_MASK;
+                Cascade(level, slot);
+                if (slot != 0) break;
+            }
+        }
+
+        int slot = t & TIMER_WHEEL_SLOT_MASK;
+        while (m_slots[0][slot] != -1) {
+            int index = m_slots[0][slot];
+            Unlink(index);
+            Timer& timer = m_timers[index];
+            if (timer.interval > 0) {
+                timer.expiry += timer.interval;
+                Link(index);
+                // Copy so the callback survives if it cancels its own timer.
+                std::function<void()> callback = timer.callback;
+                callback();
+            } else {
+                std::function<void()> callback = std::move(timer.callback);
+                Release(index);
+                callback();
+            }
+        }
+    }
+}
+
+void TimerWheel::Link(int index) {
+    Timer& timer = m_timers[index];
+    Uint32 delta = timer.expiry - m_currentTime;
+    int level = 0;
+    while (level < TIMER_WHEEL_LEVELS - 1 && delta >= (1u << (TIMER_WHEEL_SLOT_BITS * (level + 1)))) {
+        level++;
+    }
+    Uint32 when = timer.expiry;
+    if (level == TIMER_WHEEL_LEVELS - 1 && delta >= (1u << (TIMER_WHEEL_SLOT_BITS * TIMER_WHEEL_LEVELS))) {
+        // Beyond the wheel's range: park in the farthest slot and cascade again later.
+        when = m_currentTime + (1u << (TIMER_WHEEL_SLOT_BITS * TIMER_WHEEL_LEVELS)) - 1;
+    }
+    int slot = (when >> (TIMER_WHEEL_SLOT_BITS * level)) & TIMER_WHEEL_SLOT_MASK;
+
+    timer.level = level;
+    timer.slot = slot;
+    timer.prev = -1;
+    timer.next = m_slots[level][slot];
+    if (timer.next != -1) {
+        m_timers[timer.next].prev = index;
+    }
+    m_slots[level][slot] = index;
+}
+
+void TimerWheel::Unlink(int index) {
+    Timer& timer = m_timers[index];
+    if (timer.prev != -1) {
+        m_timers[timer.prev].next = timer.next;
+    } else {
+        m_slots[timer.level][timer.slot] = timer.next;
+    }
+    if (timer.next != -1) {
+        m_timers[timer.next].prev = timer.prev;
+    }
+    timer.prev = timer.next = -1;
+}
+
+void TimerWheel::Release(int index) {
+    Timer& timer = m_timers[index];
+    timer.active = false;
+    timer.callback = nullptr;
+    m_freeList.push_back(index);
+    m_activeCount--;
+}
+
+void TimerWheel::Cascade(int level, int slot) {
+    int index = m_slots[level][slot];
+    m_slots[level][slot] = -1;
+    while (index != -1) {
+        int next = m_timers[index].next;
+        Link(index);
+        index = next;
+    }
+}
+
+int TimerWheel::Resolve(TimerId id) const {
+    int index = static_cast<int>(id & 0xFFFF) - 1;
+    if (index < 0 || index >= static_cast<int>(m_timers.size())) return -1;
+    const Timer& timer = m_timers[index];
+    if (!timer.active || timer.generation != static_cast<Uint16>(id >> 16)) return -1;
+    return index;
+}
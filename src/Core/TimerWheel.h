@@ -0,0 +1,63 @@
+#ifndef TIMERWHEEL_H
+#define TIMERWHEEL_H
+
+#include <functional>
+#include <vector>
+#include "SDL.h"
+
+#define TIMER_WHEEL_LEVELS 4
+#define TIMER_WHEEL_SLOT_BITS 6
+#define TIMER_WHEEL_SLOTS (1 << TIMER_WHEEL_SLOT_BITS)
+#define TIMER_WHEEL_SLOT_MASK (TIMER_WHEEL_SLOTS - 1)
+
+typedef Uint32 TimerId;
+#define INVALID_TIMER_ID 0
+
+// Hierarchical timer wheel with 1 ms resolution. Four levels of 64 slots
+// cover about 4.6 hours; longer delays park in the last level and cascade
+// down again. Advance() only touches the slots that actually come due.
+class TimerWheel {
+public:
+    TimerWheel();
+
+    void Reset(Uint32 now);
+    TimerId Schedule(Uint32 delayMs, std::function<void()> callback);
+    // firstDelayMs = 0 means the first call comes one interval from now.
+    TimerId SchedulePeriodic(Uint32 intervalMs, std::function<void()> callback, Uint32 firstDelayMs = 0);
+    void Cancel(TimerId id);
+    void CancelAll();
+    void Advance(Uint32 now);
+
+    bool IsScheduled(TimerId id) const;
+    Uint32 GetRemaining(TimerId id) const;
+    inline Uint32 GetCurrentTime() const { return m_currentTime; }
+    inline int GetActiveCount() const { return m_activeCount; }
+
+private:
+    struct Timer {
+        Uint32 expiry;
+        Uint32 interval;
+        Uint16 generation;
+        bool active;
+        int level;
+        int slot;
+        int prev;
+        int next;
+        std::function<void()> callback;
+    };
+
+    TimerId Insert(Uint32 delayMs, Uint32 intervalMs, std::function<void()> callback);
+    void Link(int index);
+    void Unlink(int index);
+    void Release(int index);
+    void Cascade(int level, int slot);
+    int Resolve(TimerId id) const;
+
+    std::vector<Timer> m_timers;
+    std::vector<int> m_freeList;
+    int m_slots[TIMER_WHEEL_LEVELS][TIMER_WHEEL_SLOTS];
+    Uint32 m_currentTime;
+    int m_activeCount;
+};
+
+#endif // TIMERWHEEL_H
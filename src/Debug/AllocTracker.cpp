@@ -0,0 +1,257 @@
+#include <atomic>
+#include <cstdlib>
+#include <cstring>
+#include <new>
+#ifdef _WIN32
+#include <windows.h>
+#elif defined(__GLIBC__)
+#include <execinfo.h>
+#endif
+#include "AllocTracker.h"
+#include "../Core/Engine.h"
+
+#define ALLOC_LOG_FAILURES 10
+
+AllocTracker* AllocTracker::s_Instance = nullptr;
+
+// Hook state lives in plain statics rather than in the singleton: operator
+// new runs before main() and must never allocate or construct anything.
+static std::atomic<Uint64> s_totalAllocs(0);
+static std::atomic<Uint64> s_totalFrees(0);
+static std::atomic<Uint64> s_totalBytes(0);
+static thread_local bool t_isGameThread = false;
+static thread_local bool t_inHook = false;
+
+static Uint32 s_frameAllocs = 0;
+static Uint32 s_frameFrees = 0;
+static Uint64 s_frameBytes = 0;
+static int s_budget = ALLOC_NO_BUDGET;
+static int s_budgetState = -1;
+static bool s_captureStacks = false;
+static int s_zone = -1;
+static int s_zoneCount = 0;
+static AllocZoneStats s_zones[ALLOC_MAX_ZONES];
+static int s_stackCount = 0;
+static AllocStack s_stacks[ALLOC_MAX_STACKS];
+
+static const char* s_stateNames[ALLOC_MAX_STATES] = {
+    "menu", "start", "playing", "gameover", "about", "win", "paused", nullptr
+};
+
+static void CaptureStack(Uint32 size) {
+    AllocStack& stack = s_stacks[s_stackCount++];
+    stack.state = s_budgetState;
+    stack.zone = s_zone;
+    stack.size = size;
+#ifdef _WIN32
+    stack.depth = CaptureStackBackTrace(2, ALLOC_STACK_DEPTH, stack.frames, NULL);
+#elif defined(__GLIBC__)
+    stack.depth = backtrace(stack.frames, ALLOC_STACK_DEPTH);
+#else
+    stack.depth = 0;
+#endif
+}
+
+static void OnAllocate(std::size_t size) {
+    s_totalAllocs.fetch_add(1, std::memory_order_relaxed);
+    s_totalBytes.fetch_add(size, std::memory_order_relaxed);
+    if (!t_isGameThread || t_inHook) return;
+    s_frameAllocs++;
+    s_frameBytes += size;
+    if (s_zone >= 0) {
+        s_zones[s_zone].frameAllocs++;
+        s_zones[s_zone].allocs++;
+        s_zones[s_zone].bytes += size;
+    }
+    if (s_captureStacks && s_budget != ALLOC_NO_BUDGET && s_frameAllocs > static_cast<Uint32>(s_budget) &&
+        s_stackCount < ALLOC_MAX_STACKS) {
+        // Unwinding may allocate itself (e.g. loading the unwinder).
+        t_inHook = true;
+        CaptureStack(static_cast<Uint32>(size));
+        t_inHook = false;
+    }
+}
+
+static void OnFree() {
+    s_totalFrees.fetch_add(1, std::memory_order_relaxed);
+    if (t_isGameThread && !t_inHook) s_frameFrees++;
+}
+
+#ifdef ALLOC_TRACKING
+void* operator new(std::size_t size) {
+    void* p = std::malloc(size ? size : 1);
+    if (p == nullptr) throw std::bad_alloc();
+    OnAllocate(size);
+    return p;
+}
+
+void* operator new[](std::size_t size) {
+    return operator new(size);
+}
+
+void* operator new(std::size_t size, const std::nothrow_t&) noexcept {
+    void* p = std::malloc(size ? size : 1);
+    if (p != nullptr) OnAllocate(size);
+    return p;
+}
+
+void* operator new[](std::size_t size, const std::nothrow_t& tag) noexcept {
+    return operator new(size, tag);
+}
+
+void operator delete(void* p) noexcept {
+    if (p == nullptr) return;
+    OnFree();
+    std::free(p);
+}
+
+void operator delete[](void* p) noexcept { operator delete(p); }
+void operator delete(void* p, std::size_t) noexcept { operator delete(p); }
+void operator delete[](void* p, std::size_t) noexcept { operator delete(p); }
+void operator delete(void* p, const std::nothrow_t&) noexcept { operator delete(p); }
+void operator delete[](void* p, const std::nothrow_t&) noexcept { operator delete(p); }
+#endif
+
+bool AllocTracker::IsCompiledIn() {
+#ifdef ALLOC_TRACKING
+    return true;
+#else
+    return false;
+#endif
+}
+
+AllocTracker::AllocTracker()
+    : m_state(-1), m_framesInState(0), m_frames(0), m_failedFrames(0), m_maxFrameAllocs(0), m_bytesPerFrameMax(0) {
+    for (int i = 0; i < ALLOC_MAX_STATES; ++i) m_budgets[i] = ALLOC_NO_BUDGET;
+}
+
+void AllocTracker::Init() {
+    t_isGameThread = true;
+    s_frameAllocs = 0;
+    s_frameFrees = 0;
+    s_frameBytes = 0;
+    if (!IsCompiledIn()) return;
+    SDL_Log("AllocTracker: counting allocations on the game thread.");
+}
+
+void AllocTracker::SetBudget(int state, int maxAllocs) {
+    if (state < 0 || state >= ALLOC_MAX_STATES) return;
+    if (!IsCompiledIn()) {
+        SDL_Log("AllocTracker - Warning: allocation budgets need a build with ALLOC_TRACKING defined.");
+    }
+    m_budgets[state] = maxAllocs;
+}
+
+bool AllocTracker::ParseBudget(const char* spec) {
+    const char* equals = std::strchr(spec, '=');
+    if (equals == nullptr) {
+        SDL_Log("AllocTracker::ParseBudget - Error: expected <state>=<allocs>, got '%s'.", spec);
+        return false;
+    }
+    size_t length = static_cast<size_t>(equals - spec);
+    for (int i = 0; i < ALLOC_MAX_STATES && s_stateNames[i] != nullptr; ++i) {
+        if (std::strlen(s_stateNames[i]) == length && std::strncmp(spec, s_stateNames[i], length) == 0) {
+            SetBudget(i, std::atoi(equals + 1));
+            return true;
+        }
+    }
+    SDL_Log("AllocTracker::ParseBudget - Error: unknown state in '%s'.", spec);
+    return false;
+}
+
+void AllocTracker::SetCaptureStacks(bool capture) {
+    s_captureStacks = capture;
+}
+
+int AllocTracker::PushZone(const char* name) {
+    int previous = s_zone;
+    if (!t_isGameThread) return previous;
+    int index = -1;
+    for (int i = 0; i < s_zoneCount; ++i) {
+        if (s_zones[i].name == name) index = i;
+    }
+    if (index < 0 && s_zoneCount < ALLOC_MAX_ZONES) {
+        index = s_zoneCount++;
+        std::memset(&s_zones[index], 0, sizeof(s_zones[index]));
+        s_zones[index].name = name;
+    }
+    if (index >= 0) s_zone = index;
+    return previous;
+}
+
+void AllocTracker::PopZone(int previous) {
+    if (t_isGameThread) s_zone = previous;
+}
+
+void AllocTracker::EndFrame(int state) {
+    if (!IsCompiledIn()) return;
+    m_frames++;
+    Uint32 allocs = s_frameAllocs;
+    if (allocs > m_maxFrameAllocs) m_maxFrameAllocs = allocs;
+    if (s_frameBytes > m_bytesPerFrameMax) m_bytesPerFrameMax = s_frameBytes;
+
+    // A frame that changed state is never held to either state's budget.
+    if (state == m_state && s_budget != ALLOC_NO_BUDGET && allocs > static_cast<Uint32>(s_budget)) {
+        m_failedFrames++;
+        if (m_failedFrames <= ALLOC_LOG_FAILURES) {
+            SDL_Log("AllocTracker: frame %u in state '%s' made %u allocations (%llu bytes), budget %d.",
+                    m_frames, s_stateNames[state], allocs, static_cast<unsigned long long>(s_frameBytes), s_budget);
+            for (int i = 0; i < s_zoneCount; ++i) {
+                if (s_zones[i].frameAllocs > 0) SDL_Log("  zone %-12s %u", s_zones[i].name, s_zones[i].frameAllocs);
+            }
+        }
+    }
+
+    for (int i = 0; i < s_zoneCount; ++i) {
+        if (s_zones[i].frameAllocs > s_zones[i].maxFrameAllocs) s_zones[i].maxFrameAllocs = s_zones[i].frameAllocs;
+        s_zones[i].frameAllocs = 0;
+    }
+    s_frameAllocs = 0;
+    s_frameFrees = 0;
+    s_frameBytes = 0;
+
+    if (state != m_state) {
+        m_state = state;
+        m_framesInState = 0;
+    }
+    m_framesInState++;
+    bool budgeted = state >= 0 && state < ALLOC_MAX_STATES && m_framesInState > ALLOC_BUDGET_GRACE_FRAMES;
+    s_budget = budgeted ? m_budgets[state] : ALLOC_NO_BUDGET;
+    s_budgetState = state;
+}
+
+void AllocTracker::Report() const {
+    if (!IsCompiledIn()) return;
+    SDL_Log("AllocTracker: %llu allocations (%llu bytes), %llu frees over %u frames; max %u allocations, %llu bytes in a frame.",
+            static_cast<unsigned long long>(s_totalAllocs.load()), static_cast<unsigned long long>(s_totalBytes.load()),
+            static_cast<unsigned long long>(s_totalFrees.load()), m_frames, m_maxFrameAllocs,
+            static_cast<unsigned long long>(m_bytesPerFrameMax));
+    for (int i = 0; i < s_zoneCount; ++i) {
+        SDL_Log("  zone %-12s allocs %10llu  bytes %12llu  max/frame %u", s_zones[i].name,
+                static_cast<unsigned long long>(s_zones[i].allocs), static_cast<unsigned long long>(s_zones[i].bytes),
+                s_zones[i].maxFrameAllocs);
+    }
+    if (m_failedFrames > 0) {
+        SDL_Log("AllocTracker: %u frames over budget.", m_failedFrames);
+    }
+
+    t_inHook = true;
+    for (int i = 0; i < s_stackCount; ++i) {
+        const AllocStack& stack = s_stacks[i];
+        SDL_Log("  over-budget allocation of %u bytes in state '%s', zone %s:", stack.size,
+                stack.state >= 0 ? s_stateNames[stack.state] : "?", stack.zone >= 0 ? s_zones[stack.zone].name : "-");
+#if defined(__GLIBC__) && !defined(_WIN32)
+        char** symbols = backtrace_symbols(stack.frames, stack.depth);
+        for (int f = 0; f < stack.depth; ++f) {
+            SDL_Log("    %s", symbols ? symbols[f] : "?");
+        }
+        std::free(symbols);
+#else
+        // Resolve with addr2line -e <exe> <address>.
+        for (int f = 0; f < stack.depth; ++f) {
+            SDL_Log("    %p", stack.frames[f]);
+        }
+#endif
+    }
+    t_inHook = false;
+}
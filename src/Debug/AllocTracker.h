@@ -0,0 +1,89 @@
+#ifndef ALLOCTRACKER_H
+#define ALLOCTRACKER_H
+
+#include "SDL.h"
+
+#define ALLOC_MAX_ZONES 32
+#define ALLOC_MAX_STATES 8
+#define ALLOC_NO_BUDGET -1
+#define ALLOC_BUDGET_GRACE_FRAMES 30
+#define ALLOC_MAX_STACKS 8
+#define ALLOC_STACK_DEPTH 16
+
+struct AllocZoneStats {
+    const char* name;
+    Uint64 allocs;
+    Uint64 bytes;
+    Uint32 maxFrameAllocs;
+    Uint32 frameAllocs;
+};
+
+struct AllocStack {
+    int state;
+    int zone;
+    Uint32 size;
+    int depth;
+    void* frames[ALLOC_STACK_DEPTH];
+};
+
+// Counts global operator new/delete calls made on the game thread, per frame
+// and per zone. The hooks are only compiled into builds with ALLOC_TRACKING
+// defined (the AllocTrack target); elsewhere nothing is counted and zones
+// compile away. A budget caps the allocations per frame in a game state;
+// frames over budget are logged, optionally with the call stacks of the
+// offending allocations, and make HasExceededBudget() true so benchmark runs
+// can fail on them. The first ALLOC_BUDGET_GRACE_FRAMES frames after a state
+// change are exempt, as entering a state may legitimately allocate.
+class AllocTracker {
+public:
+    static AllocTracker* GetInstance() {
+        return s_Instance = (s_Instance != nullptr) ? s_Instance : new AllocTracker();
+    }
+
+    static bool IsCompiledIn();
+
+    // Must be called from the game thread; only its allocations are counted
+    // per frame, other threads only in the totals.
+    void Init();
+    void SetBudget(int state, int maxAllocs);
+    bool ParseBudget(const char* spec);
+    void SetCaptureStacks(bool capture);
+
+    void EndFrame(int state);
+    void Report() const;
+    inline bool HasExceededBudget() const { return m_failedFrames > 0; }
+
+    int PushZone(const char* name);
+    void PopZone(int previous);
+
+private:
+    AllocTracker();
+    static AllocTracker* s_Instance;
+
+    int m_budgets[ALLOC_MAX_STATES];
+    int m_state;
+    Uint32 m_framesInState;
+    Uint32 m_frames;
+    Uint32 m_failedFrames;
+    Uint32 m_maxFrameAllocs;
+    Uint64 m_bytesPerFrameMax;
+};
+
+// Attributes the allocations of the enclosing scope to a named zone. The
+// name must be a string literal; zones are told apart by pointer.
+class AllocZone {
+public:
+    explicit AllocZone(const char* name) : m_previous(AllocTracker::GetInstance()->PushZone(name)) {}
+    ~AllocZone() { AllocTracker::GetInstance()->PopZone(m_previous); }
+
+private:
+    int m_previous;
+};
+
+#ifdef ALLOC_TRACKING
+#define ALLOC_ZONE(name) AllocZone allocZone(name)
+#else
+#define ALLOC_ZONE(name)
+#endif
+
+#endif // ALLOCTRACKER_H
@@ -0,0 +1,212 @@
+#include "FrameCapture.h"
+#include "../Graphics/RenderStats.h"
+#include "SDL_image.h"
+
+FrameCapture* FrameCapture::s_Instance = nullptr;
+
+void FrameCapture::AddOutput(FrameCaptureOutput output, const char* path) {
+    m_outputs |= output;
+    switch (output) {
+        case CAPTURE_OUTPUT_RAW: m_rawPath = path; break;
+        case CAPTURE_OUTPUT_PNG: m_pngDir = path; break;
+        case CAPTURE_OUTPUT_CHECKSUM: m_checksumPath = path; break;
+        default: break;
+    }
+}
+
+void FrameCapture::SetGolden(const char* directory) {
+    m_goldenDir = directory;
+}
+
+void FrameCapture::SetInterval(int interval) {
+    m_interval = interval > 0 ? interval : 1;
+}
+
+void FrameCapture::SetSink(FrameSink sink, void* userData) {
+    m_sink = sink;
+    m_sinkData = userData;
+}
+
+bool FrameCapture::Init(SDL_Renderer* renderer, int width, int height) {
+    if (!IsEnabled()) return true;
+
+    m_width = width;
+    m_height = height;
+    for (int i = 0; i < FRAME_CAPTURE_PIPELINE_DEPTH; ++i) {
+        m_targets[i] = SDL_CreateTexture(renderer, SDL_PIXELFORMAT_RGBA8888, SDL_TEXTUREACCESS_TARGET, width, height);
+        if (m_targets[i] == nullptr) {
+            SDL_Log("FrameCapture::Init - Error: cannot create capture target: %s", SDL_GetError());
+            Clean();
+            return false;
+        }
+    }
+    m_pixels.resize(static_cast<size_t>(width) * height * 4);
+
+    if ((m_outputs & CAPTURE_OUTPUT_RAW) && (m_rawFile = fopen(m_rawPath.c_str(), "wb")) == nullptr) {
+        SDL_Log("FrameCapture::Init - Error: cannot open '%s' for raw frames.", m_rawPath.c_str());
+    }
+    if ((m_outputs & CAPTURE_OUTPUT_CHECKSUM) && (m_checksumFile = fopen(m_checksumPath.c_str(), "w")) == nullptr) {
+        SDL_Log("FrameCapture::Init - Error: cannot open '%s' for checksums.", m_checksumPath.c_str());
+    }
+
+    m_frameIndex = 0;
+    m_inFlight = 0;
+    m_active = true;
+    SDL_Log("FrameCapture: capturing %dx%d RGBA frames, pipeline depth %d.", width, height, FRAME_CAPTURE_PIPELINE_DEPTH);
+    return true;
+}
+
+void FrameCapture::BeginFrame(SDL_Renderer* renderer) {
+    if (!m_active) return;
+    m_previousTarget = SDL_GetRenderTarget(renderer);
+    RenderStats::GetInstance()->SetTarget(renderer, m_targets[m_frameIndex % FRAME_CAPTURE_PIPELINE_DEPTH]);
+}
+
+void FrameCapture::EndFrame(SDL_Renderer* renderer) {
+    if (!m_active) return;
+    SDL_Texture* target = m_targets[m_frameIndex % FRAME_CAPTURE_PIPELINE_DEPTH];
+    RenderStats::GetInstance()->SetTarget(renderer, m_previousTarget);
+    RenderStats::GetInstance()->Copy(renderer, target, NULL, NULL);
+
+    m_inFlight++;
+    if (m_inFlight == FRAME_CAPTURE_PIPELINE_DEPTH) {
+        // The oldest target is about to be reused next frame; read it now.
+        ReadBack(renderer, m_frameIndex - (FRAME_CAPTURE_PIPELINE_DEPTH - 1));
+        m_inFlight--;
+    }
+    m_frameIndex++;
+}
+
+void FrameCapture::Flush(SDL_Renderer* renderer) {
+    if (!m_active) return;
+    while (m_inFlight > 0) {
+        ReadBack(renderer, m_frameIndex - m_inFlight);
+        m_inFlight--;
+    }
+}
+
+void FrameCapture::ReadBack(SDL_Renderer* renderer, Uint32 frameIndex) {
+    if (frameIndex % m_interval != 0) return;
+
+    Uint64 start = SDL_GetPerformanceCounter();
+    SDL_Texture* previous = SDL_GetRenderTarget(renderer);
+    RenderStats::GetInstance()->SetTarget(renderer, m_targets[frameIndex % FRAME_CAPTURE_PIPELINE_DEPTH]);
+    int result = SDL_RenderReadPixels(renderer, NULL, SDL_PIXELFORMAT_RGBA32, m_pixels.data(), m_width * 4);
+    RenderStats::GetInstance()->SetTarget(renderer, previous);
+    m_readbackTicks += SDL_GetPerformanceCounter() - start;
+
+    if (result != 0) {
+        SDL_Log("FrameCapture::ReadBack - Error on frame %u: %s", frameIndex, SDL_GetError());
+        return;
+    }
+    Deliver(frameIndex);
+}
+
+void FrameCapture::Deliver(Uint32 frameIndex) {
+    m_captured++;
+    int pitch = m_width * 4;
+
+    if (m_rawFile) {
+        fwrite(m_pixels.data(), 1, m_pixels.size(), m_rawFile);
+    }
+    if (m_outputs & CAPTURE_OUTPUT_PNG) {
+        char path[512];
+        SDL_snprintf(path, sizeof(path), "%s/frame_%05u.png", m_pngDir.c_str(), frameIndex);
+        SDL_Surface* surface = SDL_CreateRGBSurfaceWithFormatFrom(m_pixels.data(), m_width, m_height, 32, pitch, SDL_PIXELFORMAT_RGBA32);
+        if (surface == nullptr || IMG_SavePNG(surface, path) != 0) {
+            SDL_Log("FrameCapture - Error: cannot write '%s': %s", path, SDL_GetError());
+        }
+        SDL_FreeSurface(surface);
+    }
+    if (m_checksumFile) {
+        // 64-bit FNV-1a over the whole frame.
+        Uint64 hash = 14695981039346656037ULL;
+        for (Uint8 byte : m_pixels) {
+            hash = (hash ^ byte) * 1099511628211ULL;
+        }
+        fprintf(m_checksumFile, "%05u %016llx\n", frameIndex, static_cast<unsigned long long>(hash));
+    }
+    if (!m_goldenDir.empty()) {
+        CompareGolden(frameIndex);
+    }
+    if (m_sink) {
+        m_sink(m_pixels.data(), pitch, m_width, m_height, frameIndex, m_sinkData);
+    }
+}
+
+void FrameCapture::CompareGolden(Uint32 frameIndex) {
+    char path[512];
+    SDL_snprintf(path, sizeof(path), "%s/frame_%05u.png", m_goldenDir.c_str(), frameIndex);
+    SDL_Surface* loaded = IMG_Load(path);
+    if (loaded == nullptr) return;  // Only frames with a golden image are checked.
+
+    SDL_Surface* golden = SDL_ConvertSurfaceFormat(loaded, SDL_PIXELFORMAT_RGBA32, 0);
+    SDL_FreeSurface(loaded);
+    if (golden == nullptr) {
+        SDL_Log("FrameCapture - Error: cannot convert golden '%s': %s", path, SDL_GetError());
+        m_goldenFailures++;
+        return;
+    }
+    m_goldenCompared++;
+
+    if (golden->w != m_width || golden->h != m_height) {
+        SDL_Log("FrameCapture: golden frame %u is %dx%d, expected %dx%d.", frameIndex, golden->w, golden->h, m_width, m_height);
+        m_goldenFailures++;
+        SDL_FreeSurface(golden);
+        return;
+    }
+
+    int badPixels = 0;
+    for (int y = 0; y < m_height; ++y) {
+        const Uint8* expected = static_cast<const Uint8*>(golden->pixels) + y * golden->pitch;
+        const Uint8* actual = m_pixels.data() + y * m_width * 4;
+        for (int x = 0; x < m_width * 4; x += 4) {
+            for (int c = 0; c < 4; ++c) {
+                int diff = expected[x + c] - actual[x + c];
+                if (diff > FRAME_CAPTURE_GOLDEN_TOLERANCE || diff < -FRAME_CAPTURE_GOLDEN_TOLERANCE) {
+                    badPixels++;
+                    break;
+                }
+            }
+        }
+    }
+    SDL_FreeSurface(golden);
+
+    int allowed = m_width * m_height * FRAME_CAPTURE_GOLDEN_MAX_BAD_PERMILLE / 1000;
+    if (badPixels > allowed) {
+        SDL_Log("FrameCapture: frame %u differs from golden in %d pixels (allowed %d).", frameIndex, badPixels, allowed);
+        m_goldenFailures++;
+    }
+}
+
+void FrameCapture::Clean() {
+    for (int i = 0; i < FRAME_CAPTURE_PIPELINE_DEPTH; ++i) {
+        if (m_targets[i]) {
+            SDL_DestroyTexture(m_targets[i]);
+            m_targets[i] = nullptr;
+        }
+    }
+    if (m_rawFile) {
+        fclose(m_rawFile);
+        m_rawFile = nullptr;
+    }
+    if (m_checksumFile) {
+        fclose(m_checksumFile);
+        m_checksumFile = nullptr;
+    }
+    m_active = false;
+}
+
+void FrameCapture::Report() const {
+    if (m_captured > 0) {
+        double readbackMs = m_readbackTicks * 1000.0 / SDL_GetPerformanceFrequency() / m_captured;
+        SDL_Log("FrameCapture: %u frames captured, %.3f ms average readback.", m_captured, readbackMs);
+    }
+    if (!m_goldenDir.empty()) {
+        SDL_Log("FrameCapture: %u frames compared against golden images in '%s', %d failed.", m_goldenCompared,
+                m_goldenDir.c_str(), m_goldenFailures);
+        if (m_goldenCompared == 0) {
+            SDL_Log("FrameCapture - Error: no golden images matched the captured frames.");
+        }
+    }
+}
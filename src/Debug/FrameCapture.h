@@ -0,0 +1,91 @@
+#ifndef FRAMECAPTURE_H
+#define FRAMECAPTURE_H
+
+#include <cstdio>
+#include <string>
+#include <vector>
+#include "SDL.h"
+
+#define FRAME_CAPTURE_PIPELINE_DEPTH 3
+#define FRAME_CAPTURE_GOLDEN_TOLERANCE 2
+#define FRAME_CAPTURE_GOLDEN_MAX_BAD_PERMILLE 1
+
+enum FrameCaptureOutput {
+    CAPTURE_OUTPUT_NONE = 0,
+    CAPTURE_OUTPUT_RAW = 1 << 0,
+    CAPTURE_OUTPUT_PNG = 1 << 1,
+    CAPTURE_OUTPUT_CHECKSUM = 1 << 2
+};
+
+typedef void (*FrameSink)(const Uint8* pixels, int pitch, int width, int height, Uint32 frameIndex, void* userData);
+
+// Captures rendered frames without stalling on the one just submitted.
+// Each frame is drawn into one of FRAME_CAPTURE_PIPELINE_DEPTH target
+// textures and copied to the real backbuffer; the target written
+// DEPTH - 1 frames earlier is read back with SDL_RenderReadPixels, so the
+// renderer has had time to finish it. Read-back frames (RGBA32) go to a raw
+// file, numbered PNGs, a checksum list, the golden comparison and/or a sink.
+class FrameCapture {
+public:
+    static FrameCapture* GetInstance() {
+        return s_Instance = (s_Instance != nullptr) ? s_Instance : new FrameCapture();
+    }
+
+    void AddOutput(FrameCaptureOutput output, const char* path);
+    void SetGolden(const char* directory);
+    void SetInterval(int interval);
+    void SetSink(FrameSink sink, void* userData);
+
+    bool Init(SDL_Renderer* renderer, int width, int height);
+    void BeginFrame(SDL_Renderer* renderer);
+    void EndFrame(SDL_Renderer* renderer);
+    void Flush(SDL_Renderer* renderer);
+    void Clean();
+    void Report() const;
+
+    inline bool IsEnabled() const { return m_outputs != CAPTURE_OUTPUT_NONE || !m_goldenDir.empty() || m_sink != nullptr; }
+    // A golden run that compared nothing is a failure, not a pass.
+    inline bool HasGoldenFailed() const {
+        return m_goldenFailures > 0 || (!m_goldenDir.empty() && m_goldenCompared == 0);
+    }
+
+private:
+    FrameCapture() : m_outputs(CAPTURE_OUTPUT_NONE), m_interval(1), m_sink(nullptr), m_sinkData(nullptr),
+        m_width(0), m_height(0), m_previousTarget(nullptr), m_frameIndex(0), m_inFlight(0), m_active(false),
+        m_rawFile(nullptr), m_checksumFile(nullptr), m_captured(0), m_goldenCompared(0), m_goldenFailures(0),
+        m_readbackTicks(0) {
+        for (int i = 0; i < FRAME_CAPTURE_PIPELINE_DEPTH; ++i) m_targets[i] = nullptr;
+    }
+    static FrameCapture* s_Instance;
+
+    void ReadBack(SDL_Renderer* renderer, Uint32 frameIndex);
+    void Deliver(Uint32 frameIndex);
+    void CompareGolden(Uint32 frameIndex);
+
+    Uint32 m_outputs;
+    std::string m_rawPath;
+    std::string m_pngDir;
+    std::string m_checksumPath;
+    std::string m_goldenDir;
+    int m_interval;
+    FrameSink m_sink;
+    void* m_sinkData;
+
+    int m_width;
+    int m_height;
+    SDL_Texture* m_targets[FRAME_CAPTURE_PIPELINE_DEPTH];
+    SDL_Texture* m_previousTarget;
+    Uint32 m_frameIndex;
+    int m_inFlight;
+    bool m_active;
+    std::vector<Uint8> m_pixels;
+
+    FILE* m_rawFile;
+    FILE* m_checksumFile;
+    Uint32 m_captured;
+    Uint32 m_goldenCompared;
+    int m_goldenFailures;
+    Uint64 m_readbackTicks;
+};
+
+#endif // FRAMECAPTURE_H
@@ -0,0 +1,69 @@
+#include "Histogram.h"
+
+void Histogram::Reset() {
+    for (int i = 0; i < HISTOGRAM_BUCKETS; ++i) m_counts[i].store(0, std::memory_order_relaxed);
+    m_max.store(0, std::memory_order_relaxed);
+    m_sum.store(0, std::memory_order_relaxed);
+}
+
+int Histogram::GetBucket(Uint32 value) {
+    if (value < HISTOGRAM_LINEAR_BUCKETS) return static_cast<int>(value);
+    int msb = 31;
+    while ((value >> msb) == 0) msb--;
+    int shift = msb - HISTOGRAM_SUB_BITS;
+    int sub = static_cast<int>(value >> shift) - HISTOGRAM_SUB_BUCKETS;
+    return HISTOGRAM_LINEAR_BUCKETS + (shift - 1) * HISTOGRAM_SUB_BUCKETS + sub;
+}
+
+Uint32 Histogram::GetBucketHigh(int bucket) {
+    if (bucket < HISTOGRAM_LINEAR_BUCKETS) return static_cast<Uint32>(bucket);
+    int shift = (bucket - HISTOGRAM_LINEAR_BUCKETS) / HISTOGRAM_SUB_BUCKETS + 1;
+    Uint64 sub = (bucket - HISTOGRAM_LINEAR_BUCKETS) % HISTOGRAM_SUB_BUCKETS + HISTOGRAM_SUB_BUCKETS;
+    return static_cast<Uint32>(((sub + 1) << shift) - 1);
+}
+
+void Histogram::Record(Uint32 value) {
+    m_counts[GetBucket(value)].fetch_add(1, std::memory_order_relaxed);
+    m_sum.fetch_add(value, std::memory_order_relaxed);
+    Uint32 max = m_max.load(std::memory_order_relaxed);
+    while (value > max && !m_max.compare_exchange_weak(max, value, std::memory_order_relaxed)) {
+    }
+}
+
+Uint64 Histogram::GetCount() const {
+    Uint64 count = 0;
+    for (int i = 0; i < HISTOGRAM_BUCKETS; ++i) count += m_counts[i].load(std::memory_order_relaxed);
+    return count;
+}
+
+double Histogram::GetMean() const {
+    Uint64 count = GetCount();
+    return count > 0 ? static_cast<double>(m_sum.load(std::memory_order_relaxed)) / count : 0.0;
+}
+
+Uint32 Histogram::GetPercentile(double percentile) const {
+    Uint64 count = GetCount();
+    if (count == 0) return 0;
+    Uint64 rank = static_cast<Uint64>(percentile / 100.0 * count + 0.5);
+    if (rank < 1) rank = 1;
+    Uint64 seen = 0;
+    for (int i = 0; i < HISTOGRAM_BUCKETS; ++i) {
+        seen += m_counts[i].load(std::memory_order_relaxed);
+        if (seen >= rank) {
+            Uint32 high = GetBucketHigh(i);
+            return high < GetMax() ? high : GetMax();
+        }
+    }
+    return GetMax();
+}
+
+void Histogram::Add(const Histogram& other) {
+    for (int i = 0; i < HISTOGRAM_BUCKETS; ++i) {
+        m_counts[i].fetch_add(other.m_counts[i].load(std::memory_order_relaxed), std::memory_order_relaxed);
+    }
+    m_sum.fetch_add(other.m_sum.load(std::memory_order_relaxed), std::memory_order_relaxed);
+    Uint32 otherMax = other.GetMax();
+    Uint32 max = m_max.load(std::memory_order_relaxed);
+    while (otherMax > max && !m_max.compare_exchange_weak(max, otherMax, std::memory_order_relaxed)) {
+    }
+}
@@ -0,0 +1,41 @@
+#ifndef HISTOGRAM_H
+#define HISTOGRAM_H
+
+#include <atomic>
+#include "SDL.h"
+
+// 32 linear buckets below 32, then 16 sub-buckets per power of two: every
+// value is kept to within 1/16 (6.25%) up to 2^32.
+#define HISTOGRAM_LINEAR_BUCKETS 32
+#define HISTOGRAM_SUB_BUCKETS 16
+#define HISTOGRAM_SUB_BITS 4
+#define HISTOGRAM_BUCKETS (HISTOGRAM_LINEAR_BUCKETS + 27 * HISTOGRAM_SUB_BUCKETS)
+
+// Log-bucketed histogram of unsigned values (microseconds in practice) in
+// the style of HdrHistogram. Memory is fixed and Record() is a handful of
+// relaxed atomic operations, so any thread may record while another reads.
+class Histogram {
+public:
+    Histogram() { Reset(); }
+
+    void Reset();
+    void Record(Uint32 value);
+
+    Uint64 GetCount() const;
+    inline Uint32 GetMax() const { return m_max.load(std::memory_order_relaxed); }
+    double GetMean() const;
+    // Highest value equivalent to the given percentile (0-100).
+    Uint32 GetPercentile(double percentile) const;
+
+    void Add(const Histogram& other);
+
+private:
+    static int GetBucket(Uint32 value);
+    static Uint32 GetBucketHigh(int bucket);
+
+    std::atomic<Uint32> m_counts[HISTOGRAM_BUCKETS];
+    std::atomic<Uint32> m_max;
+    std::atomic<Uint64> m_sum;
+};
+
+#endif // HISTOGRAM_H
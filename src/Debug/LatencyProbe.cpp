@@ -0,0 +1,146 @@
+#include "LatencyProbe.h"
+#include "../Core/Engine.h"
+#include <algorithm>
+
+LatencyProbe* LatencyProbe::s_Instance = nullptr;
+
+void LatencyProbe::Enable() {
+    m_enabled = true;
+    m_samples.reserve(LATENCY_PROBE_MAX_SAMPLES);
+    SDL_Log("Latency probe enabled.");
+}
+
+void LatencyProbe::EnableBench(int sampleTarget) {
+    Enable();
+    m_benchMode = true;
+    m_benchSampleTarget = std::max(1, std::min(sampleTarget, LATENCY_PROBE_MAX_SAMPLES));
+    m_nextInjectTicks = SDL_GetTicks();
+    SDL_Log("Latency bench: collecting %d synthetic input samples.", m_benchSampleTarget);
+}
+
+void LatencyProbe::OnInputApplied(const InputActionEvent& event) {
+    if (!m_enabled) return;
+    bool tracked = event.action == ACTION_LANE_UP || event.action == ACTION_LANE_DOWN ||
+                   (event.action == ACTION_BRAKE && event.pressed);
+    if (!tracked || m_inFlightCount >= LATENCY_PROBE_MAX_IN_FLIGHT) return;
+
+    Sample& sample = m_inFlight[m_inFlightCount++];
+    sample.input = event.counter;
+    sample.applied = SDL_GetPerformanceCounter();
+    sample.recorded = 0;
+    sample.presented = 0;
+    sample.isRecorded = false;
+}
+
+void LatencyProbe::OnFrameRecorded() {
+    if (!m_enabled || m_inFlightCount == 0) return;
+    Uint64 now = SDL_GetPerformanceCounter();
+    for (int i = 0; i < m_inFlightCount; ++i) {
+        if (!m_inFlight[i].isRecorded) {
+            m_inFlight[i].recorded = now;
+            m_inFlight[i].isRecorded = true;
+        }
+    }
+}
+
+void LatencyProbe::OnFramePresented() {
+    if (!m_enabled || m_inFlightCount == 0) return;
+    Uint64 now = SDL_GetPerformanceCounter();
+    int remaining = 0;
+    for (int i = 0; i < m_inFlightCount; ++i) {
+        Sample& sample = m_inFlight[i];
+        if (!sample.isRecorded) {
+            m_inFlight[remaining++] = sample;
+            continue;
+        }
+        sample.presented = now;
+        if (static_cast<int>(m_samples.size()) < LATENCY_PROBE_MAX_SAMPLES) {
+            m_samples.push_back(sample);
+        }
+    }
+    m_inFlightCount = remaining;
+
+    if (m_benchMode && static_cast<int>(m_samples.size()) >= m_benchSampleTarget) {
+        m_benchMode = false;
+        Engine::GetInstance()->Quit();
+    }
+}
+
+void LatencyProbe::UpdateBench() {
+    if (!m_benchMode) return;
+
+    if (m_keyHeld != SDL_SCANCODE_UNKNOWN) {
+        InjectKey(m_keyHeld, SDL_GetKeyFromScancode(m_keyHeld), false);
+        m_keyHeld = SDL_SCANCODE_UNKNOWN;
+        return;
+    }
+
+    Uint32 now = SDL_GetTicks();
+    if (static_cast<Sint32>(now - m_nextInjectTicks) < 0) return;
+    m_nextInjectTicks = now + LATENCY_BENCH_INPUT_INTERVAL_MS;
+
+    switch (Engine::GetInstance()->GetGameState()) {
+        case STATE_MAIN_MENU:
+            Engine::GetInstance()->SetGameState(STATE_START_SCREEN);
+            break;
+        case STATE_START_SCREEN:
+            m_keyHeld = SDL_SCANCODE_RIGHT;
+            break;
+        case STATE_PLAYING:
+            m_keyHeld = m_nextLaneUp ? SDL_SCANCODE_UP : SDL_SCANCODE_DOWN;
+            m_nextLaneUp = !m_nextLaneUp;
+            break;
+        case STATE_GAME_OVER:
+        case STATE_WIN:
+            m_keyHeld = SDL_SCANCODE_R;
+            break;
+        default:
+            break;
+    }
+    if (m_keyHeld != SDL_SCANCODE_UNKNOWN) {
+        InjectKey(m_keyHeld, SDL_GetKeyFromScancode(m_keyHeld), true);
+    }
+}
+
+void LatencyProbe::InjectKey(SDL_Scancode scancode, SDL_Keycode keycode, bool pressed) {
+    SDL_Event event;
+    SDL_zero(event);
+    event.type = pressed ? SDL_KEYDOWN : SDL_KEYUP;
+    event.key.state = pressed ? SDL_PRESSED : SDL_RELEASED;
+    event.key.repeat = 0;
+    event.key.keysym.scancode = scancode;
+    event.key.keysym.sym = keycode;
+    if (SDL_PushEvent(&event) < 0) {
+        SDL_Log("LatencyProbe: failed to push synthetic input: %s", SDL_GetError());
+    }
+}
+
+void LatencyProbe::Report() {
+    if (m_samples.empty()) {
+        SDL_Log("Latency probe: no samples collected.");
+        return;
+    }
+    std::vector<double> inputToSim, simToRecord, recordToPresent, total;
+    double toMs = 1000.0 / SDL_GetPerformanceFrequency();
+    for (const Sample& sample : m_samples) {
+        inputToSim.push_back((sample.applied - sample.input) * toMs);
+        simToRecord.push_back((sample.recorded - sample.applied) * toMs);
+        recordToPresent.push_back((sample.presented - sample.recorded) * toMs);
+        total.push_back((sample.presented - sample.input) * toMs);
+    }
+    SDL_Log("Latency probe report (%d samples, ms):", static_cast<int>(m_samples.size()));
+    ReportStage("input->sim", inputToSim);
+    ReportStage("sim->record", simToRecord);
+    ReportStage("record->present", recordToPresent);
+    ReportStage("input->present", total);
+}
+
+void LatencyProbe::ReportStage(const char* name, std::vector<double>& values) {
+    std::sort(values.begin(), values.end());
+    auto percentile = [&values](double p) {
+        size_t rank = static_cast<size_t>(p * (values.size() - 1) + 0.5);
+        return values[rank];
+    };
+    SDL_Log("  %-16s p50 %7.2f  p90 %7.2f  p99 %7.2f  max %7.2f",
+            name, percentile(0.50), percentile(0.90), percentile(0.99), values.back());
+}
@@ -0,0 +1,66 @@
+#ifndef LATENCYPROBE_H
+#define LATENCYPROBE_H
+
+#include <vector>
+#include "SDL.h"
+#include "../Input/InputManager.h"
+
+#define LATENCY_PROBE_MAX_SAMPLES 4096
+#define LATENCY_PROBE_MAX_IN_FLIGHT 32
+#define LATENCY_BENCH_INPUT_INTERVAL_MS 250
+
+// Instrumentation for lane-change and brake inputs. Each input keeps its
+// high-resolution stamp through the simulation step that applies it, the
+// render pass that records the result and the SDL_RenderPresent that
+// first shows it. Bench mode injects synthetic key presses through
+// SDL_PushEvent so the whole path can run unattended.
+class LatencyProbe {
+public:
+    static LatencyProbe* GetInstance() {
+        return s_Instance = (s_Instance != nullptr) ? s_Instance : new LatencyProbe();
+    }
+
+    void Enable();
+    void EnableBench(int sampleTarget);
+    inline bool IsEnabled() const { return m_enabled; }
+    inline bool IsBenchRunning() const { return m_benchMode; }
+
+    void OnInputApplied(const InputActionEvent& event);
+    void OnFrameRecorded();
+    void OnFramePresented();
+    void UpdateBench();
+
+    void Report();
+
+private:
+    LatencyProbe() :
+        m_enabled(false), m_benchMode(false), m_benchSampleTarget(0),
+        m_nextInjectTicks(0), m_nextLaneUp(true), m_keyHeld(SDL_SCANCODE_UNKNOWN),
+        m_inFlightCount(0)
+    {}
+    static LatencyProbe* s_Instance;
+
+    struct Sample {
+        Uint64 input;
+        Uint64 applied;
+        Uint64 recorded;
+        Uint64 presented;
+        bool isRecorded;
+    };
+
+    void InjectKey(SDL_Scancode scancode, SDL_Keycode keycode, bool pressed);
+    void ReportStage(const char* name, std::vector<double>& values);
+
+    bool m_enabled;
+    bool m_benchMode;
+    int m_benchSampleTarget;
+    Uint32 m_nextInjectTicks;
+    bool m_nextLaneUp;
+    SDL_Scancode m_keyHeld;
+
+    Sample m_inFlight[LATENCY_PROBE_MAX_IN_FLIGHT];
+    int m_inFlightCount;
+    std::vector<Sample> m_samples;
+};
+
+#endif // LATENCYPROBE_H
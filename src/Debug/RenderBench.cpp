@@ -0,0 +1,109 @@
+#include <algorithm>
+#include <cstdio>
+#include "RenderBench.h"
+#include "../Core/Engine.h"
+
+RenderBench* RenderBench::s_Instance = nullptr;
+
+void RenderBench::Enable(int frames) {
+    m_frameLimit = frames > 0 ? frames : 0;
+    m_updateMs.clear();
+    m_renderMs.clear();
+    m_updateMs.reserve(m_frameLimit);
+    m_renderMs.reserve(m_frameLimit);
+}
+
+void RenderBench::StartGameplay() {
+    Engine::GetInstance()->SetGameState(STATE_START_SCREEN);
+    // Same path as a real key press, so the run starts through Events().
+    SDL_Event event;
+    SDL_zero(event);
+    event.type = SDL_KEYDOWN;
+    event.key.state = SDL_PRESSED;
+    event.key.keysym.scancode = SDL_SCANCODE_RIGHT;
+    event.key.keysym.sym = SDLK_RIGHT;
+    SDL_PushEvent(&event);
+    event.type = SDL_KEYUP;
+    event.key.state = SDL_RELEASED;
+    SDL_PushEvent(&event);
+}
+
+void RenderBench::BeginFrame() {
+    if (!IsEnabled()) return;
+    m_frameStart = SDL_GetPerformanceCounter();
+}
+
+void RenderBench::BeginRender() {
+    if (!IsEnabled()) return;
+    m_renderStart = SDL_GetPerformanceCounter();
+}
+
+void RenderBench::EndFrame() {
+    if (!IsEnabled()) return;
+    double frequency = static_cast<double>(SDL_GetPerformanceFrequency());
+    m_updateMs.push_back((m_renderStart - m_frameStart) * 1000.0 / frequency);
+    m_renderMs.push_back((SDL_GetPerformanceCounter() - m_renderStart) * 1000.0 / frequency);
+    if (static_cast<int>(m_renderMs.size()) >= m_frameLimit) {
+        Engine::GetInstance()->Quit();
+    }
+}
+
+static void LogStats(const char* label, int riders, std::vector<double> sorted, double* average) {
+    std::sort(sorted.begin(), sorted.end());
+    double total = 0.0;
+    for (double ms : sorted) total += ms;
+    auto percentile = [&sorted](double p) {
+        size_t rank = static_cast<size_t>(p * (sorted.size() - 1) + 0.5);
+        return sorted[rank];
+    };
+    *average = total / sorted.size();
+    SDL_Log("%s bench (%d frames, %d rider%s, ms): avg %7.3f  p50 %7.3f  p90 %7.3f  p99 %7.3f  max %7.3f",
+            label, static_cast<int>(sorted.size()), riders, riders == 1 ? "" : "s", *average,
+            percentile(0.50), percentile(0.90), percentile(0.99), sorted.back());
+}
+
+bool RenderBench::Report() {
+    if (m_renderMs.empty()) return true;
+    int riders = Engine::GetInstance()->GetRiderCount();
+    std::vector<double> frameMs(m_renderMs.size());
+    for (size_t i = 0; i < frameMs.size(); ++i) frameMs[i] = m_updateMs[i] + m_renderMs[i];
+    double updateAverage, renderAverage, frameAverage;
+    LogStats("Update", riders, m_updateMs, &updateAverage);
+    LogStats("Render", riders, m_renderMs, &renderAverage);
+    LogStats("Frame", riders, frameMs, &frameAverage);
+    return m_resultsPath.empty() || CompareResults(riders, frameAverage);
+}
+
+bool RenderBench::CompareResults(int riders, double frameMs) {
+    // Each line: riders, frames, average frame ms. The last line for the
+    // other rider count is the baseline.
+    int baselineRiders = riders == 1 ? 2 : 1;
+    double baselineMs = 0.0;
+    FILE* file = std::fopen(m_resultsPath.c_str(), "r");
+    if (file) {
+        int lineRiders, lineFrames;
+        double lineMs;
+        while (std::fscanf(file, "%d %d %lf", &lineRiders, &lineFrames, &lineMs) == 3) {
+            if (lineRiders == baselineRiders && lineFrames == static_cast<int>(m_renderMs.size())) baselineMs = lineMs;
+        }
+        std::fclose(file);
+    }
+    file = std::fopen(m_resultsPath.c_str(), "a");
+    if (file == nullptr) {
+        SDL_Log("RenderBench::CompareResults - Error: cannot open '%s'.", m_resultsPath.c_str());
+        return false;
+    }
+    std::fprintf(file, "%d %d %.4f\n", riders, static_cast<int>(m_renderMs.size()), frameMs);
+    std::fclose(file);
+    if (baselineMs <= 0.0) return true;
+    double single = riders == 1 ? frameMs : baselineMs;
+    double split = riders == 1 ? baselineMs : frameMs;
+    double cost = split / single;
+    SDL_Log("Split screen frame cost: %.2fx single rider (%.3f ms vs %.3f ms)", cost, split, single);
+    if (cost >= RENDER_BENCH_MAX_SPLIT_COST) {
+        SDL_Log("RenderBench::CompareResults - Error: split screen must cost less than %.1fx a single view.",
+                RENDER_BENCH_MAX_SPLIT_COST);
+        return false;
+    }
+    return true;
+}
@@ -0,0 +1,47 @@
+#ifndef RENDERBENCH_H
+#define RENDERBENCH_H
+
+#include <string>
+#include <vector>
+#include "SDL.h"
+
+#define RENDER_BENCH_MAX_SPLIT_COST 2.0
+
+// Times Engine::Update() and Engine::Render() for a fixed number of frames
+// and stops the engine once they are done. With a fixed clock step and seed
+// the frames rendered are the same on every run, which is what the golden
+// capture relies on. With a results file, each run appends its averages and
+// the report compares a split screen run against the last single rider run
+// (or the other way round). Report() fails the run when split screen costs
+// RENDER_BENCH_MAX_SPLIT_COST times a single view or more.
+class RenderBench {
+public:
+    static RenderBench* GetInstance() {
+        return s_Instance = (s_Instance != nullptr) ? s_Instance : new RenderBench();
+    }
+
+    void Enable(int frames);
+    inline bool IsEnabled() const { return m_frameLimit > 0; }
+    inline void SetResultsPath(const char* path) { m_resultsPath = path; }
+
+    void StartGameplay();
+    void BeginFrame();
+    void BeginRender();
+    void EndFrame();
+    bool Report();
+
+private:
+    RenderBench() : m_frameLimit(0), m_frameStart(0), m_renderStart(0) {}
+    static RenderBench* s_Instance;
+
+    bool CompareResults(int riders, double frameMs);
+
+    int m_frameLimit;
+    Uint64 m_frameStart;
+    Uint64 m_renderStart;
+    std::vector<double> m_updateMs;
+    std::vector<double> m_renderMs;
+    std::string m_resultsPath;
+};
+
+#endif // RENDERBENCH_H
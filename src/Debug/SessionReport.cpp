@@ -0,0 +1,93 @@
+#include <cstdio>
+#include <cstring>
+#include <ctime>
+#include "SessionReport.h"
+
+SessionReport* SessionReport::s_Instance = nullptr;
+
+static const char* s_metricNames[METRIC_COUNT] = { "frame", "sim-step", "render", "present", "input" };
+
+SessionReport::SessionReport() : m_file(nullptr), m_lastFrame(0), m_runStartTicks(0), m_runs(0), m_wins(0) {}
+
+void SessionReport::RecordTicks(SessionMetric metric, Uint64 ticks) {
+    Uint64 micros = ticks * 1000000 / SDL_GetPerformanceFrequency();
+    Record(metric, micros > 0xFFFFFFFFu ? 0xFFFFFFFFu : static_cast<Uint32>(micros));
+}
+
+// Only frames that are meant to run back to back are timed; idle waits in
+// menus and while paused are not hitches.
+void SessionReport::OnFrame(bool timed) {
+    Uint64 now = SDL_GetPerformanceCounter();
+    if (timed && m_lastFrame != 0) RecordTicks(METRIC_FRAME, now - m_lastFrame);
+    m_lastFrame = timed ? now : 0;
+}
+
+void SessionReport::FoldCurrent() {
+    for (int i = 0; i < METRIC_COUNT; ++i) {
+        m_session[i].Add(m_current[i]);
+        m_current[i].Reset();
+    }
+}
+
+void SessionReport::BeginRun() {
+    FoldCurrent();
+    m_runStartTicks = SDL_GetTicks();
+}
+
+void SessionReport::EndRun(const char* result, float distance, int collisions, float speed) {
+    m_runs++;
+    if (std::strcmp(result, "win") == 0) m_wins++;
+    char heading[160];
+    SDL_snprintf(heading, sizeof(heading), "run %d %s distance=%.1f collisions=%d speed=%.1f duration=%.1fs", m_runs,
+                 result, distance, collisions, speed, (SDL_GetTicks() - m_runStartTicks) / 1000.0f);
+    Write(heading, m_current);
+    FoldCurrent();
+}
+
+void SessionReport::EndSession() {
+    FoldCurrent();
+    char heading[96];
+    SDL_snprintf(heading, sizeof(heading), "session runs=%d wins=%d", m_runs, m_wins);
+    Write(heading, m_session);
+    if (m_file != nullptr) {
+        std::fclose(m_file);
+        m_file = nullptr;
+    }
+}
+
+void SessionReport::Write(const char* heading, const Histogram* histograms) {
+    if (!m_path.empty() && m_file == nullptr) {
+        m_file = std::fopen(m_path.c_str(), "a");
+        if (m_file == nullptr) {
+            SDL_Log("SessionReport::Write - Error: cannot open '%s'.", m_path.c_str());
+            m_path.clear();
+        } else {
+            char date[32];
+            std::time_t now = std::time(nullptr);
+            std::strftime(date, sizeof(date), "%Y-%m-%d %H:%M:%S", std::localtime(&now));
+            std::fprintf(m_file, "# %s build %s %s, %s, %d cpus, %d MB\n", date, __DATE__, __TIME__, SDL_GetPlatform(),
+                         SDL_GetCPUCount(), SDL_GetSystemRAM());
+        }
+    }
+
+    char line[192];
+    for (int i = -1; i < METRIC_COUNT; ++i) {
+        if (i < 0) {
+            SDL_strlcpy(line, heading, sizeof(line));
+        } else {
+            const Histogram& h = histograms[i];
+            if (h.GetCount() == 0) continue;
+            SDL_snprintf(line, sizeof(line),
+                         "  %-8s n=%-7llu p50=%.2f p90=%.2f p99=%.2f p99.9=%.2f max=%.2f ms",
+                         s_metricNames[i], static_cast<unsigned long long>(h.GetCount()), h.GetPercentile(50.0) / 1000.0,
+                         h.GetPercentile(90.0) / 1000.0, h.GetPercentile(99.0) / 1000.0,
+                         h.GetPercentile(99.9) / 1000.0, h.GetMax() / 1000.0);
+        }
+        if (m_file != nullptr) {
+            std::fprintf(m_file, "%s\n", line);
+        } else {
+            SDL_Log("%s", line);
+        }
+    }
+    if (m_file != nullptr) std::fflush(m_file);
+}
@@ -0,0 +1,65 @@
+#ifndef SESSIONREPORT_H
+#define SESSIONREPORT_H
+
+#include <string>
+#include "SDL.h"
+#include "Histogram.h"
+
+enum SessionMetric {
+    METRIC_FRAME,
+    METRIC_SIM_STEP,
+    METRIC_RENDER,
+    METRIC_PRESENT,
+    METRIC_INPUT_LATENCY,
+    METRIC_COUNT
+};
+
+// Always-on timing histograms for the whole session. Each finished run gets
+// a short report with its percentiles and how it went; the session totals
+// follow on exit. Reports are appended to --session-report <file> so runs
+// from different builds and machines can be compared, or logged otherwise.
+class SessionReport {
+public:
+    static SessionReport* GetInstance() {
+        return s_Instance = (s_Instance != nullptr) ? s_Instance : new SessionReport();
+    }
+
+    inline void SetPath(const char* path) { m_path = path; }
+
+    inline void Record(SessionMetric metric, Uint32 micros) { m_current[metric].Record(micros); }
+    void RecordTicks(SessionMetric metric, Uint64 ticks);
+    void OnFrame(bool timed);
+
+    void BeginRun();
+    void EndRun(const char* result, float distance, int collisions, float speed);
+    void EndSession();
+
+private:
+    SessionReport();
+    static SessionReport* s_Instance;
+
+    void FoldCurrent();
+    void Write(const char* heading, const Histogram* histograms);
+
+    std::string m_path;
+    FILE* m_file;
+    Histogram m_current[METRIC_COUNT];
+    Histogram m_session[METRIC_COUNT];
+    Uint64 m_lastFrame;
+    Uint32 m_runStartTicks;
+    int m_runs;
+    int m_wins;
+};
+
+// Records the time spent in the enclosing scope.
+class MetricTimer {
+public:
+    explicit MetricTimer(SessionMetric metric) : m_metric(metric), m_start(SDL_GetPerformanceCounter()) {}
+    ~MetricTimer() { SessionReport::GetInstance()->RecordTicks(m_metric, SDL_GetPerformanceCounter() - m_start); }
+
+private:
+    SessionMetric m_metric;
+    Uint64 m_start;
+};
+
+#endif // SESSIONREPORT_H
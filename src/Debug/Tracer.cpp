@@ -0,0 +1,222 @@
+#include <cstring>
+#include "Tracer.h"
+
+Tracer* Tracer::s_Instance = nullptr;
+
+struct TraceBuffer {
+    TraceEvent events[TRACE_BUFFER_EVENTS];
+    SDL_atomic_t head;
+    SDL_atomic_t tail;
+    char name[TRACE_THREAD_NAME_SIZE];
+};
+
+static thread_local TraceBuffer* t_buffer = nullptr;
+static thread_local bool t_bufferFailed = false;
+static thread_local char t_threadName[TRACE_THREAD_NAME_SIZE] = "";
+
+static const char s_phaseChars[] = { 'B', 'E', 'i', 'C' };
+
+Tracer::Tracer()
+    : m_file(nullptr), m_firstEvent(true), m_registerLock(nullptr), m_origin(0), m_microsPerTick(0.0),
+      m_spikeThresholdTicks(0), m_frameStart(0), m_history(nullptr), m_historyHead(0), m_historyCount(0),
+      m_spikeStart(0), m_writtenUpTo(0), m_spikeFramesLeft(0), m_spikeCount(0) {
+    SDL_AtomicSet(&m_active, 0);
+    SDL_AtomicSet(&m_dropped, 0);
+    SDL_AtomicSet(&m_bufferCount, 0);
+    for (int i = 0; i < TRACE_MAX_THREADS; ++i) m_buffers[i] = nullptr;
+    m_registerLock = SDL_CreateMutex();
+}
+
+bool Tracer::Open(const char* path) {
+    if (m_file != nullptr) Close();
+    m_file = fopen(path, "w");
+    if (m_file == nullptr) {
+        SDL_Log("Tracer::Open - Error: cannot open '%s'.", path);
+        return false;
+    }
+    fputs("{\"displayTimeUnit\":\"ms\",\"traceEvents\":[", m_file);
+    m_firstEvent = true;
+    m_origin = SDL_GetPerformanceCounter();
+    m_microsPerTick = 1000000.0 / static_cast<double>(SDL_GetPerformanceFrequency());
+    m_writtenUpTo = m_origin;
+    m_spikeCount = 0;
+    m_spikeFramesLeft = 0;
+    SDL_Log("Tracer: writing trace events to '%s' (%s to toggle).", path, SDL_GetScancodeName(TRACE_TOGGLE_KEY));
+    return true;
+}
+
+void Tracer::SetSpikeThreshold(float frameMs) {
+    if (frameMs <= 0.0f) {
+        m_spikeThresholdTicks = 0;
+        return;
+    }
+    if (m_history == nullptr) m_history = new TraceEvent[TRACE_HISTORY_EVENTS];
+    m_historyHead = 0;
+    m_historyCount = 0;
+    m_spikeThresholdTicks = static_cast<Uint64>(frameMs * SDL_GetPerformanceFrequency() / 1000.0);
+    SDL_Log("Tracer: keeping history, writing frames over %.1f ms.", frameMs);
+    SetActive(true);
+}
+
+void Tracer::SetActive(bool active) {
+    if (active && m_file == nullptr) return;
+    if (active == IsActive()) return;
+    SDL_AtomicSet(&m_active, active ? 1 : 0);
+    SDL_Log("Tracer: capture %s.", active ? "on" : "off");
+}
+
+void Tracer::SetThreadName(const char* name) {
+    SDL_strlcpy(t_threadName, name, sizeof(t_threadName));
+    if (t_buffer != nullptr) SDL_strlcpy(t_buffer->name, name, sizeof(t_buffer->name));
+}
+
+TraceBuffer* Tracer::GetThreadBuffer() {
+    if (t_buffer != nullptr || t_bufferFailed) return t_buffer;
+    SDL_LockMutex(m_registerLock);
+    int count = SDL_AtomicGet(&m_bufferCount);
+    if (count < TRACE_MAX_THREADS) {
+        TraceBuffer* buffer = new TraceBuffer();
+        SDL_AtomicSet(&buffer->head, 0);
+        SDL_AtomicSet(&buffer->tail, 0);
+        if (t_threadName[0] != '\0') {
+            SDL_strlcpy(buffer->name, t_threadName, sizeof(buffer->name));
+        } else {
+            SDL_snprintf(buffer->name, sizeof(buffer->name), "Thread %d", count);
+        }
+        m_buffers[count] = buffer;
+        SDL_AtomicSet(&m_bufferCount, count + 1);
+        t_buffer = buffer;
+    } else {
+        t_bufferFailed = true;
+    }
+    SDL_UnlockMutex(m_registerLock);
+    return t_buffer;
+}
+
+void Tracer::Record(TracePhase phase, const char* name, const char* detail, double value) {
+    if (!IsActive()) return;
+    Uint64 now = SDL_GetPerformanceCounter();
+    TraceBuffer* buffer = GetThreadBuffer();
+    if (buffer == nullptr) {
+        SDL_AtomicAdd(&m_dropped, 1);
+        return;
+    }
+    Uint32 head = static_cast<Uint32>(SDL_AtomicGet(&buffer->head));
+    if (head - static_cast<Uint32>(SDL_AtomicGet(&buffer->tail)) >= TRACE_BUFFER_EVENTS) {
+        SDL_AtomicAdd(&m_dropped, 1);
+        return;
+    }
+    TraceEvent& event = buffer->events[head % TRACE_BUFFER_EVENTS];
+    event.counter = now;
+    event.name = name;
+    event.value = value;
+    event.phase = static_cast<Uint8>(phase);
+    event.tid = 0;
+    int length = 0;
+    // Details end up inside a JSON string.
+    for (; detail != nullptr && detail[length] != '\0' && length < TRACE_DETAIL_SIZE - 1; ++length) {
+        char c = detail[length];
+        event.detail[length] = (c == '"' || c == '\\' || c < ' ') ? '_' : c;
+    }
+    event.detail[length] = '\0';
+    SDL_AtomicAdd(&buffer->head, 1);
+}
+
+void Tracer::BeginFrame() {
+    m_frameStart = SDL_GetPerformanceCounter();
+    Record(TRACE_BEGIN, "Frame");
+}
+
+void Tracer::ExcludeIdleWait() {
+    m_frameStart = SDL_GetPerformanceCounter();
+}
+
+void Tracer::EndFrame() {
+    if (m_file == nullptr) return;
+    Uint64 frameTicks = SDL_GetPerformanceCounter() - m_frameStart;
+    Record(TRACE_END, "Frame");
+    Collect();
+    if (m_spikeThresholdTicks == 0) return;
+
+    if (m_spikeFramesLeft > 0) {
+        if (--m_spikeFramesLeft == 0) WriteSpikeWindow();
+    } else if (frameTicks > m_spikeThresholdTicks && m_spikeCount < TRACE_MAX_SPIKES && IsActive()) {
+        Record(TRACE_INSTANT, "FrameSpike", nullptr, frameTicks * m_microsPerTick / 1000.0);
+        m_spikeStart = m_frameStart;
+        m_spikeFramesLeft = TRACE_SPIKE_AFTER_FRAMES;
+    }
+}
+
+void Tracer::Collect() {
+    int count = SDL_AtomicGet(&m_bufferCount);
+    for (int i = 0; i < count; ++i) {
+        TraceBuffer* buffer = m_buffers[i];
+        Uint32 tail = static_cast<Uint32>(SDL_AtomicGet(&buffer->tail));
+        Uint32 head = static_cast<Uint32>(SDL_AtomicGet(&buffer->head));
+        for (; tail != head; ++tail) {
+            TraceEvent event = buffer->events[tail % TRACE_BUFFER_EVENTS];
+            event.tid = static_cast<Uint8>(i);
+            if (m_spikeThresholdTicks == 0) {
+                WriteEvent(event);
+                continue;
+            }
+            m_history[m_historyHead] = event;
+            m_historyHead = (m_historyHead + 1) % TRACE_HISTORY_EVENTS;
+            if (m_historyCount < TRACE_HISTORY_EVENTS) m_historyCount++;
+        }
+        SDL_AtomicSet(&buffer->tail, static_cast<int>(tail));
+    }
+}
+
+void Tracer::WriteEvent(const TraceEvent& event) {
+    double ts = (static_cast<double>(event.counter) - static_cast<double>(m_origin)) * m_microsPerTick;
+    fprintf(m_file, "%s\n{\"name\":\"%s\",\"ph\":\"%c\",\"ts\":%.3f,\"pid\":1,\"tid\":%d", m_firstEvent ? "" : ",",
+            event.name, s_phaseChars[event.phase], ts, event.tid);
+    m_firstEvent = false;
+    if (event.phase == TRACE_INSTANT) fputs(",\"s\":\"t\"", m_file);
+    if (event.phase == TRACE_COUNTER || (event.phase == TRACE_INSTANT && event.value != 0.0)) {
+        fprintf(m_file, ",\"args\":{\"value\":%g}", event.value);
+    } else if (event.detail[0] != '\0') {
+        fprintf(m_file, ",\"args\":{\"detail\":\"%s\"}", event.detail);
+    }
+    fputc('}', m_file);
+}
+
+void Tracer::WriteSpikeWindow() {
+    Uint64 before = static_cast<Uint64>(TRACE_SPIKE_BEFORE_MS * 1000.0 / m_microsPerTick);
+    Uint64 cutoff = m_spikeStart > before ? m_spikeStart - before : 0;
+    if (cutoff <= m_writtenUpTo) cutoff = m_writtenUpTo + 1;
+    Uint32 first = (m_historyHead + TRACE_HISTORY_EVENTS - m_historyCount) % TRACE_HISTORY_EVENTS;
+    int written = 0;
+    for (Uint32 i = 0; i < m_historyCount; ++i) {
+        const TraceEvent& event = m_history[(first + i) % TRACE_HISTORY_EVENTS];
+        if (event.counter < cutoff) continue;
+        WriteEvent(event);
+        if (event.counter > m_writtenUpTo) m_writtenUpTo = event.counter;
+        written++;
+    }
+    fflush(m_file);
+    m_spikeCount++;
+    SDL_Log("Tracer: wrote %d events around frame spike %d.", written, m_spikeCount);
+}
+
+void Tracer::Close() {
+    if (m_file == nullptr) return;
+    SetActive(false);
+    Collect();
+    if (m_spikeFramesLeft > 0) {
+        m_spikeFramesLeft = 0;
+        WriteSpikeWindow();
+    }
+    int count = SDL_AtomicGet(&m_bufferCount);
+    for (int i = 0; i < count; ++i) {
+        fprintf(m_file, "%s\n{\"name\":\"thread_name\",\"ph\":\"M\",\"pid\":1,\"tid\":%d,\"args\":{\"name\":\"%s\"}}",
+                m_firstEvent ? "" : ",", i, m_buffers[i]->name);
+        m_firstEvent = false;
+    }
+    fputs("\n]}\n", m_file);
+    fclose(m_file);
+    m_file = nullptr;
+    int dropped = SDL_AtomicGet(&m_dropped);
+    if (dropped > 0) SDL_Log("Tracer: %d events dropped because a thread buffer was full.", dropped);
+}
@@ -0,0 +1,111 @@
+#ifndef TRACER_H
+#define TRACER_H
+
+#include <cstdio>
+#include "SDL.h"
+
+#define TRACE_MAX_THREADS 16
+#define TRACE_BUFFER_EVENTS 8192
+#define TRACE_HISTORY_EVENTS 65536
+#define TRACE_DETAIL_SIZE 24
+#define TRACE_THREAD_NAME_SIZE 24
+#define TRACE_SPIKE_BEFORE_MS 500
+#define TRACE_SPIKE_AFTER_FRAMES 30
+#define TRACE_MAX_SPIKES 16
+#define TRACE_TOGGLE_KEY SDL_SCANCODE_F9
+
+enum TracePhase {
+    TRACE_BEGIN,
+    TRACE_END,
+    TRACE_INSTANT,
+    TRACE_COUNTER
+};
+
+struct TraceEvent {
+    Uint64 counter;
+    const char* name;
+    double value;
+    Uint8 phase;
+    Uint8 tid;
+    char detail[TRACE_DETAIL_SIZE];
+};
+
+struct TraceBuffer;
+
+// Timeline tracing in Chrome trace-event JSON (loads in chrome://tracing and
+// the Perfetto UI). Each thread records into its own single-producer ring;
+// the game thread collects them once a frame. Continuous mode writes every
+// frame while tracing is on (TRACE_TOGGLE_KEY or --trace-start). Spike
+// mode keeps the last TRACE_HISTORY_EVENTS events in memory and only writes
+// the TRACE_SPIKE_BEFORE_MS before a slow frame and TRACE_SPIKE_AFTER_FRAMES
+// frames after it. Names must be string literals; details are copied.
+class Tracer {
+public:
+    static Tracer* GetInstance() {
+        return s_Instance = (s_Instance != nullptr) ? s_Instance : new Tracer();
+    }
+
+    bool Open(const char* path);
+    void Close();
+    void SetSpikeThreshold(float frameMs);
+    void SetActive(bool active);
+    inline void Toggle() { SetActive(!IsActive()); }
+    inline bool IsActive() { return SDL_AtomicGet(&m_active) != 0; }
+
+    void SetThreadName(const char* name);
+    void Record(TracePhase phase, const char* name, const char* detail = nullptr, double value = 0.0);
+
+    // Game thread only. Time blocked in an idle wait is left out of the
+    // frame time the spike threshold is checked against.
+    void BeginFrame();
+    void ExcludeIdleWait();
+    void EndFrame();
+
+private:
+    Tracer();
+    static Tracer* s_Instance;
+
+    TraceBuffer* GetThreadBuffer();
+    void Collect();
+    void WriteEvent(const TraceEvent& event);
+    void WriteSpikeWindow();
+
+    FILE* m_file;
+    bool m_firstEvent;
+    SDL_atomic_t m_active;
+    SDL_atomic_t m_dropped;
+    SDL_mutex* m_registerLock;
+    SDL_atomic_t m_bufferCount;
+    TraceBuffer* m_buffers[TRACE_MAX_THREADS];
+    Uint64 m_origin;
+    double m_microsPerTick;
+
+    Uint64 m_spikeThresholdTicks;
+    Uint64 m_frameStart;
+    TraceEvent* m_history;
+    Uint32 m_historyHead;
+    Uint32 m_historyCount;
+    Uint64 m_spikeStart;
+    Uint64 m_writtenUpTo;
+    int m_spikeFramesLeft;
+    int m_spikeCount;
+};
+
+class TraceScope {
+public:
+    TraceScope(const char* name, const char* detail = nullptr) : m_name(name) {
+        Tracer::GetInstance()->Record(TRACE_BEGIN, name, detail);
+    }
+    ~TraceScope() { Tracer::GetInstance()->Record(TRACE_END, m_name); }
+
+private:
+    const char* m_name;
+};
+
+#define TRACE_CONCAT_(a, b) a##b
+#define TRACE_CONCAT(a, b) TRACE_CONCAT_(a, b)
+#define TRACE_SCOPE(...) TraceScope TRACE_CONCAT(traceScope, __LINE__)(__VA_ARGS__)
+#define TRACE_INSTANT(name) Tracer::GetInstance()->Record(TRACE_INSTANT, name)
+#define TRACE_COUNTER(name, value) Tracer::GetInstance()->Record(TRACE_COUNTER, name, nullptr, value)
+
+#endif // TRACER_H
@@ -0,0 +1,186 @@
+#include <cstring>
+#include "VideoExporter.h"
+#include "../Core/Engine.h"
+#include "../Input/InputRecorder.h"
+
+#ifdef _WIN32
+#define popen _popen
+#define pclose _pclose
+#endif
+
+VideoExporter* VideoExporter::s_Instance = nullptr;
+
+bool VideoExporter::Open(const char* path, VideoExportFormat format, int fps, int width, int height) {
+    if (IsOpen()) Close();
+    if (format == VIDEO_EXPORT_Y4M && ((width | height) & 1)) {
+        SDL_Log("VideoExporter::Open - Error: Y4M 4:2:0 needs even dimensions, got %dx%d.", width, height);
+        return false;
+    }
+
+    m_isPipe = false;
+    if (path[0] == '|') {
+        m_output = popen(path + 1, "w");
+        m_isPipe = true;
+    } else if (std::strcmp(path, "-") == 0) {
+        m_output = stdout;
+    } else {
+        m_output = fopen(path, "wb");
+    }
+    if (m_output == nullptr) {
+        SDL_Log("VideoExporter::Open - Error: cannot open '%s'.", path);
+        return false;
+    }
+
+    m_format = format;
+    m_fps = fps > 0 ? fps : 60;
+    m_width = width;
+    m_height = height;
+    for (int i = 0; i < VIDEO_EXPORT_QUEUE_DEPTH; ++i) {
+        m_slots[i].resize(static_cast<size_t>(width) * height * 4);
+    }
+    m_planes.resize(static_cast<size_t>(width) * height * 3 / 2);
+    m_writeSlot = m_readSlot = 0;
+    m_framesQueued = m_framesWritten = 0;
+    m_stallTicks = 0;
+    m_sawGameplay = false;
+    m_tailFrames = 0;
+
+    if (m_format == VIDEO_EXPORT_Y4M) {
+        fprintf(m_output, "YUV4MPEG2 W%d H%d F%d:1 Ip A1:1 C420jpeg\n", width, height, m_fps);
+    }
+
+    SDL_AtomicSet(&m_stopping, 0);
+    m_freeSlots = SDL_CreateSemaphore(VIDEO_EXPORT_QUEUE_DEPTH);
+    m_filledSlots = SDL_CreateSemaphore(0);
+    m_thread = SDL_CreateThread(&VideoExporter::WriterThread, "VideoExport", this);
+    if (m_thread == nullptr) {
+        SDL_Log("VideoExporter::Open - Error: cannot start writer thread: %s", SDL_GetError());
+        Close();
+        return false;
+    }
+    m_openTicks = SDL_GetPerformanceCounter();
+    SDL_Log("VideoExporter: writing %dx%d @ %d fps %s to '%s'.", width, height, m_fps,
+            m_format == VIDEO_EXPORT_Y4M ? "Y4M" : "raw RGBA", path);
+    return true;
+}
+
+void VideoExporter::OnFrame(const Uint8* pixels, int pitch, int width, int height, Uint32 frameIndex, void* userData) {
+    VideoExporter* exporter = static_cast<VideoExporter*>(userData);
+    if (!exporter->IsOpen() || width != exporter->m_width || height != exporter->m_height) return;
+    exporter->Push(pixels, pitch);
+    exporter->CheckRunFinished();
+}
+
+void VideoExporter::Push(const Uint8* pixels, int pitch) {
+    if (SDL_SemTryWait(m_freeSlots) != 0) {
+        Uint64 start = SDL_GetPerformanceCounter();
+        SDL_SemWait(m_freeSlots);
+        m_stallTicks += SDL_GetPerformanceCounter() - start;
+    }
+    Uint8* slot = m_slots[m_writeSlot].data();
+    int rowBytes = m_width * 4;
+    for (int y = 0; y < m_height; ++y) {
+        std::memcpy(slot + y * rowBytes, pixels + y * pitch, rowBytes);
+    }
+    m_writeSlot = (m_writeSlot + 1) % VIDEO_EXPORT_QUEUE_DEPTH;
+    m_framesQueued++;
+    SDL_SemPost(m_filledSlots);
+}
+
+void VideoExporter::CheckRunFinished() {
+    // Stop a couple of seconds after the recorded run is over, so the clip
+    // ends on the result screen.
+    Engine* engine = Engine::GetInstance();
+    bool inRun = engine->GetGameState() == STATE_PLAYING &&
+                 !InputRecorder::GetInstance()->IsReplayFinished(engine->GetRunStep());
+    if (inRun) {
+        m_sawGameplay = true;
+        return;
+    }
+    if (m_sawGameplay && ++m_tailFrames >= VIDEO_EXPORT_TAIL_SECONDS * m_fps) {
+        engine->Quit();
+    }
+}
+
+int VideoExporter::WriterThread(void* data) {
+    VideoExporter* exporter = static_cast<VideoExporter*>(data);
+    for (;;) {
+        SDL_SemWait(exporter->m_filledSlots);
+        // The stop token is posted after the last frame, once the renderer is
+        // done pushing, so the queued count is stable when stopping is seen.
+        if (SDL_AtomicGet(&exporter->m_stopping) && exporter->m_framesWritten == exporter->m_framesQueued) break;
+        exporter->WriteFrame(exporter->m_slots[exporter->m_readSlot].data());
+        exporter->m_readSlot = (exporter->m_readSlot + 1) % VIDEO_EXPORT_QUEUE_DEPTH;
+        exporter->m_framesWritten++;
+        SDL_SemPost(exporter->m_freeSlots);
+    }
+    return 0;
+}
+
+void VideoExporter::WriteFrame(const Uint8* rgba) {
+    if (m_format == VIDEO_EXPORT_RAW) {
+        fwrite(rgba, 1, static_cast<size_t>(m_width) * m_height * 4, m_output);
+        return;
+    }
+
+    // Full-range BT.601, chroma averaged over each 2x2 block.
+    Uint8* yPlane = m_planes.data();
+    Uint8* uPlane = yPlane + m_width * m_height;
+    Uint8* vPlane = uPlane + (m_width / 2) * (m_height / 2);
+    for (int y = 0; y < m_height; y += 2) {
+        const Uint8* row0 = rgba + y * m_width * 4;
+        const Uint8* row1 = row0 + m_width * 4;
+        for (int x = 0; x < m_width; x += 2) {
+            int sumU = 0;
+            int sumV = 0;
+            const Uint8* quad[4] = { row0 + x * 4, row0 + x * 4 + 4, row1 + x * 4, row1 + x * 4 + 4 };
+            for (int i = 0; i < 4; ++i) {
+                int r = quad[i][0], g = quad[i][1], b = quad[i][2];
+                int px = x + (i & 1);
+                int py = y + (i >> 1);
+                yPlane[py * m_width + px] = static_cast<Uint8>((77 * r + 150 * g + 29 * b) >> 8);
+                sumU += -43 * r - 85 * g + 128 * b;
+                sumV += 128 * r - 107 * g - 21 * b;
+            }
+            int u = (sumU >> 10) + 128;
+            int v = (sumV >> 10) + 128;
+            uPlane[(y / 2) * (m_width / 2) + x / 2] = static_cast<Uint8>(u < 0 ? 0 : (u > 255 ? 255 : u));
+            vPlane[(y / 2) * (m_width / 2) + x / 2] = static_cast<Uint8>(v < 0 ? 0 : (v > 255 ? 255 : v));
+        }
+    }
+    fputs("FRAME\n", m_output);
+    fwrite(m_planes.data(), 1, m_planes.size(), m_output);
+}
+
+void VideoExporter::Close() {
+    if (m_thread) {
+        SDL_AtomicSet(&m_stopping, 1);
+        SDL_SemPost(m_filledSlots);
+        SDL_WaitThread(m_thread, nullptr);
+        m_thread = nullptr;
+    }
+    if (m_freeSlots) {
+        SDL_DestroySemaphore(m_freeSlots);
+        m_freeSlots = nullptr;
+    }
+    if (m_filledSlots) {
+        SDL_DestroySemaphore(m_filledSlots);
+        m_filledSlots = nullptr;
+    }
+    if (m_output) {
+        if (m_isPipe) {
+            pclose(m_output);
+        } else if (m_output != stdout) {
+            fclose(m_output);
+        } else {
+            fflush(m_output);
+        }
+        m_output = nullptr;
+
+        double seconds = (SDL_GetPerformanceCounter() - m_openTicks) / static_cast<double>(SDL_GetPerformanceFrequency());
+        double stallMs = m_stallTicks * 1000.0 / SDL_GetPerformanceFrequency();
+        SDL_Log("VideoExporter: %u frames written in %.2f s (%.1f fps, %.1fx real time), renderer stalled %.1f ms on a full queue.",
+                m_framesWritten, seconds, seconds > 0.0 ? m_framesWritten / seconds : 0.0,
+                seconds > 0.0 ? m_framesWritten / (seconds * m_fps) : 0.0, stallMs);
+    }
+}
@@ -0,0 +1,72 @@
+#ifndef VIDEOEXPORTER_H
+#define VIDEOEXPORTER_H
+
+#include <cstdio>
+#include <string>
+#include <vector>
+#include "SDL.h"
+
+#define VIDEO_EXPORT_QUEUE_DEPTH 8
+#define VIDEO_EXPORT_TAIL_SECONDS 2
+
+enum VideoExportFormat {
+    VIDEO_EXPORT_Y4M,
+    VIDEO_EXPORT_RAW
+};
+
+// Streams captured frames to an uncompressed video file or to a pipe
+// ("|command" or "-" for stdout). Frames are read back on the render
+// thread by FrameCapture and copied into a bounded queue; a writer thread
+// converts them (RGBA -> I420 for Y4M) and writes them out. A full queue
+// blocks the renderer, so memory stays bounded whatever the disk speed.
+class VideoExporter {
+public:
+    static VideoExporter* GetInstance() {
+        return s_Instance = (s_Instance != nullptr) ? s_Instance : new VideoExporter();
+    }
+
+    bool Open(const char* path, VideoExportFormat format, int fps, int width, int height);
+    void Close();
+    inline bool IsOpen() const { return m_output != nullptr; }
+
+    static void OnFrame(const Uint8* pixels, int pitch, int width, int height, Uint32 frameIndex, void* userData);
+
+private:
+    VideoExporter() : m_format(VIDEO_EXPORT_Y4M), m_fps(60), m_width(0), m_height(0), m_output(nullptr),
+        m_isPipe(false), m_thread(nullptr), m_freeSlots(nullptr), m_filledSlots(nullptr), m_writeSlot(0),
+        m_readSlot(0), m_framesQueued(0), m_framesWritten(0), m_stallTicks(0), m_openTicks(0),
+        m_sawGameplay(false), m_tailFrames(0) {
+        SDL_AtomicSet(&m_stopping, 0);
+    }
+    static VideoExporter* s_Instance;
+
+    static int WriterThread(void* data);
+    void Push(const Uint8* pixels, int pitch);
+    void WriteFrame(const Uint8* rgba);
+    void CheckRunFinished();
+
+    VideoExportFormat m_format;
+    int m_fps;
+    int m_width;
+    int m_height;
+    FILE* m_output;
+    bool m_isPipe;
+
+    SDL_Thread* m_thread;
+    SDL_sem* m_freeSlots;
+    SDL_sem* m_filledSlots;
+    SDL_atomic_t m_stopping;
+    std::vector<Uint8> m_slots[VIDEO_EXPORT_QUEUE_DEPTH];
+    int m_writeSlot;
+    int m_readSlot;
+    std::vector<Uint8> m_planes;
+
+    Uint32 m_framesQueued;
+    Uint32 m_framesWritten;
+    Uint64 m_stallTicks;
+    Uint64 m_openTicks;
+    bool m_sawGameplay;
+    int m_tailFrames;
+};
+
+#endif // VIDEOEXPORTER_H
@@ -0,0 +1,41 @@
+#include "RenderCache.h"
+#include "RenderStats.h"
+
+bool RenderCache::Begin(SDL_Renderer* renderer, int width, int height) {
+    if (m_unsupported) return false;
+    if (m_texture == nullptr) {
+        if (SDL_RenderTargetSupported(renderer)) {
+            m_texture = SDL_CreateTexture(renderer, SDL_PIXELFORMAT_RGBA8888, SDL_TEXTUREACCESS_TARGET, width, height);
+        }
+        if (m_texture == nullptr) {
+            SDL_Log("RenderCache - Render targets unavailable, static screens will be redrawn: %s", SDL_GetError());
+            m_unsupported = true;
+            return false;
+        }
+    }
+    m_previousTarget = SDL_GetRenderTarget(renderer);
+    if (RenderStats::GetInstance()->SetTarget(renderer, m_texture) != 0) {
+        SDL_Log("RenderCache::Begin - Error: %s", SDL_GetError());
+        return false;
+    }
+    return true;
+}
+
+void RenderCache::End(SDL_Renderer* renderer) {
+    RenderStats::GetInstance()->SetTarget(renderer, m_previousTarget);
+    m_valid = true;
+}
+
+void RenderCache::Draw(SDL_Renderer* renderer) {
+    if (m_texture) {
+        RenderStats::GetInstance()->Copy(renderer, m_texture, NULL, NULL);
+    }
+}
+
+void RenderCache::Release() {
+    if (m_texture) {
+        SDL_DestroyTexture(m_texture);
+        m_texture = nullptr;
+    }
+    m_valid = false;
+}
@@ -0,0 +1,30 @@
+#ifndef RENDERCACHE_H
+#define RENDERCACHE_H
+
+#include "SDL.h"
+
+// Screen-sized render target holding a composed frame. Callers draw into it
+// between Begin() and End() when it is invalid and otherwise just Draw() it.
+// Begin() returns false when render targets are unavailable; the caller then
+// draws directly every frame.
+class RenderCache {
+public:
+    RenderCache() : m_texture(nullptr), m_previousTarget(nullptr), m_valid(false), m_unsupported(false) {}
+    ~RenderCache() { Release(); }
+
+    bool Begin(SDL_Renderer* renderer, int width, int height);
+    void End(SDL_Renderer* renderer);
+    void Draw(SDL_Renderer* renderer);
+    void Release();
+
+    inline void Invalidate() { m_valid = false; }
+    inline bool IsValid() const { return m_valid; }
+
+private:
+    SDL_Texture* m_texture;
+    SDL_Texture* m_previousTarget;
+    bool m_valid;
+    bool m_unsupported;
+};
+
+#endif // RENDERCACHE_H
@@ -0,0 +1,221 @@
+#include <cstring>
+#include "RenderStats.h"
+
+RenderStats* RenderStats::s_Instance = nullptr;
+
+static const char* s_rowLabels[RENDER_ROW_COUNT] = {
+    "draws ", "tex switches ", "textures ", "targets ", "uploads ", "upload KB ", "ttf surfaces "
+};
+
+RenderStats::RenderStats()
+    : m_maxDraws(0), m_frames(0), m_section(RENDER_SECTION_ENGINE), m_suspended(false), m_lastTexture(nullptr), m_export(nullptr),
+      m_overlayVisible(false), m_overlayFailed(false), m_digits(nullptr) {
+    std::memset(&m_frame, 0, sizeof(m_frame));
+    std::memset(&m_last, 0, sizeof(m_last));
+    std::memset(&m_max, 0, sizeof(m_max));
+    std::memset(&m_total, 0, sizeof(m_total));
+    for (int i = 0; i < RENDER_ROW_COUNT; ++i) {
+        m_rowLabels[i] = nullptr;
+        m_rowLabelSize[i].x = m_rowLabelSize[i].y = 0;
+    }
+    m_digitsSize.x = m_digitsSize.y = 0;
+}
+
+void RenderStats::CountDraw(SDL_Texture* texture) {
+    if (m_suspended) return;
+    m_frame.sectionDraws[m_section]++;
+    if (texture == m_lastTexture) return;
+    m_frame.textureSwitches++;
+    m_lastTexture = texture;
+    // Saturates at RENDER_STATS_MAX_TEXTURES, far more than a frame uses.
+    Uint32 count = m_frame.distinctTextures;
+    for (Uint32 i = 0; i < count; ++i) {
+        if (m_textures[i] == texture) return;
+    }
+    if (count < RENDER_STATS_MAX_TEXTURES) {
+        m_textures[count] = texture;
+        m_frame.distinctTextures++;
+    }
+}
+
+int RenderStats::Copy(SDL_Renderer* renderer, SDL_Texture* texture, const SDL_Rect* src, const SDL_Rect* dst) {
+    if (!m_suspended) m_frame.copies++;
+    CountDraw(texture);
+    return SDL_RenderCopy(renderer, texture, src, dst);
+}
+
+int RenderStats::CopyEx(SDL_Renderer* renderer, SDL_Texture* texture, const SDL_Rect* src, const SDL_Rect* dst,
+                        double angle, const SDL_Point* center, SDL_RendererFlip flip) {
+    if (!m_suspended) m_frame.copiesEx++;
+    CountDraw(texture);
+    return SDL_RenderCopyEx(renderer, texture, src, dst, angle, center, flip);
+}
+
+int RenderStats::SetTarget(SDL_Renderer* renderer, SDL_Texture* target) {
+    if (!m_suspended) m_frame.targetSwitches++;
+    return SDL_SetRenderTarget(renderer, target);
+}
+
+SDL_Texture* RenderStats::CreateTextureFromSurface(SDL_Renderer* renderer, SDL_Surface* surface) {
+    if (surface != nullptr && !m_suspended) {
+        m_frame.uploads++;
+        m_frame.uploadBytes += static_cast<Uint64>(surface->pitch) * surface->h;
+    }
+    return SDL_CreateTextureFromSurface(renderer, surface);
+}
+
+SDL_Surface* RenderStats::RenderText(TTF_Font* font, const char* text, SDL_Color color) {
+    if (!m_suspended) m_frame.ttfSurfaces++;
+    return TTF_RenderText_Solid(font, text, color);
+}
+
+bool RenderStats::SetExportPath(const char* path) {
+    if (m_export != nullptr) std::fclose(m_export);
+    m_export = std::fopen(path, "w");
+    if (m_export == nullptr) {
+        SDL_Log("RenderStats::SetExportPath - Error: cannot open '%s'.", path);
+        return false;
+    }
+    std::fprintf(m_export, "frame,copies,copies_ex,texture_switches,distinct_textures,target_switches,uploads,"
+                           "upload_bytes,ttf_surfaces,engine_draws,pause_menu_draws,main_menu_draws\n");
+    return true;
+}
+
+void RenderStats::EndFrame() {
+    m_last = m_frame;
+    m_frames++;
+    Uint32* fields[] = { &m_frame.copies, &m_frame.copiesEx, &m_frame.textureSwitches, &m_frame.distinctTextures,
+                         &m_frame.targetSwitches, &m_frame.uploads, &m_frame.ttfSurfaces };
+    Uint32* maxFields[] = { &m_max.copies, &m_max.copiesEx, &m_max.textureSwitches, &m_max.distinctTextures,
+                            &m_max.targetSwitches, &m_max.uploads, &m_max.ttfSurfaces };
+    Uint32* totalFields[] = { &m_total.copies, &m_total.copiesEx, &m_total.textureSwitches, &m_total.distinctTextures,
+                              &m_total.targetSwitches, &m_total.uploads, &m_total.ttfSurfaces };
+    for (int i = 0; i < 7; ++i) {
+        if (*fields[i] > *maxFields[i]) *maxFields[i] = *fields[i];
+        *totalFields[i] += *fields[i];
+    }
+    // The busiest frame for copies need not be the busiest for CopyEx calls.
+    Uint32 draws = m_frame.copies + m_frame.copiesEx;
+    if (draws > m_maxDraws) m_maxDraws = draws;
+    if (m_frame.uploadBytes > m_max.uploadBytes) m_max.uploadBytes = m_frame.uploadBytes;
+    m_total.uploadBytes += m_frame.uploadBytes;
+
+    if (m_export != nullptr) {
+        std::fprintf(m_export, "%u,%u,%u,%u,%u,%u,%u,%llu,%u,%u,%u,%u\n", m_frames, m_frame.copies, m_frame.copiesEx,
+                     m_frame.textureSwitches, m_frame.distinctTextures, m_frame.targetSwitches, m_frame.uploads,
+                     static_cast<unsigned long long>(m_frame.uploadBytes), m_frame.ttfSurfaces,
+                     m_frame.sectionDraws[RENDER_SECTION_ENGINE], m_frame.sectionDraws[RENDER_SECTION_PAUSE_MENU],
+                     m_frame.sectionDraws[RENDER_SECTION_MAIN_MENU]);
+    }
+    std::memset(&m_frame, 0, sizeof(m_frame));
+    m_lastTexture = nullptr;
+}
+
+void RenderStats::Report() {
+    if (m_export != nullptr) {
+        std::fclose(m_export);
+        m_export = nullptr;
+    }
+    if (m_frames == 0) return;
+    double frames = static_cast<double>(m_frames);
+    SDL_Log("RenderStats (%u frames, avg / max per frame): draws %.1f / %u, texture switches %.1f / %u, "
+            "textures %.1f / %u, target switches %.1f / %u",
+            m_frames, (m_total.copies + m_total.copiesEx) / frames, m_maxDraws,
+            m_total.textureSwitches / frames, m_max.textureSwitches, m_total.distinctTextures / frames,
+            m_max.distinctTextures, m_total.targetSwitches / frames, m_max.targetSwitches);
+    SDL_Log("RenderStats: %u texture uploads (%llu KB, max %u in a frame), %u TTF surfaces (max %u in a frame)",
+            m_total.uploads, static_cast<unsigned long long>(m_total.uploadBytes / 1024), m_max.uploads,
+            m_total.ttfSurfaces, m_max.ttfSurfaces);
+}
+
+Uint32 RenderStats::GetRowValue(int row) const {
+    switch (row) {
+        case RENDER_ROW_DRAWS: return m_last.copies + m_last.copiesEx;
+        case RENDER_ROW_TEXTURE_SWITCHES: return m_last.textureSwitches;
+        case RENDER_ROW_TEXTURES: return m_last.distinctTextures;
+        case RENDER_ROW_TARGET_SWITCHES: return m_last.targetSwitches;
+        case RENDER_ROW_UPLOADS: return m_last.uploads;
+        case RENDER_ROW_UPLOAD_KB: return static_cast<Uint32>((m_last.uploadBytes + 1023) / 1024);
+        default: return m_last.ttfSurfaces;
+    }
+}
+
+// The overlay's own text is rendered once, like the HUD distance: a label
+// per row and a strip of digits from the monospaced UI font.
+bool RenderStats::CreateOverlay(SDL_Renderer* renderer, TTF_Font* font) {
+    SDL_Color color = {255, 255, 0, 255};
+    for (int i = 0; i <= RENDER_ROW_COUNT; ++i) {
+        const char* text = i < RENDER_ROW_COUNT ? s_rowLabels[i] : "0123456789";
+        SDL_Surface* surface = TTF_RenderText_Solid(font, text, color);
+        if (surface == nullptr) return false;
+        SDL_Texture* texture = SDL_CreateTextureFromSurface(renderer, surface);
+        SDL_Point size = {surface->w, surface->h};
+        SDL_FreeSurface(surface);
+        if (texture == nullptr) return false;
+        if (i < RENDER_ROW_COUNT) {
+            m_rowLabels[i] = texture;
+            m_rowLabelSize[i] = size;
+        } else {
+            m_digits = texture;
+            m_digitsSize = size;
+        }
+    }
+    return true;
+}
+
+void RenderStats::ReleaseOverlay() {
+    for (int i = 0; i < RENDER_ROW_COUNT; ++i) {
+        if (m_rowLabels[i] != nullptr) {
+            SDL_DestroyTexture(m_rowLabels[i]);
+            m_rowLabels[i] = nullptr;
+        }
+    }
+    if (m_digits != nullptr) {
+        SDL_DestroyTexture(m_digits);
+        m_digits = nullptr;
+    }
+}
+
+void RenderStats::DrawOverlay(SDL_Renderer* renderer, TTF_Font* font) {
+    if (!m_overlayVisible || m_overlayFailed || font == nullptr) return;
+    if (m_digits == nullptr && !CreateOverlay(renderer, font)) {
+        SDL_Log("RenderStats - Failed to create overlay text: %s", SDL_GetError());
+        ReleaseOverlay();
+        m_overlayFailed = true;
+        return;
+    }
+
+    // The overlay is not part of the frame being measured.
+    m_suspended = true;
+    int labelWidth = 0;
+    for (int i = 0; i < RENDER_ROW_COUNT; ++i) {
+        if (m_rowLabelSize[i].x > labelWidth) labelWidth = m_rowLabelSize[i].x;
+    }
+    int digitWidth = m_digitsSize.x / 10;
+    int rowHeight = m_digitsSize.y;
+    SDL_Rect background = {RENDER_STATS_OVERLAY_X - 4, RENDER_STATS_OVERLAY_Y - 4, labelWidth + digitWidth * 8 + 8,
+                           rowHeight * RENDER_ROW_COUNT + 8};
+    SDL_BlendMode blendMode;
+    SDL_GetRenderDrawBlendMode(renderer, &blendMode);
+    SDL_SetRenderDrawBlendMode(renderer, SDL_BLENDMODE_BLEND);
+    SDL_SetRenderDrawColor(renderer, 0, 0, 0, 160);
+    SDL_RenderFillRect(renderer, &background);
+    SDL_SetRenderDrawBlendMode(renderer, blendMode);
+
+    for (int row = 0; row < RENDER_ROW_COUNT; ++row) {
+        int y = RENDER_STATS_OVERLAY_Y + row * rowHeight;
+        SDL_Rect dst = {RENDER_STATS_OVERLAY_X, y, m_rowLabelSize[row].x, m_rowLabelSize[row].y};
+        Copy(renderer, m_rowLabels[row], NULL, &dst);
+
+        char digits[16];
+        int length = SDL_snprintf(digits, sizeof(digits), "%u", GetRowValue(row));
+        SDL_Rect src = {0, 0, digitWidth, rowHeight};
+        dst = {RENDER_STATS_OVERLAY_X + labelWidth, y, digitWidth, rowHeight};
+        for (int i = 0; i < length; ++i) {
+            src.x = (digits[i] - '0') * digitWidth;
+            Copy(renderer, m_digits, &src, &dst);
+            dst.x += digitWidth;
+        }
+    }
+    m_suspended = false;
+}
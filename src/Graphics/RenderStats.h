@@ -0,0 +1,115 @@
+#ifndef RENDERSTATS_H
+#define RENDERSTATS_H
+
+#include <cstdio>
+#include "SDL.h"
+#include "SDL_ttf.h"
+
+#define RENDER_STATS_MAX_TEXTURES 64
+#define RENDER_STATS_TOGGLE_KEY SDL_SCANCODE_F10
+#define RENDER_STATS_OVERLAY_X 8
+#define RENDER_STATS_OVERLAY_Y 40
+
+enum RenderSectionId {
+    RENDER_SECTION_ENGINE,
+    RENDER_SECTION_PAUSE_MENU,
+    RENDER_SECTION_MAIN_MENU,
+    RENDER_SECTION_COUNT
+};
+
+enum RenderStatsRow {
+    RENDER_ROW_DRAWS,
+    RENDER_ROW_TEXTURE_SWITCHES,
+    RENDER_ROW_TEXTURES,
+    RENDER_ROW_TARGET_SWITCHES,
+    RENDER_ROW_UPLOADS,
+    RENDER_ROW_UPLOAD_KB,
+    RENDER_ROW_TTF_SURFACES,
+    RENDER_ROW_COUNT
+};
+
+struct RenderFrameStats {
+    Uint32 copies;
+    Uint32 copiesEx;
+    Uint32 textureSwitches;
+    Uint32 distinctTextures;
+    Uint32 targetSwitches;
+    Uint32 uploads;
+    Uint64 uploadBytes;
+    Uint32 ttfSurfaces;
+    Uint32 sectionDraws[RENDER_SECTION_COUNT];
+};
+
+// Per-frame renderer counters. Draw calls, render target changes, texture
+// uploads and TTF text surfaces go through the wrappers below instead of
+// calling SDL directly, so every frame's cost is known: a frame runs from
+// one present to the next, so uploads made while handling input count
+// towards the frame that shows them. F10 (or --render-stats) shows the last
+// frame on screen; --render-stats-file writes one CSV row per frame.
+class RenderStats {
+public:
+    static RenderStats* GetInstance() {
+        return s_Instance = (s_Instance != nullptr) ? s_Instance : new RenderStats();
+    }
+
+    int Copy(SDL_Renderer* renderer, SDL_Texture* texture, const SDL_Rect* src, const SDL_Rect* dst);
+    int CopyEx(SDL_Renderer* renderer, SDL_Texture* texture, const SDL_Rect* src, const SDL_Rect* dst,
+               double angle, const SDL_Point* center, SDL_RendererFlip flip);
+    int SetTarget(SDL_Renderer* renderer, SDL_Texture* target);
+    SDL_Texture* CreateTextureFromSurface(SDL_Renderer* renderer, SDL_Surface* surface);
+    SDL_Surface* RenderText(TTF_Font* font, const char* text, SDL_Color color);
+
+    inline void SetSection(int section) { m_section = section; }
+    inline int GetSection() const { return m_section; }
+
+    bool SetExportPath(const char* path);
+    inline void SetOverlayVisible(bool visible) { m_overlayVisible = visible; }
+    inline void ToggleOverlay() { m_overlayVisible = !m_overlayVisible; }
+    void DrawOverlay(SDL_Renderer* renderer, TTF_Font* font);
+    void ReleaseOverlay();
+
+    void EndFrame();
+    void Report();
+    inline const RenderFrameStats& GetLastFrame() const { return m_last; }
+
+private:
+    RenderStats();
+    static RenderStats* s_Instance;
+
+    void CountDraw(SDL_Texture* texture);
+    bool CreateOverlay(SDL_Renderer* renderer, TTF_Font* font);
+    Uint32 GetRowValue(int row) const;
+
+    RenderFrameStats m_frame;
+    RenderFrameStats m_last;
+    RenderFrameStats m_max;
+    RenderFrameStats m_total;
+    Uint32 m_maxDraws;
+    Uint32 m_frames;
+    int m_section;
+    bool m_suspended;
+    SDL_Texture* m_lastTexture;
+    SDL_Texture* m_textures[RENDER_STATS_MAX_TEXTURES];
+
+    FILE* m_export;
+    bool m_overlayVisible;
+    bool m_overlayFailed;
+    SDL_Texture* m_rowLabels[RENDER_ROW_COUNT];
+    SDL_Point m_rowLabelSize[RENDER_ROW_COUNT];
+    SDL_Texture* m_digits;
+    SDL_Point m_digitsSize;
+};
+
+// Attributes the draw calls of the enclosing scope to a section.
+class RenderSection {
+public:
+    explicit RenderSection(int section) : m_previous(RenderStats::GetInstance()->GetSection()) {
+        RenderStats::GetInstance()->SetSection(section);
+    }
+    ~RenderSection() { RenderStats::GetInstance()->SetSection(m_previous); }
+
+private:
+    int m_previous;
+};
+
+#endif // RENDERSTATS_H
@@ -0,0 +1,84 @@
+#include "ResolutionScaler.h"
+#include "RenderStats.h"
+
+void ResolutionScaler::Init(int width, int height) {
+    m_width = width;
+    m_height = height;
+}
+
+void ResolutionScaler::SetFixedScale(float scale) {
+    m_scale = SDL_max(RES_SCALE_MIN, SDL_min(RES_SCALE_MAX, scale));
+    m_adaptive = false;
+}
+
+void ResolutionScaler::SetMinScale(float scale) {
+    m_minScale = SDL_max(RES_SCALE_MIN, SDL_min(RES_SCALE_MAX, scale));
+    if (m_scale < m_minScale) m_scale = m_minScale;
+}
+
+bool ResolutionScaler::Begin(SDL_Renderer* renderer) {
+    m_active = false;
+    if (m_unsupported || m_scale >= RES_SCALE_MAX) return false;
+
+    if (m_target == nullptr) {
+        if (SDL_RenderTargetSupported(renderer)) {
+            // Linear filtering is picked up from the hint when the texture is created.
+            const char* previousQuality = SDL_GetHint(SDL_HINT_RENDER_SCALE_QUALITY);
+            SDL_SetHint(SDL_HINT_RENDER_SCALE_QUALITY, "linear");
+            m_target = SDL_CreateTexture(renderer, SDL_PIXELFORMAT_RGBA8888, SDL_TEXTUREACCESS_TARGET, m_width, m_height);
+            SDL_SetHint(SDL_HINT_RENDER_SCALE_QUALITY, previousQuality ? previousQuality : "nearest");
+        }
+        if (m_target == nullptr) {
+            SDL_Log("ResolutionScaler - Render targets unavailable, rendering at native resolution.");
+            m_unsupported = true;
+            m_scale = RES_SCALE_MAX;
+            return false;
+        }
+    }
+
+    m_previousTarget = SDL_GetRenderTarget(renderer);
+    RenderStats::GetInstance()->SetTarget(renderer, m_target);
+    SDL_RenderSetScale(renderer, m_scale, m_scale);
+    m_active = true;
+    return true;
+}
+
+void ResolutionScaler::End(SDL_Renderer* renderer) {
+    if (!m_active) return;
+    SDL_RenderSetScale(renderer, 1.0f, 1.0f);
+    RenderStats::GetInstance()->SetTarget(renderer, m_previousTarget);
+    SDL_Rect source = { 0, 0, static_cast<int>(m_width * m_scale), static_cast<int>(m_height * m_scale) };
+    RenderStats::GetInstance()->Copy(renderer, m_target, &source, NULL);
+    m_active = false;
+}
+
+void ResolutionScaler::Update(float renderCostMs, float budgetMs) {
+    if (!m_adaptive || m_unsupported || budgetMs <= 0.0f) return;
+
+    m_smoothedCostMs += (renderCostMs - m_smoothedCostMs) * RES_SCALE_SMOOTHING;
+    if (++m_framesSinceChange < RES_SCALE_SETTLE_FRAMES) return;
+
+    float newScale = m_scale;
+    if (m_smoothedCostMs > budgetMs * RES_SCALE_HIGH_WATER) {
+        newScale = SDL_max(m_minScale, m_scale - RES_SCALE_STEP);
+    } else if (m_smoothedCostMs < budgetMs * RES_SCALE_LOW_WATER) {
+        newScale = SDL_min(RES_SCALE_MAX, m_scale + RES_SCALE_STEP);
+    }
+    // Snap to the step grid so repeated float steps land exactly on 100%.
+    newScale = SDL_floorf(newScale / RES_SCALE_STEP + 0.5f) * RES_SCALE_STEP;
+    if (newScale != m_scale) {
+        SDL_Log("ResolutionScaler: render cost %.2f ms of %.2f ms budget, scale %.0f%% -> %.0f%%",
+                m_smoothedCostMs, budgetMs, m_scale * 100.0f, newScale * 100.0f);
+        m_scale = newScale;
+        m_framesSinceChange = 0;
+        m_changes++;
+    }
+}
+
+void ResolutionScaler::Release() {
+    if (m_target) {
+        SDL_DestroyTexture(m_target);
+        m_target = nullptr;
+    }
+    m_active = false;
+}
@@ -0,0 +1,53 @@
+#ifndef RESOLUTIONSCALER_H
+#define RESOLUTIONSCALER_H
+
+#include "SDL.h"
+
+#define RES_SCALE_MIN 0.5f
+#define RES_SCALE_MAX 1.0f
+#define RES_SCALE_STEP 0.1f
+#define RES_SCALE_HIGH_WATER 0.75f
+#define RES_SCALE_LOW_WATER 0.45f
+#define RES_SCALE_SMOOTHING 0.1f
+#define RES_SCALE_SETTLE_FRAMES 30
+
+// Renders the world into an offscreen target at a fraction of the logical
+// size and upscales it on copy. The target is allocated once at full size;
+// SDL_RenderSetScale maps the unchanged 800x600 draw calls onto its top-left
+// corner, so a lower scale simply touches fewer pixels. Update() moves the
+// scale one step at a time from the smoothed render cost.
+class ResolutionScaler {
+public:
+    ResolutionScaler() : m_target(nullptr), m_previousTarget(nullptr), m_width(0), m_height(0), m_scale(RES_SCALE_MAX),
+        m_minScale(RES_SCALE_MIN), m_adaptive(true), m_unsupported(false), m_active(false),
+        m_smoothedCostMs(0.0f), m_framesSinceChange(0), m_changes(0) {}
+    ~ResolutionScaler() { Release(); }
+
+    void Init(int width, int height);
+    void SetFixedScale(float scale);
+    void SetMinScale(float scale);
+
+    bool Begin(SDL_Renderer* renderer);
+    void End(SDL_Renderer* renderer);
+    void Update(float renderCostMs, float budgetMs);
+    void Release();
+
+    inline float GetScale() const { return m_scale; }
+    inline Uint32 GetChangeCount() const { return m_changes; }
+
+private:
+    SDL_Texture* m_target;
+    SDL_Texture* m_previousTarget;
+    int m_width;
+    int m_height;
+    float m_scale;
+    float m_minScale;
+    bool m_adaptive;
+    bool m_unsupported;
+    bool m_active;
+    float m_smoothedCostMs;
+    int m_framesSinceChange;
+    Uint32 m_changes;
+};
+
+#endif // RESOLUTIONSCALER_H
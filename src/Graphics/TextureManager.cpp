@@ -1,11 +1,15 @@
 #include "TextureManager.h"
+#include "RenderStats.h"
 #include "../Core/Engine.h"
+#include "../Core/Log.h"
+#include "../Debug/Tracer.h"
 #include <SDL_image.h>
 
 TextureManager* TextureManager::s_Instance = nullptr;
 
 bool TextureManager::Load(std::string id, std::string filename)
 {
+    TRACE_SCOPE("LoadTexture", id.c_str());
     if (m_TextureMap.count(id)) {
         SDL_Log("Texture '%s' (ID: %s) already loaded.", filename.c_str(), id.c_str());
         return true;
@@ -18,7 +22,7 @@ bool TextureManager::Load(std::string id, std::string filename)
         return false;
     }
 
-    SDL_Texture* texture = SDL_CreateTextureFromSurface(Engine::GetInstance()->GetRenderer(), surface);
+    SDL_Texture* texture = RenderStats::GetInstance()->CreateTextureFromSurface(Engine::GetInstance()->GetRenderer(), surface);
     SDL_FreeSurface(surface);
     if(texture == nullptr)
     {
@@ -31,29 +35,29 @@ bool TextureManager::Load(std::string id, std::string filename)
     return true;
 }
 
-void TextureManager::Draw(std::string id, int x, int y, int width, int height, SDL_RendererFlip flip)
+void TextureManager::Draw(const std::string& id, int x, int y, int width, int height, SDL_RendererFlip flip)
 {
-    SDL_Rect dstRect = {x, y, width, height};
+    SDL_Rect dstRect = {x + m_drawOffset.x, y + m_drawOffset.y, width, height};
 
     auto it = m_TextureMap.find(id);
     if (it != m_TextureMap.end()) {
-       SDL_RenderCopyEx(Engine::GetInstance()->GetRenderer(), it->second, NULL, &dstRect, 0, nullptr, flip);
+       RenderStats::GetInstance()->CopyEx(Engine::GetInstance()->GetRenderer(), it->second, NULL, &dstRect, 0, nullptr, flip);
     } else {
-        SDL_Log("Warning: Attempted to draw non-existent texture ID: %s", id.c_str());
+        LOG_WARN("Attempted to draw non-existent texture ID: %s", id.c_str());
     }
 }
 
 bool TextureManager::QueryTexture(const std::string& id, int* width, int* height) {
     auto it = m_TextureMap.find(id);
     if (it == m_TextureMap.end()) {
-        SDL_Log("Texture ID '%s' not found in QueryTexture.", id.c_str());
+        LOG_WARN("Texture ID '%s' not found in QueryTexture.", id.c_str());
         if (width) *width = 0;
         if (height) *height = 0;
         return false;
     }
 
     if (SDL_QueryTexture(it->second, nullptr, nullptr, width, height) != 0) {
-         SDL_Log("Failed to query texture '%s': %s", id.c_str(), SDL_GetError());
+         LOG_WARN("Failed to query texture '%s': %s", id.c_str(), SDL_GetError());
          if (width) *width = 0;
          if (height) *height = 0;
          return false;
@@ -87,3 +91,8 @@ void TextureManager::Clean()
     m_TextureMap.clear();
     SDL_Log("Texture map cleaned!");
 }
+
+SDL_Texture* TextureManager::GetTexture(const std::string& id) const {
+    auto it = m_TextureMap.find(id);
+    return (it != m_TextureMap.end()) ? it->second : nullptr;
+}
@@ -17,13 +17,20 @@ public:
     void Drop(std::string id);
     void Clean();
 
-    void Draw(std::string id, int x, int y, int width, int height, SDL_RendererFlip flip = SDL_FLIP_NONE);
+    void Draw(const std::string& id, int x, int y, int width, int height, SDL_RendererFlip flip = SDL_FLIP_NONE);
+
+    // Added to every Draw() position, e.g. to shift the world into a
+    // split-screen view.
+    inline void SetDrawOffset(int x, int y) { m_drawOffset.x = x; m_drawOffset.y = y; }
+    inline SDL_Point GetDrawOffset() const { return m_drawOffset; }
 
     bool QueryTexture(const std::string& id, int* width, int* height);
+    SDL_Texture* GetTexture(const std::string& id) const;
 
 private:
-    TextureManager() {}
+    TextureManager() { m_drawOffset.x = 0; m_drawOffset.y = 0; }
     std::map<std::string, SDL_Texture*> m_TextureMap;
+    SDL_Point m_drawOffset;
     static TextureManager* s_Instance;
 };
 
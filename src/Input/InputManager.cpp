@@ -0,0 +1,209 @@
+#include "InputManager.h"
+#include "../Debug/SessionReport.h"
+
+InputManager* InputManager::s_Instance = nullptr;
+
+void InputManager::Init() {
+    SetDefaultBindings();
+    for (int i = 0; i < ACTION_COUNT; ++i) {
+        for (int p = 0; p < INPUT_MAX_PLAYERS; ++p) m_held[p][i] = false;
+        m_latency[i].lastMs = 0.0f;
+        m_latency[i].averageMs = 0.0f;
+        m_latency[i].maxMs = 0.0f;
+        m_latency[i].samples = 0;
+    }
+    ClearQueue();
+    m_awaitingCount = 0;
+    SDL_Log("InputManager initialized.");
+}
+
+void InputManager::Clean() {
+    for (int p = 0; p < INPUT_MAX_PLAYERS; ++p) {
+        if (m_controllers[p]) SDL_GameControllerClose(m_controllers[p]);
+        m_controllers[p] = nullptr;
+    }
+}
+
+void InputManager::SetDefaultBindings() {
+    for (int i = 0; i < SDL_NUM_SCANCODES; ++i) {
+        m_keyBindings[i] = ACTION_NONE;
+        m_keyPlayers[i] = 0;
+    }
+    for (int i = 0; i < SDL_CONTROLLER_BUTTON_MAX; ++i) m_buttonBindings[i] = ACTION_NONE;
+
+    BindKey(ACTION_LANE_UP, SDL_SCANCODE_UP);
+    BindKey(ACTION_LANE_DOWN, SDL_SCANCODE_DOWN);
+    BindKey(ACTION_BRAKE, SDL_SCANCODE_LEFT);
+    BindKey(ACTION_START, SDL_SCANCODE_RIGHT);
+    BindKey(ACTION_PAUSE, SDL_SCANCODE_P);
+    BindKey(ACTION_CONFIRM, SDL_SCANCODE_RETURN);
+    BindKey(ACTION_RESTART, SDL_SCANCODE_R);
+    BindKey(ACTION_BACK, SDL_SCANCODE_ESCAPE);
+    BindKey(ACTION_REWIND, SDL_SCANCODE_BACKSPACE);
+
+    BindKey(ACTION_LANE_UP, SDL_SCANCODE_W, 1);
+    BindKey(ACTION_LANE_DOWN, SDL_SCANCODE_S, 1);
+    BindKey(ACTION_BRAKE, SDL_SCANCODE_A, 1);
+
+    BindButton(ACTION_LANE_UP, SDL_CONTROLLER_BUTTON_DPAD_UP);
+    BindButton(ACTION_LANE_DOWN, SDL_CONTROLLER_BUTTON_DPAD_DOWN);
+    BindButton(ACTION_BRAKE, SDL_CONTROLLER_BUTTON_DPAD_LEFT);
+    BindButton(ACTION_BRAKE, SDL_CONTROLLER_BUTTON_LEFTSHOULDER);
+    BindButton(ACTION_START, SDL_CONTROLLER_BUTTON_DPAD_RIGHT);
+    BindButton(ACTION_PAUSE, SDL_CONTROLLER_BUTTON_START);
+    BindButton(ACTION_CONFIRM, SDL_CONTROLLER_BUTTON_A);
+    BindButton(ACTION_RESTART, SDL_CONTROLLER_BUTTON_Y);
+    BindButton(ACTION_BACK, SDL_CONTROLLER_BUTTON_BACK);
+    BindButton(ACTION_REWIND, SDL_CONTROLLER_BUTTON_X);
+}
+
+void InputManager::BindKey(InputAction action, SDL_Scancode scancode, int player) {
+    if (scancode <= SDL_SCANCODE_UNKNOWN || scancode >= SDL_NUM_SCANCODES) return;
+    if (player < 0 || player >= INPUT_MAX_PLAYERS) return;
+    m_keyBindings[scancode] = action;
+    m_keyPlayers[scancode] = static_cast<Uint8>(player);
+}
+
+void InputManager::BindButton(InputAction action, SDL_GameControllerButton button) {
+    if (button <= SDL_CONTROLLER_BUTTON_INVALID || button >= SDL_CONTROLLER_BUTTON_MAX) return;
+    m_buttonBindings[button] = action;
+}
+
+void InputManager::UnbindKey(SDL_Scancode scancode) {
+    BindKey(ACTION_NONE, scancode);
+}
+
+void InputManager::UnbindButton(SDL_GameControllerButton button) {
+    BindButton(ACTION_NONE, button);
+}
+
+InputAction InputManager::GetKeyBinding(SDL_Scancode scancode) const {
+    if (scancode <= SDL_SCANCODE_UNKNOWN || scancode >= SDL_NUM_SCANCODES) return ACTION_NONE;
+    return m_keyBindings[scancode];
+}
+
+bool InputManager::HandleEvent(const SDL_Event& event, InputActionEvent* out) {
+    switch (event.type) {
+        case SDL_KEYDOWN:
+        case SDL_KEYUP: {
+            SDL_Scancode scancode = event.key.keysym.scancode;
+            if (event.key.repeat != 0 || GetKeyBinding(scancode) == ACTION_NONE) return false;
+            return Emit(m_keyBindings[scancode], m_keyPlayers[scancode], event.type == SDL_KEYDOWN, event.key.timestamp, out);
+        }
+
+        case SDL_CONTROLLERBUTTONDOWN:
+        case SDL_CONTROLLERBUTTONUP:
+            if (event.cbutton.button >= SDL_CONTROLLER_BUTTON_MAX) return false;
+            return Emit(m_buttonBindings[event.cbutton.button], GetControllerPlayer(event.cbutton.which),
+                        event.type == SDL_CONTROLLERBUTTONDOWN, event.cbutton.timestamp, out);
+
+        case SDL_CONTROLLERDEVICEADDED: {
+            int slot = 0;
+            while (slot < INPUT_MAX_PLAYERS && m_controllers[slot] != nullptr) slot++;
+            if (slot == INPUT_MAX_PLAYERS) {
+                SDL_Log("Game controller %d ignored: every player already has one.", event.cdevice.which);
+                return false;
+            }
+            SDL_GameController* controller = SDL_GameControllerOpen(event.cdevice.which);
+            if (controller) {
+                m_controllers[slot] = controller;
+                SDL_Log("Game controller %d connected for player %d.", event.cdevice.which, slot + 1);
+            } else {
+                SDL_Log("Failed to open game controller %d: %s", event.cdevice.which, SDL_GetError());
+            }
+            return false;
+        }
+
+        case SDL_CONTROLLERDEVICEREMOVED:
+            return RemoveController(event.cdevice.which, out);
+
+        default:
+            return false;
+    }
+}
+
+int InputManager::GetControllerPlayer(SDL_JoystickID instanceId) const {
+    for (int p = 0; p < INPUT_MAX_PLAYERS; ++p) {
+        if (m_controllers[p] && SDL_JoystickInstanceID(SDL_GameControllerGetJoystick(m_controllers[p])) == instanceId) {
+            return p;
+        }
+    }
+    return 0;
+}
+
+// Frees the pad's slot for the next one plugged in. A rider braking when
+// their pad is pulled gets the release, so they don't brake forever.
+bool InputManager::RemoveController(SDL_JoystickID instanceId, InputActionEvent* out) {
+    for (int p = 0; p < INPUT_MAX_PLAYERS; ++p) {
+        if (!m_controllers[p] || SDL_JoystickInstanceID(SDL_GameControllerGetJoystick(m_controllers[p])) != instanceId) {
+            continue;
+        }
+        SDL_GameControllerClose(m_controllers[p]);
+        m_controllers[p] = nullptr;
+        SDL_Log("Game controller for player %d disconnected.", p + 1);
+        return m_held[p][ACTION_BRAKE] && Emit(ACTION_BRAKE, p, false, SDL_GetTicks(), out);
+    }
+    return false;
+}
+
+bool InputManager::Emit(InputAction action, int player, bool pressed, Uint32 timestamp, InputActionEvent* out) {
+    if (action == ACTION_NONE) return false;
+    m_held[player][action] = pressed;
+    if (out) {
+        // SDL only stamps events in milliseconds; back-date the poll time by
+        // the queue wait to get a high-resolution estimate of when it happened.
+        Uint64 now = SDL_GetPerformanceCounter();
+        Uint32 waitedMs = SDL_GetTicks() - timestamp;
+        out->action = action;
+        out->pressed = pressed;
+        out->player = player;
+        out->timestamp = timestamp;
+        out->counter = now - waitedMs * SDL_GetPerformanceFrequency() / 1000;
+    }
+    return true;
+}
+
+bool InputManager::QueueAction(const InputActionEvent& event) {
+    if (m_queueCount >= INPUT_QUEUE_CAPACITY) {
+        SDL_Log("InputManager::QueueAction - Warning: action queue full, dropping action %d.", event.action);
+        return false;
+    }
+    m_queue[(m_queueHead + m_queueCount) % INPUT_QUEUE_CAPACITY] = event;
+    m_queueCount++;
+    return true;
+}
+
+bool InputManager::PopActionUntil(Uint32 timestamp, InputActionEvent* out) {
+    if (m_queueCount == 0) return false;
+    const InputActionEvent& front = m_queue[m_queueHead];
+    if (static_cast<Sint32>(front.timestamp - timestamp) > 0) return false;
+    *out = front;
+    m_queueHead = (m_queueHead + 1) % INPUT_QUEUE_CAPACITY;
+    m_queueCount--;
+    return true;
+}
+
+void InputManager::ClearQueue() {
+    m_queueHead = 0;
+    m_queueCount = 0;
+}
+
+void InputManager::MarkApplied(const InputActionEvent& event) {
+    if (m_awaitingCount < INPUT_QUEUE_CAPACITY) {
+        m_awaitingPresent[m_awaitingCount++] = event;
+    }
+}
+
+void InputManager::OnFramePresented(Uint32 presentTimestamp) {
+    for (int i = 0; i < m_awaitingCount; ++i) {
+        const InputActionEvent& event = m_awaitingPresent[i];
+        InputLatencyStats& stats = m_latency[event.action];
+        float latency = static_cast<float>(presentTimestamp - event.timestamp);
+        stats.lastMs = latency;
+        stats.averageMs = (stats.samples == 0) ? latency : stats.averageMs + (latency - stats.averageMs) * INPUT_LATENCY_SMOOTHING;
+        if (latency > stats.maxMs) stats.maxMs = latency;
+        stats.samples++;
+        SessionReport::GetInstance()->Record(METRIC_INPUT_LATENCY, static_cast<Uint32>(latency * 1000.0f));
+    }
+    m_awaitingCount = 0;
+}
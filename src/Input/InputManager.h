@@ -0,0 +1,100 @@
+#ifndef INPUTMANAGER_H
+#define INPUTMANAGER_H
+
+#include "SDL.h"
+
+#define INPUT_QUEUE_CAPACITY 64
+#define INPUT_LATENCY_SMOOTHING 0.1f
+#define INPUT_MAX_PLAYERS 2
+
+enum InputAction {
+    ACTION_NONE = -1,
+    ACTION_LANE_UP,
+    ACTION_LANE_DOWN,
+    ACTION_BRAKE,
+    ACTION_START,
+    ACTION_PAUSE,
+    ACTION_CONFIRM,
+    ACTION_RESTART,
+    ACTION_BACK,
+    ACTION_REWIND,
+    ACTION_COUNT
+};
+
+struct InputActionEvent {
+    InputAction action;
+    bool pressed;
+    int player;
+    Uint32 timestamp;
+    Uint64 counter;
+};
+
+struct InputLatencyStats {
+    float lastMs;
+    float averageMs;
+    float maxMs;
+    Uint32 samples;
+};
+
+// Maps keyboard and game controller events to actions while keeping the
+// SDL event timestamp, so the simulation can apply each action inside the
+// step it actually happened in. Each binding belongs to a player, the
+// second keyboard block and the second controller drive player 2 in split
+// screen. Latency is measured from the event
+// timestamp to the first present after the action was applied.
+class InputManager {
+public:
+    static InputManager* GetInstance() {
+        return s_Instance = (s_Instance != nullptr) ? s_Instance : new InputManager();
+    }
+
+    void Init();
+    void Clean();
+
+    bool HandleEvent(const SDL_Event& event, InputActionEvent* out);
+
+    void BindKey(InputAction action, SDL_Scancode scancode, int player = 0);
+    void BindButton(InputAction action, SDL_GameControllerButton button);
+    void UnbindKey(SDL_Scancode scancode);
+    void UnbindButton(SDL_GameControllerButton button);
+    InputAction GetKeyBinding(SDL_Scancode scancode) const;
+
+    inline bool IsHeld(InputAction action, int player = 0) const { return m_held[player][action]; }
+
+    bool QueueAction(const InputActionEvent& event);
+    bool PopActionUntil(Uint32 timestamp, InputActionEvent* out);
+    void ClearQueue();
+
+    void MarkApplied(const InputActionEvent& event);
+    void OnFramePresented(Uint32 presentTimestamp);
+    const InputLatencyStats& GetLatencyStats(InputAction action) const { return m_latency[action]; }
+
+private:
+    InputManager() : m_queueHead(0), m_queueCount(0), m_awaitingCount(0) {
+        for (int p = 0; p < INPUT_MAX_PLAYERS; ++p) m_controllers[p] = nullptr;
+    }
+    static InputManager* s_Instance;
+
+    void SetDefaultBindings();
+    int GetControllerPlayer(SDL_JoystickID instanceId) const;
+    bool RemoveController(SDL_JoystickID instanceId, InputActionEvent* out);
+    bool Emit(InputAction action, int player, bool pressed, Uint32 timestamp, InputActionEvent* out);
+
+    InputAction m_keyBindings[SDL_NUM_SCANCODES];
+    Uint8 m_keyPlayers[SDL_NUM_SCANCODES];
+    InputAction m_buttonBindings[SDL_CONTROLLER_BUTTON_MAX];
+    bool m_held[INPUT_MAX_PLAYERS][ACTION_COUNT];
+    // One slot per player; a connected pad takes the first free slot and
+    // keeps it until it is unplugged.
+    SDL_GameController* m_controllers[INPUT_MAX_PLAYERS];
+
+    InputActionEvent m_queue[INPUT_QUEUE_CAPACITY];
+    int m_queueHead;
+    int m_queueCount;
+
+    InputActionEvent m_awaitingPresent[INPUT_QUEUE_CAPACITY];
+    int m_awaitingCount;
+    InputLatencyStats m_latency[ACTION_COUNT];
+};
+
+#endif // INPUTMANAGER_H
@@ -0,0 +1,112 @@
+#include <algorithm>
+#include <cstdio>
+#include "InputRecorder.h"
+
+InputRecorder* InputRecorder::s_Instance = nullptr;
+
+void InputRecorder::SetRecordPath(const char* path) {
+    m_recordPath = path;
+}
+
+bool InputRecorder::LoadReplay(const char* path) {
+    FILE* file = fopen(path, "rb");
+    if (file == nullptr) {
+        SDL_Log("InputRecorder::LoadReplay - Error: cannot open '%s'.", path);
+        return false;
+    }
+    RecordingHeader header;
+    bool ok = fread(&header, sizeof(header), 1, file) == 1 &&
+              header.magic == INPUT_RECORDING_MAGIC && header.version == INPUT_RECORDING_VERSION;
+    if (ok) {
+        m_actions.resize(header.actionCount);
+        ok = header.actionCount == 0 || fread(m_actions.data(), sizeof(RecordedAction), header.actionCount, file) == header.actionCount;
+    }
+    fclose(file);
+    if (!ok) {
+        SDL_Log("InputRecorder::LoadReplay - Error: '%s' is not a valid run recording.", path);
+        m_actions.clear();
+        return false;
+    }
+
+    m_header = header;
+    m_replaying = true;
+    m_replayIndex = 0;
+    SDL_Log("InputRecorder: replaying '%s' (seed %u, %u steps, %u actions).", path, header.seed, header.endStep, header.actionCount);
+    return true;
+}
+
+void InputRecorder::BeginRun(Uint32 seed) {
+    if (m_replaying) {
+        m_replayIndex = 0;
+        return;
+    }
+    m_header.seed = seed;
+    m_header.endStep = 0;
+    m_actions.clear();
+    m_runActive = IsRecording();
+    if (m_runActive) m_actions.reserve(INPUT_RECORDING_RESERVE);
+}
+
+void InputRecorder::Record(Uint32 step, InputAction action, bool pressed) {
+    if (!m_runActive || m_replaying) return;
+    RecordedAction recorded;
+    recorded.step = step;
+    recorded.action = static_cast<Uint8>(action);
+    recorded.pressed = pressed ? 1 : 0;
+    recorded.padding[0] = recorded.padding[1] = 0;
+    m_actions.push_back(recorded);
+}
+
+void InputRecorder::EndRun(Uint32 step) {
+    if (!m_runActive) return;
+    m_runActive = false;
+
+    m_header.endStep = step;
+    m_header.actionCount = static_cast<Uint32>(m_actions.size());
+    FILE* file = fopen(m_recordPath.c_str(), "wb");
+    if (file == nullptr) {
+        SDL_Log("InputRecorder::EndRun - Error: cannot write '%s'.", m_recordPath.c_str());
+        return;
+    }
+    fwrite(&m_header, sizeof(m_header), 1, file);
+    if (!m_actions.empty()) {
+        fwrite(m_actions.data(), sizeof(RecordedAction), m_actions.size(), file);
+    }
+    fclose(file);
+    SDL_Log("InputRecorder: saved run to '%s' (%u steps, %u actions).", m_recordPath.c_str(), step, m_header.actionCount);
+}
+
+bool InputRecorder::PopReplayAction(Uint32 step, InputAction* action, bool* pressed) {
+    if (!m_replaying || m_replayIndex >= m_actions.size()) return false;
+    const RecordedAction& next = m_actions[m_replayIndex];
+    if (next.step > step) return false;
+    *action = static_cast<InputAction>(next.action);
+    *pressed = next.pressed != 0;
+    m_replayIndex++;
+    return true;
+}
+
+static bool ActionBefore(const RecordedAction& recorded, Uint32 step) {
+    return recorded.step < step;
+}
+
+void InputRecorder::Rewind(Uint32 step) {
+    std::vector<RecordedAction>::iterator first = std::lower_bound(m_actions.begin(), m_actions.end(), step, ActionBefore);
+    if (m_replaying) {
+        m_replayIndex = static_cast<size_t>(first - m_actions.begin());
+    } else if (m_runActive) {
+        m_actions.erase(first, m_actions.end());
+    }
+}
+
+void InputRecorder::Fork(Uint32 step) {
+    if (!m_replaying) {
+        Rewind(step);
+        return;
+    }
+    // Keep the replayed prefix so a recording of the fork replays from step 0.
+    m_actions.erase(std::lower_bound(m_actions.begin(), m_actions.end(), step, ActionBefore), m_actions.end());
+    m_replaying = false;
+    m_runActive = IsRecording();
+    SDL_Log("InputRecorder: forked replay at step %u, live input takes over.", step);
+}
@@ -0,0 +1,75 @@
+#ifndef INPUTRECORDER_H
+#define INPUTRECORDER_H
+
+#include <string>
+#include <vector>
+#include "SDL.h"
+#include "InputManager.h"
+
+#define INPUT_RECORDING_MAGIC 0x4E555256u
+#define INPUT_RECORDING_VERSION 2
+#define INPUT_RECORDING_RESERVE 4096
+
+struct RecordedAction {
+    Uint32 step;
+    Uint8 action;
+    Uint8 pressed;
+    Uint8 padding[2];
+};
+
+struct RecordingHeader {
+    Uint32 magic;
+    Uint32 version;
+    Uint32 seed;
+    Uint32 endStep;
+    Uint32 actionCount;
+};
+
+// Records the gameplay actions of a run keyed by simulation step, together
+// with the seed the run started from. Since the simulation only moves in
+// fixed steps, feeding the same actions back at the same steps reproduces
+// the run exactly, however fast the frames are produced.
+class InputRecorder {
+public:
+    static InputRecorder* GetInstance() {
+        return s_Instance = (s_Instance != nullptr) ? s_Instance : new InputRecorder();
+    }
+
+    void SetRecordPath(const char* path);
+    bool LoadReplay(const char* path);
+
+    inline bool IsRecording() const { return !m_recordPath.empty(); }
+    inline bool IsReplaying() const { return m_replaying; }
+    inline Uint32 GetReplaySeed() const { return m_header.seed; }
+    inline bool IsReplayFinished(Uint32 step) const { return m_replaying && step >= m_header.endStep; }
+
+    void BeginRun(Uint32 seed);
+    void Record(Uint32 step, InputAction action, bool pressed);
+    void EndRun(Uint32 step);
+    bool PopReplayAction(Uint32 step, InputAction* action, bool* pressed);
+
+    // The run went back to step: a replay resumes from the actions at that
+    // step, a recording forgets everything from it on. Fork() also ends a
+    // replay so live input takes over, recording on from step if enabled.
+    void Rewind(Uint32 step);
+    void Fork(Uint32 step);
+
+private:
+    InputRecorder() : m_replaying(false), m_replayIndex(0), m_runActive(false) {
+        m_header.magic = INPUT_RECORDING_MAGIC;
+        m_header.version = INPUT_RECORDING_VERSION;
+        m_header.seed = 0;
+        m_header.endStep = 0;
+        m_header.actionCount = 0;
+    }
+    static InputRecorder* s_Instance;
+
+    std::string m_recordPath;
+    RecordingHeader m_header;
+    std::vector<RecordedAction> m_actions;
+    bool m_replaying;
+    size_t m_replayIndex;
+    bool m_runActive;
+};
+
+#endif // INPUTRECORDER_H
@@ -1,9 +1,9 @@
 #include "MainMenu.h"
 #include "../Core/Engine.h"
+#include "../Graphics/RenderStats.h"
 #include "../Graphics/TextureManager.h"
 #include "../Audio/AudioManager.h"
 #include <SDL.h>
-#include <algorithm>
 
 MainMenu* MainMenu::s_Instance = nullptr;
 
@@ -20,63 +20,74 @@ bool MainMenu::Init() {
     if (!TextureManager::GetInstance()->Load("unmute_btn", "assets/Menu/unmute.png") || !TextureManager::GetInstance()->Load("unmute_btn_hover", "assets/Menu/unmute_hover.png")) { SDL_Log("Error loading unmute textures"); return false; }
 
 
+    BuildWidgets();
+
     SDL_Log("SUCCS: Toutes les textures du menu sont charges!");
     return true;
 }
 
-void MainMenu::HandleEvent(SDL_Event& event) {
-    int x, y; SDL_GetMouseState(&x, &y); SDL_Point mousePoint = {x, y};
+void MainMenu::BuildWidgets() {
+    m_widgets.Clear();
+    Widget* root = m_widgets.GetRoot();
+    root->AddChild(new ImageButton(-1, { 0, 0, SCREEN_WIDTH, SCREEN_HEIGHT }, "menu_bg", 1.0f));
 
-    m_playHovered = SDL_PointInRect(&mousePoint, &m_playButtonRect);
-    m_aboutHovered = SDL_PointInRect(&mousePoint, &m_aboutButtonRect);
-    m_quitHovered = SDL_PointInRect(&mousePoint, &m_quitButtonRect);
-    m_volDownHovered = SDL_PointInRect(&mousePoint, &m_volDownRect);
-    m_volUpHovered = SDL_PointInRect(&mousePoint, &m_volUpRect);
-    m_muteToggleHovered = SDL_PointInRect(&mousePoint, &m_muteToggleRect);
+    struct ButtonDesc { ButtonTag tag; SDL_Rect rect; const char* texture; };
+    const ButtonDesc buttons[] = {
+        { BUTTON_PLAY,        { 250, 250, 300, 80 }, "play_btn" },
+        { BUTTON_ABOUT,       { 260, 350, 280, 80 }, "about_btn" },
+        { BUTTON_QUIT,        { 250, 450, 290, 80 }, "quit_btn" },
+        { BUTTON_VOLUME_DOWN, { SCREEN_WIDTH - 160, SCREEN_HEIGHT - 60, 40, 40 }, "vol_down_btn" },
+        { BUTTON_MUTE,        { SCREEN_WIDTH - 110, SCREEN_HEIGHT - 60, 40, 40 }, "mute_btn" },
+        { BUTTON_VOLUME_UP,   { SCREEN_WIDTH - 60, SCREEN_HEIGHT - 60, 40, 40 }, "vol_up_btn" }
+    };
+    for (const ButtonDesc& desc : buttons) {
+        ImageButton* button = new ImageButton(desc.tag, desc.rect, desc.texture);
+        button->SetAction(&MainMenu::OnButton, this);
+        root->AddChild(button);
+        if (desc.tag == BUTTON_MUTE) m_muteButton = button;
+    }
+    m_showingMuted = false;
+    m_widgets.Layout();
+}
 
-    if (event.type == SDL_MOUSEBUTTONDOWN) {
-        if (m_playHovered) { AudioManager::GetInstance()->PlaySound("click", 0); Engine::GetInstance()->SetGameState(STATE_START_SCREEN); SDL_Log("Clic sur Jouer!"); }
-        else if (m_aboutHovered) { AudioManager::GetInstance()->PlaySound("click", 0); Engine::GetInstance()->SetGameState(STATE_ABOUT); SDL_Log("Clic sur A Propos!"); }
-        else if (m_quitHovered) { AudioManager::GetInstance()->PlaySound("click", 0); Engine::GetInstance()->Quit(); SDL_Log("Clic sur Quitter!"); }
-        else if (m_volDownHovered) { AudioManager::GetInstance()->PlaySound("click", 0); Engine::GetInstance()->DecreaseVolume(); }
-        else if (m_volUpHovered) { AudioManager::GetInstance()->PlaySound("click", 0); Engine::GetInstance()->IncreaseVolume(); }
-        else if (m_muteToggleHovered) { AudioManager::GetInstance()->PlaySound("click", 0); Engine::GetInstance()->ToggleMute(); }
+void MainMenu::OnButton(Widget* widget, void* userData) {
+    MainMenu* menu = static_cast<MainMenu*>(userData);
+    // Sounds load after the menu, so resolve the handle on first use.
+    if (menu->m_clickSound == INVALID_SOUND_HANDLE) {
+        menu->m_clickSound = AudioManager::GetInstance()->GetSoundHandle("click");
+    }
+    AudioManager::GetInstance()->PlaySound(menu->m_clickSound, 0);
+    switch (widget->GetTag()) {
+        case BUTTON_PLAY: Engine::GetInstance()->SetGameState(STATE_START_SCREEN); SDL_Log("Clic sur Jouer!"); break;
+        case BUTTON_ABOUT: Engine::GetInstance()->SetGameState(STATE_ABOUT); SDL_Log("Clic sur A Propos!"); break;
+        case BUTTON_QUIT: Engine::GetInstance()->Quit(); SDL_Log("Clic sur Quitter!"); break;
+        case BUTTON_VOLUME_DOWN: Engine::GetInstance()->DecreaseVolume(); break;
+        case BUTTON_VOLUME_UP: Engine::GetInstance()->IncreaseVolume(); break;
+        case BUTTON_MUTE: Engine::GetInstance()->ToggleMute(); break;
     }
 }
 
+void MainMenu::HandleEvent(SDL_Event& event) {
+    m_widgets.HandleEvent(event);
+}
+
 void MainMenu::Update(float deltaTime) {
-    m_playScale = std::min(m_hoverScale, std::max(1.0f, m_playScale + (m_playHovered ? 1.0f : -1.0f) * deltaTime * 8.0f));
-    m_aboutScale = std::min(m_hoverScale, std::max(1.0f, m_aboutScale + (m_aboutHovered ? 1.0f : -1.0f) * deltaTime * 8.0f));
-    m_quitScale = std::min(m_hoverScale, std::max(1.0f, m_quitScale + (m_quitHovered ? 1.0f : -1.0f) * deltaTime * 8.0f));
-    m_volDownScale = std::min(m_hoverScale, std::max(1.0f, m_volDownScale + (m_volDownHovered ? 1.0f : -1.0f) * deltaTime * 8.0f));
-    m_volUpScale = std::min(m_hoverScale, std::max(1.0f, m_volUpScale + (m_volUpHovered ? 1.0f : -1.0f) * deltaTime * 8.0f));
-    m_muteToggleScale = std::min(m_hoverScale, std::max(1.0f, m_muteToggleScale + (m_muteToggleHovered ? 1.0f : -1.0f) * deltaTime * 8.0f));
+    bool isMuted = Engine::GetInstance()->IsMuted();
+    if (m_muteButton && isMuted != m_showingMuted) {
+        m_muteButton->SetTexture(isMuted ? "unmute_btn" : "mute_btn");
+        m_showingMuted = isMuted;
+    }
+    m_widgets.Update(deltaTime);
 }
 
 void MainMenu::Render() {
-    TextureManager::GetInstance()->Draw("menu_bg", 0, 0, SCREEN_WIDTH, SCREEN_HEIGHT);
-
-    auto drawButton = [](const std::string& baseID, const SDL_Rect& rect, bool isHovered, float scale) {
-        std::string textureID = baseID + (isHovered ? "_hover" : "");
-        int scaledW = static_cast<int>(rect.w * scale);
-        int scaledH = static_cast<int>(rect.h * scale);
-        int posX = rect.x + (rect.w - scaledW) / 2;
-        int posY = rect.y + (rect.h - scaledH) / 2;
-        TextureManager::GetInstance()->Draw(textureID, posX, posY, scaledW, scaledH);
-    };
-
-    drawButton("play_btn", m_playButtonRect, m_playHovered, m_playScale);
-    drawButton("about_btn", m_aboutButtonRect, m_aboutHovered, m_aboutScale);
-    drawButton("quit_btn", m_quitButtonRect, m_quitHovered, m_quitScale);
-    drawButton("vol_down_btn", m_volDownRect, m_volDownHovered, m_volDownScale);
-    drawButton("vol_up_btn", m_volUpRect, m_volUpHovered, m_volUpScale);
-
-    bool isMuted = Engine::GetInstance()->IsMuted();
-    std::string muteBaseID = isMuted ? "unmute_btn" : "mute_btn";
-    drawButton(muteBaseID, m_muteToggleRect, m_muteToggleHovered, m_muteToggleScale);
+    RenderSection section(RENDER_SECTION_MAIN_MENU);
+    m_widgets.Render(Engine::GetInstance()->GetRenderer());
 }
 
 void MainMenu::Clean() {
+    m_widgets.Clear();
+    m_muteButton = nullptr;
     TextureManager::GetInstance()->Drop("menu_bg");
     TextureManager::GetInstance()->Drop("play_btn"); TextureManager::GetInstance()->Drop("play_btn_hover");
     TextureManager::GetInstance()->Drop("about_btn"); TextureManager::GetInstance()->Drop("about_btn_hover");
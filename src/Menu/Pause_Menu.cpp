@@ -1 +1,87 @@
+#include "Pause_Menu.h"
+#include "../Core/Engine.h"
+#include "../Graphics/RenderStats.h"
 
+PauseMenu* PauseMenu::s_Instance = nullptr;
+
+bool PauseMenu::Init() {
+    m_font = TTF_OpenFont("assets/FiraCode-Bold.ttf", 54);
+    if (!m_font) {
+        SDL_Log("Erreur chargement font: %s", TTF_GetError());
+        return false;
+    }
+
+    SDL_Color gold = {26, 15, 70, 255};
+    SDL_Surface* arrowSurface = RenderStats::GetInstance()->RenderText(m_font, ">", gold);
+    if (arrowSurface) {
+        m_marker = RenderStats::GetInstance()->CreateTextureFromSurface(Engine::GetInstance()->GetRenderer(), arrowSurface);
+        SDL_FreeSurface(arrowSurface);
+    }
+
+    int menuWidth = 400;
+    int menuHeight = 200;
+    SDL_Rect panelRect = { (SCREEN_WIDTH - menuWidth) / 2, (SCREEN_HEIGHT - menuHeight) / 2, menuWidth, menuHeight };
+    Widget* panel = m_widgets.GetRoot()->AddChild(new Widget(-1, panelRect));
+    panel->SetFill({71, 71, 71, 23});
+
+    SDL_Color textColor = {25, 15, 70, 255};
+    m_continueButton = panel->AddChild(new TextButton(BUTTON_CONTINUE, { 100, 40, 200, 40 }, m_font, "Continuer ", textColor, m_marker));
+    m_continueButton->SetAction(&PauseMenu::OnButton, this);
+    Widget* quitButton = panel->AddChild(new TextButton(BUTTON_QUIT, { 100, 90, 200, 40 }, m_font, "Quitter ", textColor, m_marker));
+    quitButton->SetAction(&PauseMenu::OnButton, this);
+
+    m_widgets.Layout();
+    return true;
+}
+
+void PauseMenu::Open() {
+    m_widgets.SetFocus(m_continueButton);
+}
+
+void PauseMenu::OnButton(Widget* widget, void* userData) {
+    Engine* engine = Engine::GetInstance();
+    switch (widget->GetTag()) {
+        case BUTTON_CONTINUE:
+            engine->SetPaused(false);
+            SDL_Log("Jeu repris");
+            break;
+        case BUTTON_QUIT:
+            engine->SetPaused(false);
+            engine->SetGameState(STATE_MAIN_MENU);
+            SDL_Log("Retour au menu principal");
+            break;
+    }
+}
+
+void PauseMenu::HandleEvent(const SDL_Event& event) {
+    m_widgets.HandleEvent(event);
+}
+
+void PauseMenu::HandleAction(const InputActionEvent& input) {
+    if (!input.pressed) return;
+    if (input.action == ACTION_LANE_UP) {
+        m_widgets.MoveFocus(-1);
+    } else if (input.action == ACTION_LANE_DOWN) {
+        m_widgets.MoveFocus(1);
+    } else if (input.action == ACTION_CONFIRM) {
+        m_widgets.ActivateFocused();
+    }
+}
+
+void PauseMenu::Render() {
+    RenderSection section(RENDER_SECTION_PAUSE_MENU);
+    m_widgets.Render(Engine::GetInstance()->GetRenderer());
+}
+
+void PauseMenu::Clean() {
+    m_widgets.Clear();
+    m_continueButton = nullptr;
+    if (m_marker) {
+        SDL_DestroyTexture(m_marker);
+        m_marker = nullptr;
+    }
+    if (m_font) {
+        TTF_CloseFont(m_font);
+        m_font = nullptr;
+    }
+}
@@ -1 +1,40 @@
+#ifndef PAUSE_MENU_H
+#define PAUSE_MENU_H
 
+#include "SDL.h"
+#include "SDL_ttf.h"
+#include "../UI/WidgetTree.h"
+#include "../Input/InputManager.h"
+
+class PauseMenu {
+public:
+    static PauseMenu* GetInstance() {
+        return s_Instance = (s_Instance != nullptr) ? s_Instance : new PauseMenu();
+    }
+
+    bool Init();
+    void Open();
+    void HandleEvent(const SDL_Event& event);
+    void HandleAction(const InputActionEvent& input);
+    void Render();
+    inline bool IsIdle() const { return m_widgets.IsIdle(); }
+    void Clean();
+
+private:
+    PauseMenu() : m_font(nullptr), m_marker(nullptr), m_continueButton(nullptr) {}
+    static PauseMenu* s_Instance;
+
+    enum ButtonTag {
+        BUTTON_CONTINUE,
+        BUTTON_QUIT
+    };
+
+    static void OnButton(Widget* widget, void* userData);
+
+    WidgetTree m_widgets;
+    TTF_Font* m_font;
+    SDL_Texture* m_marker;
+    Widget* m_continueButton;
+};
+
+#endif // PAUSE_MENU_H
@@ -0,0 +1,327 @@
+#include <cstddef>
+#include <cstring>
+#include "NetSession.h"
+
+NetSession* NetSession::s_Instance = nullptr;
+
+#define NET_HEADER_SIZE static_cast<int>(offsetof(NetPacket, inputs))
+#define NET_NO_FRAME 0xFFFFFFFFu
+
+NetSession::NetSession() :
+    m_hasPeer(false),
+    m_isHost(false),
+    m_connected(false),
+    m_timedOut(false),
+    m_seed(0),
+    m_lastHelloTime(0),
+    m_lastReceiveTime(0),
+    m_lastPeerSendTime(0),
+    m_latencyMs(0),
+    m_lossPercent(0.0f),
+    m_lossRng(0x4C4F5353u),
+    m_delayedCount(0),
+    m_startTime(0)
+{
+    m_peer.host = 0;
+    m_peer.port = 0;
+    std::memset(&m_stats, 0, sizeof(m_stats));
+    ResetRun();
+}
+
+void NetSession::ResetRun() {
+    // The first NET_INPUT_DELAY steps carry no input on either side, so both
+    // peers know them up front.
+    std::memset(m_localInputs, 0, sizeof(m_localInputs));
+    std::memset(m_remoteInputs, 0, sizeof(m_remoteInputs));
+    std::memset(m_predicted, 0, sizeof(m_predicted));
+    m_localFrameCount = NET_INPUT_DELAY;
+    m_remoteFrameCount = NET_INPUT_DELAY;
+    m_remoteAck = NET_INPUT_DELAY;
+    m_predictedFrameCount = 0;
+    m_rollbackFrame = NET_NO_FRAME;
+
+    for (int i = 0; i < NET_CHECKSUM_HISTORY; ++i) {
+        m_checksumFrames[i] = NET_NO_FRAME;
+        m_checksums[i] = 0;
+    }
+    m_latestChecksumFrame = 0;
+    m_latestChecksum = 0;
+    m_pendingRemoteFrame = 0;
+    m_pendingRemoteChecksum = 0;
+    m_comparedChecksumFrame = 0;
+}
+
+bool NetSession::Host(Uint16 port) {
+    if (!m_socket.Open(port)) return false;
+    m_isHost = true;
+    m_hasPeer = false;
+    Pcg32 seeder(SDL_GetPerformanceCounter());
+    m_seed = seeder();
+    m_startTime = SDL_GetTicks();
+    ResetRun();
+    SDL_Log("NetSession: hosting on port %u, waiting for a peer.", port);
+    return true;
+}
+
+bool NetSession::Join(const char* host, Uint16 port) {
+    if (!UdpSocket::Resolve(host, port, &m_peer)) return false;
+    if (!m_socket.Open(0)) return false;
+    m_isHost = false;
+    m_hasPeer = true;
+    m_startTime = SDL_GetTicks();
+    ResetRun();
+    SDL_Log("NetSession: joining %s:%u.", host, port);
+    return true;
+}
+
+void NetSession::SetSimulatedLatency(Uint32 ms) {
+    m_latencyMs = ms;
+    SDL_Log("NetSession: adding %u ms to every packet sent.", ms);
+}
+
+void NetSession::SetSimulatedLoss(float percent) {
+    m_lossPercent = (percent < 0.0f) ? 0.0f : (percent > 100.0f) ? 100.0f : percent;
+    SDL_Log("NetSession: dropping %.1f%% of packets sent.", m_lossPercent);
+}
+
+void NetSession::Close() {
+    if (!IsActive()) return;
+    FlushDelayed(true);
+    Report();
+    m_socket.Close();
+    m_connected = false;
+    m_hasPeer = false;
+}
+
+void NetSession::Poll() {
+    if (!IsActive()) return;
+    Uint32 now = SDL_GetTicks();
+    FlushDelayed(false);
+
+    if (!m_isHost && !m_connected && now - m_lastHelloTime >= NET_HELLO_INTERVAL_MS) {
+        NetPacket hello;
+        std::memset(&hello, 0, NET_HEADER_SIZE);
+        hello.type = NET_PACKET_HELLO;
+        Send(hello, 0);
+        m_lastHelloTime = now;
+    }
+
+    NetPacket packet;
+    UdpAddress from;
+    int size;
+    while ((size = m_socket.Receive(&from, &packet, sizeof(packet))) >= 0) {
+        m_stats.packetsReceived++;
+        m_stats.bytesReceived += size;
+        HandlePacket(packet, size, from);
+    }
+
+    if (m_connected && SDL_GetTicks() - m_lastReceiveTime > NET_TIMEOUT_MS) {
+        SDL_Log("NetSession: no packet from the peer for %d ms, giving up.", NET_TIMEOUT_MS);
+        m_connected = false;
+        m_timedOut = true;
+    }
+}
+
+void NetSession::HandlePacket(const NetPacket& packet, int size, const UdpAddress& from) {
+    if (size < NET_HEADER_SIZE || packet.magic != NET_PACKET_MAGIC || size < NET_HEADER_SIZE + packet.inputCount) return;
+    if (m_hasPeer && !UdpSocket::SameAddress(from, m_peer)) return;
+
+    Uint32 now = SDL_GetTicks();
+    switch (packet.type) {
+        case NET_PACKET_HELLO: {
+            if (!m_isHost) return;
+            if (!m_hasPeer) {
+                m_peer = from;
+                m_hasPeer = true;
+                SDL_Log("NetSession: peer joined, starting the race (seed %u).", m_seed);
+            }
+            m_connected = true;
+            m_lastReceiveTime = now;
+            // Answered every time: the joining side keeps asking until a
+            // welcome gets through.
+            NetPacket welcome;
+            std::memset(&welcome, 0, NET_HEADER_SIZE);
+            welcome.type = NET_PACKET_WELCOME;
+            welcome.seed = m_seed;
+            Send(welcome, 0);
+            return;
+        }
+        case NET_PACKET_WELCOME:
+            if (m_isHost || m_connected) return;
+            m_seed = packet.seed;
+            m_connected = true;
+            SDL_Log("NetSession: connected, starting the race (seed %u).", m_seed);
+            break;
+        case NET_PACKET_INPUT:
+            if (!m_connected) return;
+            break;
+        default:
+            return;
+    }
+
+    m_lastReceiveTime = now;
+    m_lastPeerSendTime = packet.sendTime;
+    if (packet.echoTime != 0) {
+        float rtt = static_cast<float>(now - packet.echoTime);
+        m_stats.rttMs = (m_stats.rttMs == 0.0f) ? rtt : m_stats.rttMs + (rtt - m_stats.rttMs) * 0.1f;
+    }
+    if (packet.type != NET_PACKET_INPUT) return;
+
+    if (packet.ackFrame > m_remoteAck) m_remoteAck = packet.ackFrame;
+    for (int i = 0; i < packet.inputCount; ++i) {
+        Uint32 frame = packet.firstFrame + i;
+        if (frame < m_remoteFrameCount) continue;
+        if (frame > m_remoteFrameCount) break;
+        Uint8 input = packet.inputs[i];
+        m_remoteInputs[frame % NET_INPUT_WINDOW] = input;
+        if (frame < m_predictedFrameCount && m_predicted[frame % NET_INPUT_WINDOW] != input && frame < m_rollbackFrame) {
+            m_rollbackFrame = frame;
+        }
+        m_remoteFrameCount++;
+    }
+    if (packet.checksumFrame != 0) {
+        CompareChecksum(packet.checksumFrame, packet.checksum);
+    }
+}
+
+void NetSession::SendInputs() {
+    if (!m_connected) return;
+    NetPacket packet;
+    std::memset(&packet, 0, NET_HEADER_SIZE);
+    packet.type = NET_PACKET_INPUT;
+    Uint32 count = m_localFrameCount - m_remoteAck;
+    if (count > NET_MAX_PACKET_INPUTS) count = NET_MAX_PACKET_INPUTS;
+    packet.firstFrame = m_remoteAck;
+    packet.inputCount = static_cast<Uint8>(count);
+    for (Uint32 i = 0; i < count; ++i) {
+        packet.inputs[i] = m_localInputs[(m_remoteAck + i) % NET_INPUT_WINDOW];
+    }
+    packet.ackFrame = m_remoteFrameCount;
+    packet.checksumFrame = m_latestChecksumFrame;
+    packet.checksum = m_latestChecksum;
+    Send(packet, static_cast<int>(count));
+}
+
+void NetSession::Send(NetPacket& packet, int inputCount) {
+    packet.magic = NET_PACKET_MAGIC;
+    packet.sendTime = SDL_GetTicks() | 1u;
+    packet.echoTime = m_lastPeerSendTime;
+    int size = NET_HEADER_SIZE + inputCount;
+
+    if (m_lossPercent > 0.0f && (m_lossRng() % 10000) < static_cast<Uint32>(m_lossPercent * 100.0f)) {
+        m_stats.packetsDropped++;
+        return;
+    }
+    if (m_latencyMs > 0) {
+        if (m_delayedCount == NET_DELAY_QUEUE) {
+            m_stats.packetsDropped++;
+            return;
+        }
+        DelayedPacket& delayed = m_delayed[m_delayedCount++];
+        delayed.releaseTime = SDL_GetTicks() + m_latencyMs;
+        delayed.size = size;
+        std::memcpy(&delayed.packet, &packet, size);
+        return;
+    }
+    if (m_socket.Send(m_peer, &packet, size)) {
+        m_stats.packetsSent++;
+        m_stats.bytesSent += size;
+    }
+}
+
+void NetSession::FlushDelayed(bool all) {
+    Uint32 now = SDL_GetTicks();
+    int sent = 0;
+    // Every packet gets the same delay, so the queue is already in order.
+    while (sent < m_delayedCount && (all || static_cast<Sint32>(now - m_delayed[sent].releaseTime) >= 0)) {
+        const DelayedPacket& delayed = m_delayed[sent++];
+        if (m_socket.Send(m_peer, &delayed.packet, delayed.size)) {
+            m_stats.packetsSent++;
+            m_stats.bytesSent += delayed.size;
+        }
+    }
+    if (sent > 0) {
+        std::memmove(m_delayed, m_delayed + sent, (m_delayedCount - sent) * sizeof(DelayedPacket));
+        m_delayedCount -= sent;
+    }
+}
+
+void NetSession::AddLocalInput(Uint8 input) {
+    m_localInputs[m_localFrameCount % NET_INPUT_WINDOW] = input;
+    m_localFrameCount++;
+}
+
+Uint8 NetSession::GetLocalInput(Uint32 frame) const {
+    return m_localInputs[frame % NET_INPUT_WINDOW];
+}
+
+Uint8 NetSession::GetRemoteInput(Uint32 frame) {
+    if (frame < m_remoteFrameCount) return m_remoteInputs[frame % NET_INPUT_WINDOW];
+    Uint8 predicted = m_remoteInputs[(m_remoteFrameCount - 1) % NET_INPUT_WINDOW] & NET_INPUT_HELD_MASK;
+    m_predicted[frame % NET_INPUT_WINDOW] = predicted;
+    if (frame + 1 > m_predictedFrameCount) m_predictedFrameCount = frame + 1;
+    return predicted;
+}
+
+bool NetSession::TakeRollbackFrame(Uint32* frame) {
+    if (m_rollbackFrame == NET_NO_FRAME) return false;
+    *frame = m_rollbackFrame;
+    m_rollbackFrame = NET_NO_FRAME;
+    return true;
+}
+
+void NetSession::SetLocalChecksum(Uint32 frame, Uint32 checksum) {
+    int index = (frame / NET_CHECKSUM_INTERVAL) % NET_CHECKSUM_HISTORY;
+    m_checksumFrames[index] = frame;
+    m_checksums[index] = checksum;
+    m_latestChecksumFrame = frame;
+    m_latestChecksum = checksum;
+    if (m_pendingRemoteFrame == frame) {
+        CompareChecksum(frame, m_pendingRemoteChecksum);
+    }
+}
+
+void NetSession::CompareChecksum(Uint32 frame, Uint32 checksum) {
+    if (frame <= m_comparedChecksumFrame) return;
+    int index = (frame / NET_CHECKSUM_INTERVAL) % NET_CHECKSUM_HISTORY;
+    if (m_checksumFrames[index] != frame) {
+        // The peer got there first; compare once this side catches up.
+        if (frame > m_latestChecksumFrame) {
+            m_pendingRemoteFrame = frame;
+            m_pendingRemoteChecksum = checksum;
+        }
+        return;
+    }
+    m_comparedChecksumFrame = frame;
+    if (m_checksums[index] == checksum) {
+        m_stats.checksumsMatched++;
+    } else {
+        m_stats.desyncs++;
+        SDL_Log("NetSession: DESYNC at step %u (local %08x, remote %08x).", frame, m_checksums[index], checksum);
+    }
+}
+
+void NetSession::OnRollback(Uint32 depth, float resimMs) {
+    m_stats.rollbacks++;
+    m_stats.rollbackFrames += depth;
+    if (depth > m_stats.maxRollback) m_stats.maxRollback = depth;
+    m_stats.resimMs += resimMs;
+    if (resimMs > m_stats.maxResimMs) m_stats.maxResimMs = resimMs;
+}
+
+void NetSession::OnStall() {
+    m_stats.stalls++;
+}
+
+void NetSession::Report() const {
+    float seconds = (SDL_GetTicks() - m_startTime) / 1000.0f;
+    if (seconds <= 0.0f) seconds = 1.0f;
+    const NetStats& s = m_stats;
+    SDL_Log("NetSession: %u steps, %u rollbacks, depth avg %.1f max %u, re-simulation avg %.3f ms max %.3f ms",
+            s.frames, s.rollbacks, s.rollbacks ? static_cast<float>(s.rollbackFrames) / s.rollbacks : 0.0f, s.maxRollback,
+            s.rollbacks ? static_cast<float>(s.resimMs / s.rollbacks) : 0.0f, s.maxResimMs);
+    SDL_Log("NetSession: sent %u packets (%.2f kbit/s), received %u (%.2f kbit/s), dropped %u on purpose, rtt %.1f ms",
+            s.packetsSent, s.bytesSent * 8.0f / 1000.0f / seconds, s.packetsReceived, s.bytesReceived * 8.0f / 1000.0f / seconds,
+            s.packetsDropped, s.rttMs);
+    SDL_Log("NetSession: %u stalled frames, %u checksums matched, %u desyncs", s.stalls, s.checksumsMatched, s.desyncs);
+}
@@ -0,0 +1,165 @@
+#ifndef NETSESSION_H
+#define NETSESSION_H
+
+#include "SDL.h"
+#include "UdpSocket.h"
+#include "../Core/Random.h"
+
+#define NET_PACKET_MAGIC 0x54454E56u
+#define NET_INPUT_WINDOW 256
+#define NET_MAX_PACKET_INPUTS 64
+#define NET_INPUT_DELAY 2
+#define NET_MAX_ROLLBACK 12
+#define NET_ROLLBACK_FRAMES (NET_MAX_ROLLBACK + 2)
+#define NET_CHECKSUM_INTERVAL 120
+#define NET_CHECKSUM_HISTORY 8
+#define NET_DELAY_QUEUE 256
+#define NET_HELLO_INTERVAL_MS 200
+#define NET_TIMEOUT_MS 5000
+
+// One byte of input per rider per sim step. Lane bits are presses that
+// happened during the step, the brake bit is the held state.
+#define NET_INPUT_LANE_UP 0x01
+#define NET_INPUT_LANE_DOWN 0x02
+#define NET_INPUT_BRAKE 0x04
+#define NET_INPUT_HELD_MASK NET_INPUT_BRAKE
+
+enum NetPacketType {
+    NET_PACKET_HELLO,
+    NET_PACKET_WELCOME,
+    NET_PACKET_INPUT
+};
+
+// Every packet repeats all local inputs the peer has not acknowledged yet,
+// so a lost packet costs nothing but the delay until the next one.
+struct NetPacket {
+    Uint32 magic;
+    Uint8 type;
+    Uint8 inputCount;
+    Uint16 padding;
+    Uint32 seed;
+    Uint32 firstFrame;
+    Uint32 ackFrame;
+    Uint32 checksumFrame;
+    Uint32 checksum;
+    Uint32 sendTime;
+    Uint32 echoTime;
+    Uint8 inputs[NET_MAX_PACKET_INPUTS];
+};
+
+struct NetStats {
+    Uint32 frames;
+    Uint32 rollbacks;
+    Uint32 rollbackFrames;
+    Uint32 maxRollback;
+    double resimMs;
+    float maxResimMs;
+    Uint32 stalls;
+    Uint32 packetsSent;
+    Uint32 packetsReceived;
+    Uint32 packetsDropped;
+    Uint64 bytesSent;
+    Uint64 bytesReceived;
+    float rttMs;
+    Uint32 checksumsMatched;
+    Uint32 desyncs;
+};
+
+// Two-peer rollback session. Each peer advances its simulation with its own
+// input and a prediction of the other's (the last held state, no presses).
+// When the real remote input for a simulated step arrives and differs, the
+// engine restores the state saved before that step and re-simulates to the
+// present. Peers stop advancing NET_MAX_ROLLBACK steps past the last
+// confirmed remote input. Latency and loss can be injected on send to
+// exercise all of this over loopback.
+class NetSession {
+public:
+    static NetSession* GetInstance() {
+        return s_Instance = (s_Instance != nullptr) ? s_Instance : new NetSession();
+    }
+
+    bool Host(Uint16 port);
+    bool Join(const char* host, Uint16 port);
+    void SetSimulatedLatency(Uint32 ms);
+    void SetSimulatedLoss(float percent);
+    void Close();
+
+    inline bool IsActive() const { return m_socket.IsOpen(); }
+    inline bool IsConnected() const { return m_connected; }
+    inline bool HasTimedOut() const { return m_timedOut; }
+    inline int GetLocalRider() const { return m_isHost ? 0 : 1; }
+    inline Uint32 GetSeed() const { return m_seed; }
+
+    void Poll();
+    void SendInputs();
+
+    inline bool CanAdvance(Uint32 frame) const { return frame < m_remoteFrameCount + NET_MAX_ROLLBACK; }
+    inline Uint32 GetConfirmedFrameCount() const { return m_remoteFrameCount; }
+    void AddLocalInput(Uint8 input);
+    Uint8 GetLocalInput(Uint32 frame) const;
+    Uint8 GetRemoteInput(Uint32 frame);
+    bool TakeRollbackFrame(Uint32* frame);
+
+    void SetLocalChecksum(Uint32 frame, Uint32 checksum);
+    void OnRollback(Uint32 depth, float resimMs);
+    void OnStall();
+    void OnFrame() { m_stats.frames++; }
+
+    inline const NetStats& GetStats() const { return m_stats; }
+    void Report() const;
+
+private:
+    NetSession();
+    static NetSession* s_Instance;
+
+    struct DelayedPacket {
+        Uint32 releaseTime;
+        int size;
+        NetPacket packet;
+    };
+
+    void ResetRun();
+    void Send(NetPacket& packet, int inputCount);
+    void FlushDelayed(bool all);
+    void HandlePacket(const NetPacket& packet, int size, const UdpAddress& from);
+    void CompareChecksum(Uint32 frame, Uint32 checksum);
+
+    UdpSocket m_socket;
+    UdpAddress m_peer;
+    bool m_hasPeer;
+    bool m_isHost;
+    bool m_connected;
+    bool m_timedOut;
+    Uint32 m_seed;
+    Uint32 m_lastHelloTime;
+    Uint32 m_lastReceiveTime;
+    Uint32 m_lastPeerSendTime;
+
+    Uint8 m_localInputs[NET_INPUT_WINDOW];
+    Uint32 m_localFrameCount;
+    Uint32 m_remoteAck;
+    Uint8 m_remoteInputs[NET_INPUT_WINDOW];
+    Uint32 m_remoteFrameCount;
+    Uint8 m_predicted[NET_INPUT_WINDOW];
+    Uint32 m_predictedFrameCount;
+    Uint32 m_rollbackFrame;
+
+    Uint32 m_checksumFrames[NET_CHECKSUM_HISTORY];
+    Uint32 m_checksums[NET_CHECKSUM_HISTORY];
+    Uint32 m_latestChecksumFrame;
+    Uint32 m_latestChecksum;
+    Uint32 m_pendingRemoteFrame;
+    Uint32 m_pendingRemoteChecksum;
+    Uint32 m_comparedChecksumFrame;
+
+    Uint32 m_latencyMs;
+    float m_lossPercent;
+    Pcg32 m_lossRng;
+    DelayedPacket m_delayed[NET_DELAY_QUEUE];
+    int m_delayedCount;
+
+    Uint32 m_startTime;
+    NetStats m_stats;
+};
+
+#endif // NETSESSION_H
@@ -0,0 +1,111 @@
+#include <cstring>
+#ifdef _WIN32
+#include <winsock2.h>
+#include <ws2tcpip.h>
+typedef SOCKET NativeSocket;
+typedef int SockLen;
+#else
+#include <arpa/inet.h>
+#include <fcntl.h>
+#include <netdb.h>
+#include <netinet/in.h>
+#include <sys/socket.h>
+#include <unistd.h>
+typedef int NativeSocket;
+typedef socklen_t SockLen;
+#define INVALID_SOCKET (-1)
+#define closesocket close
+#endif
+#include "UdpSocket.h"
+
+bool UdpSocket::StartUp() {
+#ifdef _WIN32
+    static bool started = false;
+    if (!started) {
+        WSADATA data;
+        if (WSAStartup(MAKEWORD(2, 2), &data) != 0) {
+            SDL_Log("UdpSocket - Error: WSAStartup failed.");
+            return false;
+        }
+        started = true;
+    }
+#endif
+    return true;
+}
+
+bool UdpSocket::Open(Uint16 port) {
+    Close();
+    if (!StartUp()) return false;
+
+    NativeSocket handle = socket(AF_INET, SOCK_DGRAM, IPPROTO_UDP);
+    if (handle == INVALID_SOCKET) {
+        SDL_Log("UdpSocket::Open - Error: cannot create socket.");
+        return false;
+    }
+    sockaddr_in address;
+    std::memset(&address, 0, sizeof(address));
+    address.sin_family = AF_INET;
+    address.sin_addr.s_addr = htonl(INADDR_ANY);
+    address.sin_port = htons(port);
+    if (bind(handle, reinterpret_cast<sockaddr*>(&address), sizeof(address)) != 0) {
+        SDL_Log("UdpSocket::Open - Error: cannot bind port %u.", port);
+        closesocket(handle);
+        return false;
+    }
+#ifdef _WIN32
+    u_long nonBlocking = 1;
+    ioctlsocket(handle, FIONBIO, &nonBlocking);
+#else
+    fcntl(handle, F_SETFL, fcntl(handle, F_GETFL, 0) | O_NONBLOCK);
+#endif
+    m_handle = static_cast<long long>(handle);
+    return true;
+}
+
+void UdpSocket::Close() {
+    if (m_handle != -1) {
+        closesocket(static_cast<NativeSocket>(m_handle));
+        m_handle = -1;
+    }
+}
+
+bool UdpSocket::Send(const UdpAddress& to, const void* data, int size) {
+    if (m_handle == -1) return false;
+    sockaddr_in address;
+    std::memset(&address, 0, sizeof(address));
+    address.sin_family = AF_INET;
+    address.sin_addr.s_addr = to.host;
+    address.sin_port = to.port;
+    int sent = sendto(static_cast<NativeSocket>(m_handle), static_cast<const char*>(data), size, 0,
+                      reinterpret_cast<sockaddr*>(&address), sizeof(address));
+    return sent == size;
+}
+
+int UdpSocket::Receive(UdpAddress* from, void* data, int capacity) {
+    if (m_handle == -1) return -1;
+    sockaddr_in address;
+    SockLen length = sizeof(address);
+    int received = recvfrom(static_cast<NativeSocket>(m_handle), static_cast<char*>(data), capacity, 0,
+                            reinterpret_cast<sockaddr*>(&address), &length);
+    if (received < 0) return -1;
+    from->host = address.sin_addr.s_addr;
+    from->port = address.sin_port;
+    return received;
+}
+
+bool UdpSocket::Resolve(const char* host, Uint16 port, UdpAddress* out) {
+    if (!StartUp()) return false;
+    addrinfo hints;
+    std::memset(&hints, 0, sizeof(hints));
+    hints.ai_family = AF_INET;
+    hints.ai_socktype = SOCK_DGRAM;
+    addrinfo* result = nullptr;
+    if (getaddrinfo(host, nullptr, &hints, &result) != 0 || result == nullptr) {
+        SDL_Log("UdpSocket::Resolve - Error: cannot resolve '%s'.", host);
+        return false;
+    }
+    out->host = reinterpret_cast<sockaddr_in*>(result->ai_addr)->sin_addr.s_addr;
+    out->port = htons(port);
+    freeaddrinfo(result);
+    return true;
+}
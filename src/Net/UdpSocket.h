@@ -0,0 +1,35 @@
+#ifndef UDPSOCKET_H
+#define UDPSOCKET_H
+
+#include "SDL.h"
+
+// IPv4 endpoint, both fields in network byte order.
+struct UdpAddress {
+    Uint32 host;
+    Uint16 port;
+};
+
+// Thin non-blocking UDP socket over Winsock or BSD sockets.
+class UdpSocket {
+public:
+    UdpSocket() : m_handle(-1) {}
+    ~UdpSocket() { Close(); }
+
+    bool Open(Uint16 port);
+    void Close();
+    inline bool IsOpen() const { return m_handle != -1; }
+
+    bool Send(const UdpAddress& to, const void* data, int size);
+    // Returns the datagram size, or -1 when nothing is waiting.
+    int Receive(UdpAddress* from, void* data, int capacity);
+
+    static bool Resolve(const char* host, Uint16 port, UdpAddress* out);
+    static inline bool SameAddress(const UdpAddress& a, const UdpAddress& b) { return a.host == b.host && a.port == b.port; }
+
+private:
+    static bool StartUp();
+
+    long long m_handle;
+};
+
+#endif // UDPSOCKET_H
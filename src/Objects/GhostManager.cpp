@@ -0,0 +1,256 @@
+#include "GhostManager.h"
+#include "Player.h"
+#include "../Core/Engine.h"
+
+GhostManager* GhostManager::s_Instance = nullptr;
+
+static Uint32 ZigZag(Sint32 value) {
+    return (static_cast<Uint32>(value) << 1) ^ static_cast<Uint32>(value >> 31);
+}
+
+static void WriteVarint(std::vector<Uint8>& out, Sint32 value) {
+    Uint32 bits = ZigZag(value);
+    while (bits >= 0x80) {
+        out.push_back(static_cast<Uint8>(bits | 0x80));
+        bits >>= 7;
+    }
+    out.push_back(static_cast<Uint8>(bits));
+}
+
+bool GhostReader::Open(const char* path) {
+    Close();
+    m_file = fopen(path, "rb");
+    if (m_file == nullptr) return false;
+    if (fread(&m_header, sizeof(m_header), 1, m_file) != 1 ||
+        m_header.magic != GHOST_MAGIC || m_header.version != GHOST_VERSION || m_header.sampleSteps == 0) {
+        SDL_Log("GhostReader::Open - Error: '%s' is not a valid ghost file.", path);
+        Close();
+        return false;
+    }
+    m_dataStart = ftell(m_file);
+    Restart();
+    return true;
+}
+
+void GhostReader::Close() {
+    if (m_file) {
+        fclose(m_file);
+        m_file = nullptr;
+    }
+}
+
+// The stream is delta-coded, so going back means decoding from the start
+// again; GetPosition() catches up lazily from here.
+void GhostReader::Restart() {
+    if (m_file == nullptr) return;
+    fseek(m_file, m_dataStart, SEEK_SET);
+    m_bufferPos = m_bufferLen = 0;
+    m_decoded = 0;
+    m_prev.y = m_prev.distance = 0;
+    m_next = m_prev;
+    m_step = 0;
+}
+
+bool GhostReader::ReadByte(Uint8* out) {
+    if (m_bufferPos >= m_bufferLen) {
+        m_bufferLen = static_cast<int>(fread(m_buffer, 1, GHOST_READ_BUFFER, m_file));
+        m_bufferPos = 0;
+        if (m_bufferLen <= 0) return false;
+    }
+    *out = m_buffer[m_bufferPos++];
+    return true;
+}
+
+bool GhostReader::ReadVarint(Sint32* out) {
+    Uint32 bits = 0;
+    for (int shift = 0; shift < 35; shift += 7) {
+        Uint8 byte;
+        if (!ReadByte(&byte)) return false;
+        bits |= static_cast<Uint32>(byte & 0x7F) << shift;
+        if ((byte & 0x80) == 0) {
+            *out = static_cast<Sint32>(bits >> 1) ^ -static_cast<Sint32>(bits & 1);
+            return true;
+        }
+    }
+    return false;
+}
+
+bool GhostReader::DecodeNext() {
+    Sint32 dy, dStep;
+    if (!ReadVarint(&dy) || !ReadVarint(&dStep)) return false;
+    m_prev = m_next;
+    m_step += dStep;
+    m_next.y = m_prev.y + dy;
+    m_next.distance = m_prev.distance + m_step;
+    m_decoded++;
+    return true;
+}
+
+bool GhostReader::GetPosition(Uint32 step, float* y, float* distance) {
+    if (m_file == nullptr) return false;
+    Uint32 sampleSteps = m_header.sampleSteps;
+    if (m_decoded >= 2 && step < (m_decoded - 2) * sampleSteps) {
+        Restart();
+    }
+    Uint32 wanted = step / sampleSteps + 2;
+    while (m_decoded < wanted && m_decoded < m_header.sampleCount && DecodeNext()) {}
+    if (m_decoded == 0) return false;
+
+    float t = 1.0f;
+    if (m_decoded >= 2) {
+        t = static_cast<float>(step - (m_decoded - 2) * sampleSteps) / sampleSteps;
+        if (t > 1.0f) t = 1.0f;
+    }
+    // Before the first pair m_prev is the zero origin; t = 1 ignores it.
+    *y = m_prev.y + (m_next.y - m_prev.y) * t;
+    *distance = (m_prev.distance + (m_next.distance - m_prev.distance) * t) / GHOST_DISTANCE_SCALE;
+    return true;
+}
+
+void GhostManager::Init(const char* bestPath) {
+    m_bestPath = bestPath ? bestPath : "";
+    m_bestSlot = -1;
+    if (m_bestPath.empty() || m_playbackCount >= GHOST_MAX_PLAYBACK) return;
+    if (m_playback[m_playbackCount].Open(m_bestPath.c_str())) {
+        m_bestSlot = m_playbackCount++;
+        const GhostHeader& header = m_playback[m_bestSlot].GetHeader();
+        SDL_Log("GhostManager: best run loaded (%s, %.0f m).", header.won ? "won" : "lost", header.distance / 10.0f);
+    }
+}
+
+bool GhostManager::AddGhost(const char* path) {
+    if (m_playbackCount >= GHOST_MAX_PLAYBACK) {
+        SDL_Log("GhostManager::AddGhost - Error: at most %d ghosts.", GHOST_MAX_PLAYBACK);
+        return false;
+    }
+    if (!m_playback[m_playbackCount].Open(path)) {
+        SDL_Log("GhostManager::AddGhost - Error: cannot load ghost '%s'.", path);
+        return false;
+    }
+    m_playbackCount++;
+    return true;
+}
+
+void GhostManager::Clean() {
+    for (int i = 0; i < m_playbackCount; ++i) {
+        m_playback[i].Close();
+    }
+    m_playbackCount = 0;
+    m_bestSlot = -1;
+    m_samples.clear();
+    m_recording = false;
+}
+
+void GhostManager::BeginRun() {
+    // A 60 s run at 120 steps/s is 1800 samples; reserving up front keeps
+    // the run itself free of reallocations.
+    m_samples.clear();
+    m_samples.reserve(GHOST_RESERVE_SAMPLES);
+    m_recording = true;
+    for (int i = 0; i < m_playbackCount; ++i) {
+        m_playback[i].Restart();
+    }
+}
+
+void GhostManager::Sample(Uint32 step, float y, float distance) {
+    if (!m_recording || step % GHOST_SAMPLE_STEPS != 0) return;
+    size_t index = step / GHOST_SAMPLE_STEPS;
+    if (index < m_samples.size()) {
+        m_samples.resize(index);
+    }
+    GhostSample sample;
+    sample.y = static_cast<Sint32>(y + 0.5f);
+    sample.distance = static_cast<Sint32>(distance * GHOST_DISTANCE_SCALE + 0.5f);
+    while (m_samples.size() <= index) {
+        m_samples.push_back(sample);
+    }
+}
+
+void GhostManager::Rewind(Uint32 step) {
+    size_t keep = step / GHOST_SAMPLE_STEPS + 1;
+    if (keep < m_samples.size()) {
+        m_samples.resize(keep);
+    }
+}
+
+void GhostManager::DiscardRun() {
+    m_recording = false;
+    m_samples.clear();
+}
+
+void GhostManager::EndRun(Uint32 step, float distance, bool won) {
+    if (!m_recording) return;
+    m_recording = false;
+    if (m_bestPath.empty() || m_samples.empty()) return;
+
+    GhostHeader header;
+    header.magic = GHOST_MAGIC;
+    header.version = GHOST_VERSION;
+    header.sampleSteps = GHOST_SAMPLE_STEPS;
+    header.sampleCount = static_cast<Uint32>(m_samples.size());
+    header.endStep = step;
+    header.distance = distance;
+    header.won = won ? 1 : 0;
+    if (m_bestSlot >= 0 && !IsBetter(header, m_playback[m_bestSlot].GetHeader())) return;
+
+    int slot = m_bestSlot >= 0 ? m_bestSlot : m_playbackCount;
+    if (slot >= GHOST_MAX_PLAYBACK) return;
+    // The reader is closed while the file is rewritten. Save only fails
+    // before it touches the file, so then the previous best is reopened.
+    m_playback[slot].Close();
+    if (!Save(m_bestPath, header) && slot != m_bestSlot) return;
+    if (m_playback[slot].Open(m_bestPath.c_str())) {
+        m_bestSlot = slot;
+        if (slot == m_playbackCount) m_playbackCount++;
+    } else if (slot == m_bestSlot) {
+        m_bestSlot = -1;
+    }
+}
+
+bool GhostManager::IsBetter(const GhostHeader& run, const GhostHeader& best) const {
+    if (run.won != best.won) return run.won != 0;
+    if (run.won) return run.endStep < best.endStep;
+    return run.distance > best.distance;
+}
+
+bool GhostManager::Save(const std::string& path, const GhostHeader& header) {
+    std::vector<Uint8> stream;
+    stream.reserve(m_samples.size() * 2 + 16);
+    GhostSample previous = {0, 0};
+    Sint32 previousStep = 0;
+    for (const GhostSample& sample : m_samples) {
+        Sint32 step = sample.distance - previous.distance;
+        WriteVarint(stream, sample.y - previous.y);
+        WriteVarint(stream, step - previousStep);
+        previous = sample;
+        previousStep = step;
+    }
+
+    FILE* file = fopen(path.c_str(), "wb");
+    if (file == nullptr) {
+        SDL_Log("GhostManager::Save - Error: cannot write '%s'.", path.c_str());
+        return false;
+    }
+    fwrite(&header, sizeof(header), 1, file);
+    fwrite(stream.data(), 1, stream.size(), file);
+    fclose(file);
+    SDL_Log("GhostManager: new best run saved to '%s' (%u samples, %u bytes).",
+            path.c_str(), header.sampleCount, static_cast<Uint32>(sizeof(header) + stream.size()));
+    return true;
+}
+
+void GhostManager::Draw(const Player* player, Uint32 step, float playerX, float playerDistance) {
+    if (m_playbackCount == 0 || player == nullptr) return;
+    SDL_Point centers[GHOST_MAX_PLAYBACK];
+    int count = 0;
+    for (int i = 0; i < m_playbackCount; ++i) {
+        float y, distance;
+        if (!m_playback[i].GetPosition(step, &y, &distance)) continue;
+        float x = playerX + (distance - playerDistance);
+        if (x < -SCREEN_WIDTH / 4 || x > SCREEN_WIDTH + SCREEN_WIDTH / 4) continue;
+        centers[count].x = static_cast<int>(x);
+        centers[count].y = static_cast<int>(y);
+        count++;
+    }
+    player->drawGhosts(centers, count, GHOST_ALPHA);
+}
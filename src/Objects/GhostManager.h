@@ -0,0 +1,110 @@
+#ifndef GHOSTMANAGER_H
+#define GHOSTMANAGER_H
+
+#include <cstdio>
+#include <string>
+#include <vector>
+#include "SDL.h"
+
+#define GHOST_MAGIC 0x54534847u
+#define GHOST_VERSION 1
+#define GHOST_SAMPLE_STEPS 4
+#define GHOST_RESERVE_SAMPLES 2048
+#define GHOST_DISTANCE_SCALE 16.0f
+#define GHOST_READ_BUFFER 1024
+#define GHOST_MAX_PLAYBACK 8
+#define GHOST_ALPHA 96
+#define GHOST_BEST_PATH "best_run.ghost"
+
+struct GhostHeader {
+    Uint32 magic;
+    Uint32 version;
+    Uint32 sampleSteps;
+    Uint32 sampleCount;
+    Uint32 endStep;
+    float distance;
+    Uint32 won;
+};
+
+struct GhostSample {
+    Sint32 y;
+    Sint32 distance;
+};
+
+class Player;
+
+// Streams one ghost file. Samples are decoded a few at a time from a small
+// read buffer as the run advances, so a ghost never lives in memory whole.
+class GhostReader {
+public:
+    GhostReader() : m_file(nullptr), m_dataStart(0), m_bufferPos(0), m_bufferLen(0), m_decoded(0), m_step(0) {}
+    ~GhostReader() { Close(); }
+
+    bool Open(const char* path);
+    void Close();
+    void Restart();
+    bool GetPosition(Uint32 step, float* y, float* distance);
+
+    inline const GhostHeader& GetHeader() const { return m_header; }
+
+private:
+    bool ReadByte(Uint8* out);
+    bool ReadVarint(Sint32* out);
+    bool DecodeNext();
+
+    FILE* m_file;
+    long m_dataStart;
+    GhostHeader m_header;
+    Uint8 m_buffer[GHOST_READ_BUFFER];
+    int m_bufferPos;
+    int m_bufferLen;
+
+    // m_prev and m_next bracket the current step; m_step is the last
+    // distance increment, which the encoding is relative to.
+    Uint32 m_decoded;
+    GhostSample m_prev;
+    GhostSample m_next;
+    Sint32 m_step;
+};
+
+// Records the current run as lane position and distance samples every
+// GHOST_SAMPLE_STEPS sim steps and plays back ghosts of earlier runs. On
+// disk each sample is the zigzag varint delta of y (pixels) and of the
+// per-sample distance (1/16 pixel), i.e. of speed, which is almost always
+// a single zero byte each: about 3.5 KB for a full minute.
+class GhostManager {
+public:
+    static GhostManager* GetInstance() {
+        return s_Instance = (s_Instance != nullptr) ? s_Instance : new GhostManager();
+    }
+
+    // bestPath = nullptr disables loading and saving the best run.
+    void Init(const char* bestPath);
+    bool AddGhost(const char* path);
+    void Clean();
+
+    void BeginRun();
+    void Sample(Uint32 step, float y, float distance);
+    void Rewind(Uint32 step);
+    void EndRun(Uint32 step, float distance, bool won);
+    void DiscardRun();
+
+    void Draw(const Player* player, Uint32 step, float playerX, float playerDistance);
+
+private:
+    GhostManager() : m_recording(false), m_playbackCount(0), m_bestSlot(-1) {}
+    static GhostManager* s_Instance;
+
+    bool IsBetter(const GhostHeader& run, const GhostHeader& best) const;
+    bool Save(const std::string& path, const GhostHeader& header);
+
+    std::string m_bestPath;
+    std::vector<GhostSample> m_samples;
+    bool m_recording;
+
+    GhostReader m_playback[GHOST_MAX_PLAYBACK];
+    int m_playbackCount;
+    int m_bestSlot;
+};
+
+#endif // GHOSTMANAGER_H
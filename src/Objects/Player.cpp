@@ -1,11 +1,16 @@
 #include "Player.h"
 #include "../Graphics/TextureManager.h"
 #include "../Core/Engine.h"
+#include "../Core/Clock.h"
+#include "../Core/EventQueue.h"
+#include "../Core/Log.h"
+#include "../Graphics/RenderStats.h"
 #include <SDL.h>
 #include <cmath>
 #include <algorithm>
 
-Player::Player() :
+Player::Player(int index) :
+    m_index(index),
     m_x(0.0f),
     m_currentY(0.0f),
     m_targetY(0.0f),
@@ -21,8 +26,9 @@ Player::Player() :
     m_textureId(""),
     m_width(0),
     m_height(0),
+    m_isBraking(false),
     m_isSlowed(false),
-    m_slowedStartTime(0),
+    m_penaltyTimer(INVALID_TIMER_ID),
     m_initialMaxSpeed(400.0f)
 {}
 
@@ -49,8 +55,10 @@ void Player::reset(float startX, const std::vector<float>& laneYPositions) {
      m_speed = 0.0f;
      m_laneYPositions = laneYPositions;
      m_numLanes = static_cast<int>(m_laneYPositions.size());
+     m_isBraking = false;
      m_isSlowed = false;
-     m_slowedStartTime = 0;
+     Engine::GetInstance()->GetGameTimers()->Cancel(m_penaltyTimer);
+     m_penaltyTimer = INVALID_TIMER_ID;
      m_maxSpeed = m_initialMaxSpeed;
 
      if (m_numLanes > 0) {
@@ -71,16 +79,54 @@ void Player::IncreaseMaxSpeed(float amount, float absoluteMax) {
     if (m_maxSpeed > absoluteMax) {
         m_maxSpeed = absoluteMax;
     }
-     SDL_Log("Player Max Speed Increased! New max speed: %.2f", m_maxSpeed);
+     LOG_INFO("Player Max Speed Increased! New max speed: %.2f", m_maxSpeed);
 }
 
 
 void Player::ApplySpeedPenalty() {
     if (!m_isSlowed) {
-        SDL_Log("Applying speed penalty!");
+        LOG_DEBUG("Applying speed penalty!");
         m_isSlowed = true;
-        m_slowedStartTime = SDL_GetTicks();
         m_speed = m_penaltySpeed;
+        SchedulePenaltyEnd(m_penaltyDuration);
+    }
+}
+
+void Player::SchedulePenaltyEnd(Uint32 delayMs) {
+    m_penaltyTimer = Engine::GetInstance()->GetGameTimers()->Schedule(delayMs, [this]() {
+        LOG_DEBUG("Speed penalty ended.");
+        m_isSlowed = false;
+        m_penaltyTimer = INVALID_TIMER_ID;
+    });
+}
+
+void Player::SaveState(PlayerState* out) const {
+    out->x = m_x;
+    out->currentY = m_currentY;
+    out->targetY = m_targetY;
+    out->currentLane = m_currentLane;
+    out->speed = m_speed;
+    out->maxSpeed = m_maxSpeed;
+    out->isBraking = m_isBraking ? 1 : 0;
+    out->isSlowed = m_isSlowed ? 1 : 0;
+    out->padding[0] = out->padding[1] = 0;
+    out->penaltyRemainingMs = Engine::GetInstance()->GetGameTimers()->GetRemaining(m_penaltyTimer);
+}
+
+// The caller resets the game timers first; the penalty timer is re-armed
+// with whatever was left of it.
+void Player::LoadState(const PlayerState& state) {
+    m_x = state.x;
+    m_currentY = state.currentY;
+    m_targetY = state.targetY;
+    m_currentLane = state.currentLane;
+    m_speed = state.speed;
+    m_maxSpeed = state.maxSpeed;
+    m_isBraking = state.isBraking != 0;
+    m_isSlowed = state.isSlowed != 0 && state.penaltyRemainingMs > 0;
+    m_penaltyTimer = INVALID_TIMER_ID;
+    if (m_isSlowed) {
+        SchedulePenaltyEnd(state.penaltyRemainingMs);
     }
 }
 
@@ -94,37 +140,29 @@ SDL_Rect Player::GetCollider() const {
 }
 
 
-void Player::handleEvent(const SDL_Event& event) {
-    if (event.type == SDL_KEYDOWN && event.key.repeat == 0) {
-        switch (event.key.keysym.sym) {
-            case SDLK_UP:
-                if (m_currentLane > 0) {
-                    setLane(m_currentLane - 1);
-                }
-                break;
-            case SDLK_DOWN:
-                 if (m_currentLane < m_numLanes - 1) {
-                    setLane(m_currentLane + 1);
-                }
-                break;
-            default:
-                break;
-        }
+void Player::handleAction(InputAction action, bool pressed) {
+    switch (action) {
+        case ACTION_LANE_UP:
+            if (pressed && m_currentLane > 0) {
+                setLane(m_currentLane - 1);
+            }
+            break;
+        case ACTION_LANE_DOWN:
+            if (pressed && m_currentLane < m_numLanes - 1) {
+                setLane(m_currentLane + 1);
+            }
+            break;
+        case ACTION_BRAKE:
+            m_isBraking = pressed;
+            break;
+        default:
+            break;
     }
 }
 
 void Player::update(float deltaTime) {
-    if (m_isSlowed) {
-        Uint32 currentTime = SDL_GetTicks();
-        if (currentTime - m_slowedStartTime >= m_penaltyDuration) {
-            SDL_Log("Speed penalty ended.");
-            m_isSlowed = false;
-        }
-    }
-
     if (!m_isSlowed) {
-        const Uint8* keyState = SDL_GetKeyboardState(NULL);
-        bool braking = keyState[SDL_SCANCODE_LEFT];
+        bool braking = m_isBraking;
 
         if (braking) {
             m_speed -= m_braking * deltaTime;
@@ -173,15 +211,44 @@ void Player::draw() {
     }
 }
 
+// Every ghost shares the player's texture: one alpha/blend change around a
+// batch of copies, restored afterwards for the player itself.
+void Player::drawGhosts(const SDL_Point* centers, int count, Uint8 alpha) const {
+    if (count <= 0 || m_width <= 0 || m_height <= 0) return;
+    SDL_Texture* texture = TextureManager::GetInstance()->GetTexture(m_textureId);
+    if (texture == nullptr) return;
+    SDL_Renderer* renderer = Engine::GetInstance()->GetRenderer();
+    SDL_Point offset = TextureManager::GetInstance()->GetDrawOffset();
+    SDL_BlendMode blendMode;
+    SDL_GetTextureBlendMode(texture, &blendMode);
+    SDL_SetTextureBlendMode(texture, SDL_BLENDMODE_BLEND);
+    SDL_SetTextureAlphaMod(texture, alpha);
+    for (int i = 0; i < count; ++i) {
+        SDL_Rect dst = {centers[i].x - m_width / 2 + offset.x, centers[i].y - m_height / 2 + offset.y, m_width, m_height};
+        RenderStats::GetInstance()->Copy(renderer, texture, NULL, &dst);
+    }
+    SDL_SetTextureAlphaMod(texture, 255);
+    SDL_SetTextureBlendMode(texture, blendMode);
+}
+
 float Player::getSpeed() const {
     return m_speed;
 }
 
 void Player::setLane(int laneIndex) {
     if (m_numLanes > 0 && laneIndex >= 0 && laneIndex < m_numLanes) {
+        if (laneIndex != m_currentLane) {
+            GameEvent event;
+            event.type = EVENT_LANE_CHANGE;
+            event.time = Clock::GetInstance()->GetTicks(CLOCK_GAME);
+            event.laneChange.rider = m_index;
+            event.laneChange.fromLane = m_currentLane;
+            event.laneChange.toLane = laneIndex;
+            EventQueue::GetInstance()->Push(event);
+        }
         m_currentLane = laneIndex;
         m_targetY = m_laneYPositions[m_currentLane];
     } else {
-         SDL_Log("Player::setLane - Warning: Invalid lane index %d requested.", laneIndex);
+         LOG_WARN("Player::setLane - Invalid lane index %d requested.", laneIndex);
     }
 }
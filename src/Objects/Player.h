@@ -4,14 +4,34 @@
 #include <string>
 #include <vector>
 #include <SDL.h>
+#include "../Core/TimerWheel.h"
+#include "../Input/InputManager.h"
+
+#define MAX_RIDERS 2
+
+struct PlayerState {
+    float x;
+    float currentY;
+    float targetY;
+    int currentLane;
+    float speed;
+    float maxSpeed;
+    Uint8 isBraking;
+    Uint8 isSlowed;
+    Uint8 padding[2];
+    Uint32 penaltyRemainingMs;
+};
 
 class Player {
 public:
-    Player();
+    Player(int index);
     bool load(std::string textureId, float startX, const std::vector<float>& laneYPositions);
-    void handleEvent(const SDL_Event& event);
+    void handleAction(InputAction action, bool pressed);
     void update(float deltaTime);
     void draw();
+    void drawGhosts(const SDL_Point* centers, int count, Uint8 alpha) const;
+    inline float GetY() const { return m_currentY; }
+    inline bool IsBraking() const { return m_isBraking; }
     float getSpeed() const;
     void reset(float startX, const std::vector<float>& laneYPositions);
     void ApplySpeedPenalty();
@@ -19,8 +39,12 @@ public:
 
     void IncreaseMaxSpeed(float amount, float absoluteMax);
 
+    void SaveState(PlayerState* out) const;
+    void LoadState(const PlayerState& state);
+
 
 private:
+    int m_index;
     float m_x;
 
     float m_currentY;
@@ -39,8 +63,9 @@ private:
     int m_width;
     int m_height;
 
+    bool m_isBraking;
     bool m_isSlowed;
-    Uint32 m_slowedStartTime;
+    TimerId m_penaltyTimer;
     const float m_penaltySpeed = 50.0f;
     const Uint32 m_penaltyDuration = 2500;
 
@@ -48,6 +73,7 @@ private:
 
 
     void setLane(int laneIndex);
+    void SchedulePenaltyEnd(Uint32 delayMs);
 };
 
 #endif // PLAYER_H
@@ -2,14 +2,22 @@
 #define OBSTACLE_H
 
 #include <SDL_rect.h>
-#include <string>
 
+// Spawning waits for a clear course and then places one or two obstacles,
+// and SpawnObstacle never goes past this many live at once.
+#define MAX_OBSTACLES 2
+
+// x is a distance along the course; a rider sees the obstacle at
+// x minus the distance that rider has covered. Each rider only crashes
+// into an obstacle once: hitMask has a bit per rider that has hit it, and
+// the obstacle is removed once every rider has.
 struct Obstacle {
     SDL_Rect collider;
-    bool isActive;
-    std::string textureId;
+    float x;
+    int textureIndex;
+    Uint8 hitMask;
 
-    Obstacle() : isActive(true), textureId("") {}
+    Obstacle() : x(0.0f), textureIndex(0), hitMask(0) {}
 };
 
 #endif // OBSTACLE_H
@@ -0,0 +1,148 @@
+#include "Widget.h"
+#include "WidgetTree.h"
+#include "../Graphics/RenderStats.h"
+#include "../Graphics/TextureManager.h"
+#include "../Core/Engine.h"
+
+#define WIDGET_HOVER_SPEED 8.0f
+#define WIDGET_MARKER_OFFSET 30
+
+Widget::Widget(int tag, SDL_Rect rect)
+    : m_tag(tag), m_rect(rect), m_bounds(rect), m_visible(true), m_hovered(false), m_focused(false),
+      m_hasFill(false), m_fill({0, 0, 0, 0}), m_parent(nullptr), m_tree(nullptr),
+      m_action(nullptr), m_actionData(nullptr) {}
+
+Widget::~Widget() {
+    for (Widget* child : m_children) {
+        delete child;
+    }
+}
+
+Widget* Widget::AddChild(Widget* child) {
+    child->m_parent = this;
+    m_children.push_back(child);
+    return child;
+}
+
+void Widget::SetAction(WidgetAction action, void* userData) {
+    m_action = action;
+    m_actionData = userData;
+}
+
+void Widget::SetFill(SDL_Color color) {
+    m_hasFill = true;
+    m_fill = color;
+    MarkDirty();
+}
+
+void Widget::SetVisible(bool visible) {
+    if (m_visible == visible) return;
+    m_visible = visible;
+    MarkDirty();
+}
+
+void Widget::SetHovered(bool hovered) {
+    if (m_hovered == hovered) return;
+    m_hovered = hovered;
+    MarkDirty();
+}
+
+void Widget::SetFocused(bool focused) {
+    if (m_focused == focused) return;
+    m_focused = focused;
+    MarkDirty();
+}
+
+void Widget::Activate() {
+    if (m_action) m_action(this, m_actionData);
+}
+
+void Widget::MarkDirty() {
+    if (m_tree) m_tree->Invalidate(GetPaintBounds());
+}
+
+bool Widget::Update(float deltaTime) {
+    return false;
+}
+
+void Widget::Draw(SDL_Renderer* renderer) {
+    if (!m_hasFill) return;
+    // Panels sit on the cleared cache, so write their colour and alpha as-is.
+    SDL_SetRenderDrawBlendMode(renderer, SDL_BLENDMODE_NONE);
+    SDL_SetRenderDrawColor(renderer, m_fill.r, m_fill.g, m_fill.b, m_fill.a);
+    SDL_RenderFillRect(renderer, &m_bounds);
+    SDL_SetRenderDrawBlendMode(renderer, SDL_BLENDMODE_BLEND);
+}
+
+SDL_Rect Widget::GetPaintBounds() const {
+    return m_bounds;
+}
+
+ImageButton::ImageButton(int tag, SDL_Rect rect, const std::string& textureId, float hoverScale)
+    : Widget(tag, rect), m_scale(1.0f), m_hoverScale(hoverScale) {
+    SetTexture(textureId);
+}
+
+void ImageButton::SetTexture(const std::string& textureId) {
+    if (m_textureId == textureId) return;
+    m_textureId = textureId;
+    m_hoverTextureId = textureId + "_hover";
+    MarkDirty();
+}
+
+bool ImageButton::Update(float deltaTime) {
+    float target = m_hovered ? m_hoverScale : 1.0f;
+    if (m_scale == target) return false;
+    float step = deltaTime * WIDGET_HOVER_SPEED * (m_hovered ? 1.0f : -1.0f);
+    m_scale += step;
+    if ((step > 0.0f && m_scale > target) || (step < 0.0f && m_scale < target)) m_scale = target;
+    MarkDirty();
+    return true;
+}
+
+void ImageButton::Draw(SDL_Renderer* renderer) {
+    int scaledW = static_cast<int>(m_bounds.w * m_scale);
+    int scaledH = static_cast<int>(m_bounds.h * m_scale);
+    int posX = m_bounds.x + (m_bounds.w - scaledW) / 2;
+    int posY = m_bounds.y + (m_bounds.h - scaledH) / 2;
+    TextureManager::GetInstance()->Draw(m_hovered ? m_hoverTextureId : m_textureId, posX, posY, scaledW, scaledH);
+}
+
+SDL_Rect ImageButton::GetPaintBounds() const {
+    // Cover the largest the hover animation can grow to.
+    int maxW = static_cast<int>(m_bounds.w * m_hoverScale) + 2;
+    int maxH = static_cast<int>(m_bounds.h * m_hoverScale) + 2;
+    SDL_Rect paint = { m_bounds.x + (m_bounds.w - maxW) / 2, m_bounds.y + (m_bounds.h - maxH) / 2, maxW, maxH };
+    return paint;
+}
+
+TextButton::TextButton(int tag, SDL_Rect rect, TTF_Font* font, const char* text, SDL_Color color, SDL_Texture* marker)
+    : Widget(tag, rect), m_label(nullptr), m_marker(marker) {
+    if (font == nullptr) return;
+    SDL_Surface* surface = RenderStats::GetInstance()->RenderText(font, text, color);
+    if (surface == nullptr) {
+        SDL_Log("TextButton - Failed to render '%s': %s", text, TTF_GetError());
+        return;
+    }
+    m_label = RenderStats::GetInstance()->CreateTextureFromSurface(Engine::GetInstance()->GetRenderer(), surface);
+    SDL_FreeSurface(surface);
+}
+
+TextButton::~TextButton() {
+    if (m_label) SDL_DestroyTexture(m_label);
+}
+
+void TextButton::Draw(SDL_Renderer* renderer) {
+    if (m_label) RenderStats::GetInstance()->Copy(renderer, m_label, NULL, &m_bounds);
+    if (m_focused && m_marker) {
+        SDL_Rect markerRect = { m_bounds.x - WIDGET_MARKER_OFFSET, m_bounds.y, 20, 30 };
+        RenderStats::GetInstance()->Copy(renderer, m_marker, NULL, &markerRect);
+    }
+}
+
+SDL_Rect TextButton::GetPaintBounds() const {
+    SDL_Rect paint = m_bounds;
+    paint.x -= WIDGET_MARKER_OFFSET;
+    paint.w += WIDGET_MARKER_OFFSET;
+    return paint;
+}
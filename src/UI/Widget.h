@@ -0,0 +1,96 @@
+#ifndef WIDGET_H
+#define WIDGET_H
+
+#include <string>
+#include <vector>
+#include "SDL.h"
+#include "SDL_ttf.h"
+
+class Widget;
+class WidgetTree;
+
+typedef void (*WidgetAction)(Widget* widget, void* userData);
+
+// Node of a retained UI. Rects are relative to the parent until
+// WidgetTree::Layout() resolves them to screen space once. A widget that
+// changes how it looks calls MarkDirty(); only its area is redrawn.
+class Widget {
+public:
+    Widget(int tag, SDL_Rect rect);
+    virtual ~Widget();
+
+    Widget* AddChild(Widget* child);
+    void SetAction(WidgetAction action, void* userData);
+    void SetFill(SDL_Color color);
+    void SetVisible(bool visible);
+
+    inline int GetTag() const { return m_tag; }
+    inline const SDL_Rect& GetBounds() const { return m_bounds; }
+    inline bool IsVisible() const { return m_visible; }
+    inline bool IsInteractive() const { return m_action != nullptr; }
+    inline bool IsHovered() const { return m_hovered; }
+    inline bool IsFocused() const { return m_focused; }
+
+    void SetHovered(bool hovered);
+    void SetFocused(bool focused);
+    void Activate();
+
+    virtual bool Update(float deltaTime);
+    virtual void Draw(SDL_Renderer* renderer);
+    virtual SDL_Rect GetPaintBounds() const;
+
+protected:
+    void MarkDirty();
+
+    int m_tag;
+    SDL_Rect m_rect;
+    SDL_Rect m_bounds;
+    bool m_visible;
+    bool m_hovered;
+    bool m_focused;
+    bool m_hasFill;
+    SDL_Color m_fill;
+
+private:
+    friend class WidgetTree;
+
+    Widget* m_parent;
+    WidgetTree* m_tree;
+    std::vector<Widget*> m_children;
+    WidgetAction m_action;
+    void* m_actionData;
+};
+
+// Textured button with a hover texture and the grow-on-hover animation of
+// the original menu buttons.
+class ImageButton : public Widget {
+public:
+    ImageButton(int tag, SDL_Rect rect, const std::string& textureId, float hoverScale = 1.1f);
+
+    void SetTexture(const std::string& textureId);
+    bool Update(float deltaTime) override;
+    void Draw(SDL_Renderer* renderer) override;
+    SDL_Rect GetPaintBounds() const override;
+
+private:
+    std::string m_textureId;
+    std::string m_hoverTextureId;
+    float m_scale;
+    float m_hoverScale;
+};
+
+// Text rendered once to a texture; shows the marker texture when focused.
+class TextButton : public Widget {
+public:
+    TextButton(int tag, SDL_Rect rect, TTF_Font* font, const char* text, SDL_Color color, SDL_Texture* marker);
+    ~TextButton() override;
+
+    void Draw(SDL_Renderer* renderer) override;
+    SDL_Rect GetPaintBounds() const override;
+
+private:
+    SDL_Texture* m_label;
+    SDL_Texture* m_marker;
+};
+
+#endif // WIDGET_H
@@ -0,0 +1,230 @@
+#include "WidgetTree.h"
+#include "../Core/Engine.h"
+#include "../Graphics/RenderStats.h"
+
+WidgetTree::WidgetTree()
+    : m_root(nullptr), m_gridColumns(0), m_gridRows(0), m_hovered(nullptr), m_focused(nullptr),
+      m_animating(false), m_cache(nullptr), m_cacheUnsupported(false), m_fullRepaint(true), m_dirtyCount(0) {
+    SDL_Rect screen = { 0, 0, SCREEN_WIDTH, SCREEN_HEIGHT };
+    m_root = new Widget(-1, screen);
+    m_root->m_tree = this;
+}
+
+WidgetTree::~WidgetTree() {
+    Clear();
+    delete m_root;
+}
+
+void WidgetTree::Clear() {
+    for (Widget* child : m_root->m_children) {
+        delete child;
+    }
+    m_root->m_children.clear();
+    m_interactive.clear();
+    m_grid.clear();
+    m_hovered = nullptr;
+    m_focused = nullptr;
+    if (m_cache) {
+        SDL_DestroyTexture(m_cache);
+        m_cache = nullptr;
+    }
+    m_fullRepaint = true;
+}
+
+void WidgetTree::Layout() {
+    m_interactive.clear();
+    LayoutWidget(m_root, 0, 0);
+
+    m_gridColumns = (SCREEN_WIDTH + UI_GRID_CELL_SIZE - 1) / UI_GRID_CELL_SIZE;
+    m_gridRows = (SCREEN_HEIGHT + UI_GRID_CELL_SIZE - 1) / UI_GRID_CELL_SIZE;
+    m_grid.assign(m_gridColumns * m_gridRows, std::vector<int>());
+    for (int i = 0; i < static_cast<int>(m_interactive.size()); ++i) {
+        const SDL_Rect& r = m_interactive[i]->GetBounds();
+        int x0 = SDL_max(0, r.x / UI_GRID_CELL_SIZE);
+        int y0 = SDL_max(0, r.y / UI_GRID_CELL_SIZE);
+        int x1 = SDL_min(m_gridColumns - 1, (r.x + r.w - 1) / UI_GRID_CELL_SIZE);
+        int y1 = SDL_min(m_gridRows - 1, (r.y + r.h - 1) / UI_GRID_CELL_SIZE);
+        for (int y = y0; y <= y1; ++y) {
+            for (int x = x0; x <= x1; ++x) {
+                m_grid[y * m_gridColumns + x].push_back(i);
+            }
+        }
+    }
+    InvalidateAll();
+}
+
+void WidgetTree::LayoutWidget(Widget* widget, int originX, int originY) {
+    widget->m_tree = this;
+    widget->m_bounds = widget->m_rect;
+    widget->m_bounds.x += originX;
+    widget->m_bounds.y += originY;
+    if (widget->IsInteractive()) {
+        m_interactive.push_back(widget);
+    }
+    for (Widget* child : widget->m_children) {
+        LayoutWidget(child, widget->m_bounds.x, widget->m_bounds.y);
+    }
+}
+
+Widget* WidgetTree::HitTest(int x, int y) const {
+    if (x < 0 || y < 0 || m_grid.empty()) return nullptr;
+    int column = x / UI_GRID_CELL_SIZE;
+    int row = y / UI_GRID_CELL_SIZE;
+    if (column >= m_gridColumns || row >= m_gridRows) return nullptr;
+
+    SDL_Point point = { x, y };
+    const std::vector<int>& cell = m_grid[row * m_gridColumns + column];
+    // Later widgets paint on top, so test them first.
+    for (int i = static_cast<int>(cell.size()) - 1; i >= 0; --i) {
+        Widget* widget = m_interactive[cell[i]];
+        if (widget->IsVisible() && SDL_PointInRect(&point, &widget->GetBounds())) {
+            return widget;
+        }
+    }
+    return nullptr;
+}
+
+bool WidgetTree::HandleEvent(const SDL_Event& event) {
+    switch (event.type) {
+        case SDL_MOUSEMOTION:
+            SetHovered(HitTest(event.motion.x, event.motion.y));
+            return m_hovered != nullptr;
+        case SDL_MOUSEBUTTONDOWN: {
+            if (event.button.button != SDL_BUTTON_LEFT) return false;
+            Widget* target = HitTest(event.button.x, event.button.y);
+            SetHovered(target);
+            if (target == nullptr) return false;
+            target->Activate();
+            return true;
+        }
+        case SDL_RENDER_TARGETS_RESET:
+        case SDL_RENDER_DEVICE_RESET:
+            InvalidateAll();
+            return false;
+        default:
+            return false;
+    }
+}
+
+void WidgetTree::SetHovered(Widget* widget) {
+    if (widget == m_hovered) return;
+    if (m_hovered) m_hovered->SetHovered(false);
+    m_hovered = widget;
+    if (m_hovered) {
+        m_hovered->SetHovered(true);
+        if (m_focused) SetFocus(m_hovered);
+    }
+}
+
+void WidgetTree::MoveFocus(int delta) {
+    if (m_interactive.empty()) return;
+    int count = static_cast<int>(m_interactive.size());
+    int index = 0;
+    for (int i = 0; i < count; ++i) {
+        if (m_interactive[i] == m_focused) {
+            index = ((i + delta) % count + count) % count;
+            break;
+        }
+    }
+    SetFocus(m_interactive[index]);
+}
+
+void WidgetTree::SetFocus(Widget* widget) {
+    if (widget == m_focused) return;
+    if (m_focused) m_focused->SetFocused(false);
+    m_focused = widget;
+    if (m_focused) m_focused->SetFocused(true);
+}
+
+void WidgetTree::ActivateFocused() {
+    if (m_focused) m_focused->Activate();
+}
+
+void WidgetTree::Update(float deltaTime) {
+    m_animating = UpdateWidget(m_root, deltaTime);
+}
+
+bool WidgetTree::UpdateWidget(Widget* widget, float deltaTime) {
+    bool animating = widget->Update(deltaTime);
+    for (Widget* child : widget->m_children) {
+        animating |= UpdateWidget(child, deltaTime);
+    }
+    return animating;
+}
+
+void WidgetTree::Invalidate(const SDL_Rect& rect) {
+    if (m_fullRepaint) return;
+    for (int i = 0; i < m_dirtyCount; ++i) {
+        if (SDL_HasIntersection(&m_dirty[i], &rect)) {
+            SDL_UnionRect(&m_dirty[i], &rect, &m_dirty[i]);
+            return;
+        }
+    }
+    if (m_dirtyCount == UI_MAX_DIRTY_RECTS) {
+        m_fullRepaint = true;
+        return;
+    }
+    m_dirty[m_dirtyCount++] = rect;
+}
+
+void WidgetTree::InvalidateAll() {
+    m_fullRepaint = true;
+    m_dirtyCount = 0;
+}
+
+void WidgetTree::PaintWidget(SDL_Renderer* renderer, Widget* widget, const SDL_Rect& region) {
+    if (!widget->IsVisible()) return;
+    SDL_Rect paint = widget->GetPaintBounds();
+    if (SDL_HasIntersection(&paint, &region)) {
+        widget->Draw(renderer);
+    }
+    for (Widget* child : widget->m_children) {
+        PaintWidget(renderer, child, region);
+    }
+}
+
+void WidgetTree::Render(SDL_Renderer* renderer) {
+    SDL_Rect screen = { 0, 0, SCREEN_WIDTH, SCREEN_HEIGHT };
+    SDL_SetRenderDrawBlendMode(renderer, SDL_BLENDMODE_BLEND);
+
+    if (m_cache == nullptr && !m_cacheUnsupported) {
+        if (SDL_RenderTargetSupported(renderer)) {
+            m_cache = SDL_CreateTexture(renderer, SDL_PIXELFORMAT_RGBA8888, SDL_TEXTUREACCESS_TARGET, SCREEN_WIDTH, SCREEN_HEIGHT);
+        }
+        if (m_cache == nullptr) {
+            SDL_Log("WidgetTree - Render targets unavailable, drawing widgets every frame.");
+            m_cacheUnsupported = true;
+        } else {
+            SDL_SetTextureBlendMode(m_cache, SDL_BLENDMODE_BLEND);
+            m_fullRepaint = true;
+        }
+    }
+    if (m_cacheUnsupported) {
+        PaintWidget(renderer, m_root, screen);
+        return;
+    }
+
+    if (m_fullRepaint || m_dirtyCount > 0) {
+        SDL_Texture* previousTarget = SDL_GetRenderTarget(renderer);
+        RenderStats::GetInstance()->SetTarget(renderer, m_cache);
+        if (m_fullRepaint) {
+            m_dirty[0] = screen;
+            m_dirtyCount = 1;
+        }
+        for (int i = 0; i < m_dirtyCount; ++i) {
+            SDL_Rect region;
+            if (!SDL_IntersectRect(&m_dirty[i], &screen, &region)) continue;
+            SDL_RenderSetClipRect(renderer, &region);
+            SDL_SetRenderDrawBlendMode(renderer, SDL_BLENDMODE_NONE);
+            SDL_SetRenderDrawColor(renderer, 0, 0, 0, 0);
+            SDL_RenderFillRect(renderer, &region);
+            SDL_SetRenderDrawBlendMode(renderer, SDL_BLENDMODE_BLEND);
+            PaintWidget(renderer, m_root, region);
+        }
+        SDL_RenderSetClipRect(renderer, nullptr);
+        RenderStats::GetInstance()->SetTarget(renderer, previousTarget);
+        m_fullRepaint = false;
+        m_dirtyCount = 0;
+    }
+    RenderStats::GetInstance()->Copy(renderer, m_cache, NULL, NULL);
+}
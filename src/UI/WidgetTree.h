@@ -0,0 +1,63 @@
+#ifndef WIDGETTREE_H
+#define WIDGETTREE_H
+
+#include <vector>
+#include "SDL.h"
+#include "Widget.h"
+
+#define UI_GRID_CELL_SIZE 64
+#define UI_MAX_DIRTY_RECTS 16
+
+// Owns a widget hierarchy, resolves its layout once, and keeps it painted
+// in a cached render target. Each frame only the dirty rects are repainted
+// into the cache, then the cache is drawn with a single copy. Mouse hit
+// testing goes through a coarse grid built at layout time.
+class WidgetTree {
+public:
+    WidgetTree();
+    ~WidgetTree();
+
+    Widget* GetRoot() { return m_root; }
+    void Layout();
+    void Clear();
+
+    bool HandleEvent(const SDL_Event& event);
+    void Update(float deltaTime);
+    void Render(SDL_Renderer* renderer);
+
+    Widget* HitTest(int x, int y) const;
+    void MoveFocus(int delta);
+    void SetFocus(Widget* widget);
+    void ActivateFocused();
+    inline Widget* GetFocused() const { return m_focused; }
+
+    // True when nothing animates and the cache matches what was last drawn.
+    inline bool IsIdle() const { return !m_animating && !m_fullRepaint && m_dirtyCount == 0; }
+
+    void Invalidate(const SDL_Rect& rect);
+    void InvalidateAll();
+
+private:
+    void LayoutWidget(Widget* widget, int originX, int originY);
+    bool UpdateWidget(Widget* widget, float deltaTime);
+    void PaintWidget(SDL_Renderer* renderer, Widget* widget, const SDL_Rect& region);
+    void SetHovered(Widget* widget);
+
+    Widget* m_root;
+    std::vector<Widget*> m_interactive;
+    std::vector<std::vector<int>> m_grid;
+    int m_gridColumns;
+    int m_gridRows;
+
+    Widget* m_hovered;
+    Widget* m_focused;
+    bool m_animating;
+
+    SDL_Texture* m_cache;
+    bool m_cacheUnsupported;
+    bool m_fullRepaint;
+    SDL_Rect m_dirty[UI_MAX_DIRTY_RECTS];
+    int m_dirtyCount;
+};
+
+#endif // WIDGETTREE_H